@@ -0,0 +1,732 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+// Benchmarks the grid geometry core on synthetic grids with mixed row heights
+// and column widths. Grids small enough to scan are first checked against a
+// linear reference implementation; the program exits nonzero on any mismatch.
+// The column summaries and the update queue are checked the same way.
+
+#define _POSIX_C_SOURCE 200112L
+
+#include "MMGridGeometry.h"
+#include "MMGridSummary.h"
+#include "MMGridUpdateQueue.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    long rows;
+    long columns;
+    long queries;
+} MMBenchmarkGrid;
+
+static const MMBenchmarkGrid MMBenchmarkGrids[] = {
+    { 10, 10, 1000000 },
+    { 1000, 100, 1000000 },
+    { 100000, 1000, 1000000 },
+    { 10000000, 1000, 1000000 },
+};
+
+// Grids up to this many rows are verified query by query against the linear reference.
+static const long MMBenchmarkVerifyRowLimit = 100000;
+static const long MMBenchmarkVerifyQueries = 2000;
+
+// Uniform row axes hold no table, so even the largest one costs no memory.
+static const long MMBenchmarkUniformRowCounts[] = { 100000, 5000000, 100000000 };
+static const long MMBenchmarkUniformColumns = 20;
+static const double MMBenchmarkUniformRowHeight = 24.0;
+static const long MMBenchmarkUniformQueries = 200000;
+
+// Merged cell counts to index, on a grid of MMBenchmarkSpanGridRows x MMBenchmarkSpanGridColumns.
+static const long MMBenchmarkSpanCounts[] = { 1000, 100000, 1000000 };
+static const long MMBenchmarkSpanGridRows = 10000000;
+static const long MMBenchmarkSpanGridColumns = 1000;
+static const long MMBenchmarkSpanQueries = 200000;
+static const long MMBenchmarkSpanViewportRows = 40;
+static const long MMBenchmarkSpanViewportColumns = 12;
+
+// Column summaries: one value in this many is blank (NaN), like a sparse numeric column.
+static const long MMBenchmarkSummaryRowCounts[] = { 100000, 1000000, 10000000 };
+static const long MMBenchmarkSummaryBlankInterval = 97;
+static const long MMBenchmarkSummaryUpdates = 20000;
+
+// Ticks from a busy feed, through a queue sized like the view's.
+static const long MMBenchmarkQueueProducerCounts[] = { 1, 2, 4, 8 };
+static const long MMBenchmarkQueueUpdatesPerProducer = 200000;
+static const long MMBenchmarkQueueCapacity = 4096;
+static const long MMBenchmarkQueueFrames = 2000;
+static const long MMBenchmarkQueueHotRows = 200;
+static const long MMBenchmarkQueueHotColumns = 10;
+
+static const double MMBenchmarkViewportWidth = 1024.0;
+static const double MMBenchmarkViewportHeight = 768.0;
+
+static volatile long MMBenchmarkSink;
+
+// MARK: - Helpers
+
+static unsigned long long MMBenchmarkSeed = 0x2545F4914F6CDD1DULL;
+
+static unsigned long MMBenchmarkRandom(void)
+{
+    // Deterministic LCG so every run measures the same grids and queries.
+    MMBenchmarkSeed = MMBenchmarkSeed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (unsigned long)(MMBenchmarkSeed >> 33);
+}
+
+static double MMBenchmarkRandomDouble(double limit)
+{
+    return (double)MMBenchmarkRandom() / (double)(1UL << 31) * limit;
+}
+
+static double MMBenchmarkNow(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+static int MMBenchmarkFillMixed(MMGridAxis *axis, long count, double minimum, double spread)
+{
+    double *offsets = MMGridAxisPrepare(axis, count);
+    if (offsets == NULL) {
+        return 0;
+    }
+    for (long index = 0; index < count; index++) {
+        // Mostly uniform sizes with the occasional tall or wide outlier.
+        double size = minimum + (double)(MMBenchmarkRandom() % 4) * spread;
+        if (MMBenchmarkRandom() % 64 == 0) {
+            size *= 4.0;
+        }
+        offsets[index + 1] = offsets[index] + size;
+    }
+    return 1;
+}
+
+static long MMBenchmarkLinearIndexForOffset(const MMGridAxis *axis, double offset)
+{
+    long index = 0;
+    while (index + 1 < axis->count && MMGridAxisOffset(axis, index + 1) <= offset) {
+        index++;
+    }
+    return index;
+}
+
+// MARK: - Verification
+
+static int MMBenchmarkVerify(const MMGridAxis *rows, const MMGridAxis *columns, MMGridSplit split)
+{
+    for (long query = 0; query < MMBenchmarkVerifyQueries; query++) {
+        double y = MMBenchmarkRandomDouble(MMGridAxisLength(rows) * 1.1) - MMGridAxisLength(rows) * 0.05;
+        double x = MMBenchmarkRandomDouble(MMGridAxisLength(columns) * 1.1) - MMGridAxisLength(columns) * 0.05;
+
+        long row = MMGridAxisIndexForOffset(rows, y);
+        long expectedRow = MMBenchmarkLinearIndexForOffset(rows, y);
+        if (row != expectedRow) {
+            fprintf(stderr, "row for offset %f: got %ld, expected %ld\n", y, row, expectedRow);
+            return 0;
+        }
+
+        MMGridRange range = MMGridAxisRangeForSpan(columns, x, x + MMBenchmarkViewportWidth);
+        long expectedStart = MMBenchmarkLinearIndexForOffset(columns, x);
+        long expectedEnd = MMBenchmarkLinearIndexForOffset(columns, x + MMBenchmarkViewportWidth);
+        if (range.location != expectedStart || range.length != expectedEnd - expectedStart + 1) {
+            fprintf(stderr, "columns for span at %f: got {%ld, %ld}, expected {%ld, %ld}\n",
+                    x, range.location, range.length, expectedStart, expectedEnd - expectedStart + 1);
+            return 0;
+        }
+
+        long column = MMGridAxisIndexForOffset(columns, x);
+        MMGridPane pane = MMGridSplitPaneForCell(split, row, column);
+        MMGridCellIndex cell = { row, column };
+        MMGridCellIndex paneIndex = MMGridSplitPaneIndexFromCell(split, pane, cell);
+        MMGridCellIndex roundTrip = MMGridSplitCellFromPaneIndex(split, pane, paneIndex);
+        if (paneIndex.row < 0 || paneIndex.column < 0 ||
+            paneIndex.row >= MMGridSplitPaneRowCount(split, pane, rows->count) ||
+            paneIndex.column >= MMGridSplitPaneColumnCount(split, pane, columns->count) ||
+            roundTrip.row != row || roundTrip.column != column) {
+            fprintf(stderr, "cell {%ld, %ld} maps to pane %d {%ld, %ld} and back to {%ld, %ld}\n",
+                    row, column, (int)pane, paneIndex.row, paneIndex.column, roundTrip.row, roundTrip.column);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+typedef struct {
+    long count;
+    long rowSum;
+} MMBenchmarkSpanTally;
+
+static int MMBenchmarkTallySpan(const MMGridSpan *span, void *context)
+{
+    MMBenchmarkSpanTally *tally = context;
+    tally->count++;
+    tally->rowSum += span->row * 31 + span->column;
+    return 0;
+}
+
+static MMGridRange MMBenchmarkRandomRange(long count, long length)
+{
+    MMGridRange range = { (long)(MMBenchmarkRandom() % (unsigned long)count), length };
+    return range;
+}
+
+static int MMBenchmarkVerifySpans(const MMGridSpanIndex *index, const MMGridSpan *spans, long spanCount)
+{
+    for (long query = 0; query < MMBenchmarkVerifyQueries / 10; query++) {
+        MMGridRange rows = MMBenchmarkRandomRange(MMBenchmarkSpanGridRows, MMBenchmarkSpanViewportRows);
+        MMGridRange columns = MMBenchmarkRandomRange(MMBenchmarkSpanGridColumns, MMBenchmarkSpanViewportColumns);
+        MMBenchmarkSpanTally tally = { 0, 0 };
+        MMGridSpanIndexQuery(index, rows, columns, MMBenchmarkTallySpan, &tally);
+
+        MMBenchmarkSpanTally expected = { 0, 0 };
+        for (long i = 0; i < spanCount; i++) {
+            MMGridSpan clipped;
+            if (MMGridSpanClip(spans[i], rows, columns, &clipped)) {
+                MMBenchmarkTallySpan(&spans[i], &expected);
+            }
+        }
+        if (tally.count != expected.count || tally.rowSum != expected.rowSum) {
+            fprintf(stderr, "spans in rows {%ld, %ld} columns {%ld, %ld}: got %ld, expected %ld\n",
+                    rows.location, rows.length, columns.location, columns.length, tally.count, expected.count);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// MARK: - Benchmarks
+
+static double MMBenchmarkOffsetLookups(const MMGridAxis *rows, long queries)
+{
+    double length = MMGridAxisLength(rows);
+    long sum = 0;
+    double start = MMBenchmarkNow();
+    for (long query = 0; query < queries; query++) {
+        sum += MMGridAxisIndexForOffset(rows, MMBenchmarkRandomDouble(length));
+    }
+    double elapsed = MMBenchmarkNow() - start;
+    MMBenchmarkSink = sum;
+    return elapsed / (double)queries;
+}
+
+static double MMBenchmarkVisibleRanges(const MMGridAxis *rows, const MMGridAxis *columns, long queries)
+{
+    double height = MMGridAxisLength(rows);
+    double width = MMGridAxisLength(columns);
+    long sum = 0;
+    double start = MMBenchmarkNow();
+    for (long query = 0; query < queries; query++) {
+        double y = MMBenchmarkRandomDouble(height);
+        double x = MMBenchmarkRandomDouble(width);
+        MMGridRange visibleRows = MMGridAxisRangeForSpan(rows, y, y + MMBenchmarkViewportHeight);
+        MMGridRange visibleColumns = MMGridAxisRangeForSpan(columns, x, x + MMBenchmarkViewportWidth);
+        sum += visibleRows.length * visibleColumns.length;
+    }
+    double elapsed = MMBenchmarkNow() - start;
+    MMBenchmarkSink = sum;
+    return elapsed / (double)queries;
+}
+
+static double MMBenchmarkIndexMapping(MMGridSplit split, long rowCount, long columnCount, long queries)
+{
+    long sum = 0;
+    double start = MMBenchmarkNow();
+    for (long query = 0; query < queries; query++) {
+        MMGridCellIndex cell = { (long)(MMBenchmarkRandom() % (unsigned long)rowCount),
+                                 (long)(MMBenchmarkRandom() % (unsigned long)columnCount) };
+        MMGridPane pane = MMGridSplitPaneForCell(split, cell.row, cell.column);
+        MMGridCellIndex paneIndex = MMGridSplitPaneIndexFromCell(split, pane, cell);
+        MMGridCellIndex roundTrip = MMGridSplitCellFromPaneIndex(split, pane, paneIndex);
+        sum += roundTrip.row + roundTrip.column + paneIndex.row;
+    }
+    double elapsed = MMBenchmarkNow() - start;
+    MMBenchmarkSink = sum;
+    return elapsed / (double)queries;
+}
+
+static double MMBenchmarkSpanLookups(const MMGridSpanIndex *index, long queries)
+{
+    long sum = 0;
+    double start = MMBenchmarkNow();
+    for (long query = 0; query < queries; query++) {
+        MMGridRange rows = MMBenchmarkRandomRange(MMBenchmarkSpanGridRows, MMBenchmarkSpanViewportRows);
+        MMGridRange columns = MMBenchmarkRandomRange(MMBenchmarkSpanGridColumns, MMBenchmarkSpanViewportColumns);
+        sum += MMGridSpanIndexQuery(index, rows, columns, NULL, NULL);
+    }
+    double elapsed = MMBenchmarkNow() - start;
+    MMBenchmarkSink = sum;
+    return elapsed / (double)queries;
+}
+
+// Mostly small merges, with the occasional tall group label, scattered over a large grid.
+static MMGridSpan *MMBenchmarkMakeSpans(long count)
+{
+    MMGridSpan *spans = malloc((size_t)count * sizeof(MMGridSpan));
+    if (spans == NULL) {
+        return NULL;
+    }
+    for (long i = 0; i < count; i++) {
+        spans[i].row = (long)(MMBenchmarkRandom() % (unsigned long)MMBenchmarkSpanGridRows);
+        spans[i].column = (long)(MMBenchmarkRandom() % (unsigned long)MMBenchmarkSpanGridColumns);
+        spans[i].rowCount = MMBenchmarkRandom() % 64 == 0 ? 1 + (long)(MMBenchmarkRandom() % 5000) : 1 + (long)(MMBenchmarkRandom() % 3);
+        spans[i].columnCount = 1 + (long)(MMBenchmarkRandom() % 8);
+    }
+    return spans;
+}
+
+static int MMBenchmarkRunSpans(int quick)
+{
+    size_t spanCountCount = sizeof(MMBenchmarkSpanCounts) / sizeof(MMBenchmarkSpanCounts[0]);
+    if (quick) {
+        spanCountCount--;
+    }
+
+    printf("\n%-16s %14s %10s\n", "merged cells", "query ns/op", "verified");
+    for (size_t i = 0; i < spanCountCount; i++) {
+        long spanCount = MMBenchmarkSpanCounts[i];
+        MMGridSpan *spans = MMBenchmarkMakeSpans(spanCount);
+        MMGridSpanIndex index;
+        MMGridSpanIndexInit(&index);
+        if (spans == NULL || !MMGridSpanIndexBuild(&index, spans, spanCount)) {
+            fprintf(stderr, "Could not allocate %ld merged cells\n", spanCount);
+            free(spans);
+            return 0;
+        }
+        if (!MMBenchmarkVerifySpans(&index, spans, spanCount)) {
+            MMGridSpanIndexFree(&index);
+            free(spans);
+            return 0;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%ld", spanCount);
+        printf("%-16s %14.1f %10s\n", name, MMBenchmarkSpanLookups(&index, MMBenchmarkSpanQueries), "yes");
+        MMGridSpanIndexFree(&index);
+        free(spans);
+    }
+    return 1;
+}
+
+// MARK: - Column summaries
+
+static int MMBenchmarkVerifySummary(const MMGridSummary *summary, const double *values, long count)
+{
+    MMGridAggregate expected = { 0.0, NAN, NAN, 0 };
+    for (long i = 0; i < count; i++) {
+        if (isnan(values[i])) {
+            continue;
+        }
+        expected.minimum = expected.count == 0 || values[i] < expected.minimum ? values[i] : expected.minimum;
+        expected.maximum = expected.count == 0 || values[i] > expected.maximum ? values[i] : expected.maximum;
+        expected.sum += values[i];
+        expected.count++;
+    }
+    MMGridAggregate total = summary->total;
+    // The sums add in a different order, so allow for rounding.
+    if (total.count != expected.count || total.minimum != expected.minimum || total.maximum != expected.maximum ||
+        fabs(total.sum - expected.sum) > 1e-9 * fabs(expected.sum) + 1e-6) {
+        fprintf(stderr, "summary of %ld values: got {%f, %f, %f, %ld}, expected {%f, %f, %f, %ld}\n",
+                count, total.sum, total.minimum, total.maximum, total.count,
+                expected.sum, expected.minimum, expected.maximum, expected.count);
+        return 0;
+    }
+    return 1;
+}
+
+static double MMBenchmarkSummaryUpdateLoop(MMGridSummary *summary, double *values, long count, long updates)
+{
+    double start = MMBenchmarkNow();
+    for (long i = 0; i < updates; i++) {
+        long row = (long)(MMBenchmarkRandom() % (unsigned long)count);
+        values[row] = (i % MMBenchmarkSummaryBlankInterval == 0) ? NAN : MMBenchmarkRandomDouble(1000.0) - 500.0;
+        MMGridRange changed = { row, 1 };
+        MMGridSummaryUpdate(summary, values, changed);
+    }
+    return (MMBenchmarkNow() - start) / (double)updates;
+}
+
+static int MMBenchmarkRunSummaries(int quick)
+{
+    size_t rowCountCount = sizeof(MMBenchmarkSummaryRowCounts) / sizeof(MMBenchmarkSummaryRowCounts[0]);
+    if (quick) {
+        rowCountCount--;
+    }
+
+    printf("\n%-16s %14s %14s %10s\n", "column summary", "build ms", "update ns/op", "verified");
+    for (size_t i = 0; i < rowCountCount; i++) {
+        long count = MMBenchmarkSummaryRowCounts[i];
+        double *values = malloc((size_t)count * sizeof(double));
+        MMGridSummary summary;
+        MMGridSummaryInit(&summary);
+        if (values == NULL) {
+            fprintf(stderr, "Could not allocate %ld values\n", count);
+            return 0;
+        }
+        for (long row = 0; row < count; row++) {
+            values[row] = (row % MMBenchmarkSummaryBlankInterval == 0) ? NAN : MMBenchmarkRandomDouble(1000.0) - 500.0;
+        }
+
+        double start = MMBenchmarkNow();
+        int built = MMGridSummaryBuild(&summary, values, count);
+        double buildTime = (MMBenchmarkNow() - start) / 1e6;
+        if (!built || !MMBenchmarkVerifySummary(&summary, values, count)) {
+            MMGridSummaryFree(&summary);
+            free(values);
+            return 0;
+        }
+
+        double updateTime = MMBenchmarkSummaryUpdateLoop(&summary, values, count, MMBenchmarkSummaryUpdates);
+        if (!MMBenchmarkVerifySummary(&summary, values, count)) {
+            MMGridSummaryFree(&summary);
+            free(values);
+            return 0;
+        }
+
+        // Rows streamed in by a loading file, in batches that do not line up with the blocks.
+        MMGridSummary appended;
+        MMGridSummaryInit(&appended);
+        int appendedAll = MMGridSummaryBuild(&appended, values, count / 3);
+        for (long end = count / 3; appendedAll && end < count; ) {
+            end = end + 1 + (long)(MMBenchmarkRandom() % 5000);
+            end = end < count ? end : count;
+            appendedAll = MMGridSummaryAppend(&appended, values, end);
+        }
+        int appendVerified = appendedAll && MMBenchmarkVerifySummary(&appended, values, count);
+        MMGridSummaryFree(&appended);
+        if (!appendVerified) {
+            MMGridSummaryFree(&summary);
+            free(values);
+            return 0;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%ld", count);
+        printf("%-16s %14.2f %14.1f %10s\n", name, buildTime, updateTime, "yes");
+        MMGridSummaryFree(&summary);
+        free(values);
+    }
+    return 1;
+}
+
+// MARK: - Update queue
+
+typedef struct {
+    MMGridUpdateQueue *queue;
+    long column;
+    long count;
+} MMBenchmarkQueueProducer;
+
+static void *MMBenchmarkQueueProduce(void *argument)
+{
+    MMBenchmarkQueueProducer *producer = argument;
+    for (long row = 0; row < producer->count; row++) {
+        MMGridCellIndex cell = { row, producer->column };
+        // Unlike the view, which drops to a full redraw, retry so every cell can be accounted for.
+        while (!MMGridUpdateQueuePush(producer->queue, cell)) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Each producer pushes its rows in order into its own column, so the consumer can check that nothing is lost, repeated or reordered.
+static int MMBenchmarkQueueStream(long producerCount, double *nanosecondsPerUpdate)
+{
+    MMGridUpdateQueue queue;
+    MMGridCellIndex *cells = malloc((size_t)MMBenchmarkQueueCapacity * sizeof(MMGridCellIndex));
+    long *nextRows = calloc((size_t)producerCount, sizeof(long));
+    MMBenchmarkQueueProducer *producers = malloc((size_t)producerCount * sizeof(MMBenchmarkQueueProducer));
+    pthread_t *threads = malloc((size_t)producerCount * sizeof(pthread_t));
+    if (!MMGridUpdateQueueInit(&queue, MMBenchmarkQueueCapacity) || cells == NULL || nextRows == NULL || producers == NULL || threads == NULL) {
+        fprintf(stderr, "Could not allocate a queue for %ld producers\n", producerCount);
+        MMGridUpdateQueueFree(&queue);
+        free(cells);
+        free(nextRows);
+        free(producers);
+        free(threads);
+        return 0;
+    }
+
+    double start = MMBenchmarkNow();
+    long started = 0;
+    for (; started < producerCount; started++) {
+        producers[started] = (MMBenchmarkQueueProducer){ &queue, started, MMBenchmarkQueueUpdatesPerProducer };
+        if (pthread_create(&threads[started], NULL, MMBenchmarkQueueProduce, &producers[started]) != 0) {
+            fprintf(stderr, "Could not start producer %ld\n", started);
+            break;
+        }
+    }
+
+    int verified = started == producerCount;
+    long expected = started * MMBenchmarkQueueUpdatesPerProducer;
+    long received = 0;
+    while (received < expected) {
+        long count = MMGridUpdateQueueDrain(&queue, cells, MMBenchmarkQueueCapacity);
+        for (long i = 0; i < count; i++) {
+            MMGridCellIndex cell = cells[i];
+            if (cell.column < 0 || cell.column >= started || cell.row != nextRows[cell.column]) {
+                fprintf(stderr, "update queue with %ld producers: got (%ld, %ld) out of order\n", producerCount, cell.row, cell.column);
+                verified = 0;
+                received = expected;
+                break;
+            }
+            nextRows[cell.column]++;
+        }
+        received += count;
+        if (count == 0) {
+            sched_yield();
+        }
+    }
+
+    for (long i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    *nanosecondsPerUpdate = (MMBenchmarkNow() - start) / (double)(expected > 0 ? expected : 1);
+    if (verified && MMGridUpdateQueueDrain(&queue, cells, MMBenchmarkQueueCapacity) != 0) {
+        fprintf(stderr, "update queue with %ld producers: cells left over\n", producerCount);
+        verified = 0;
+    }
+
+    MMGridUpdateQueueFree(&queue);
+    free(cells);
+    free(nextRows);
+    free(producers);
+    free(threads);
+    return verified;
+}
+
+// A frame's worth of ticks concentrated on a few hot cells, as a live feed tends to be.
+static int MMBenchmarkQueueCoalesce(double *nanosecondsPerCell, double *distinctFraction)
+{
+    long hotCells = MMBenchmarkQueueHotRows * MMBenchmarkQueueHotColumns;
+    MMGridCellIndex *cells = malloc((size_t)MMBenchmarkQueueCapacity * sizeof(MMGridCellIndex));
+    unsigned char *seen = malloc((size_t)hotCells);
+    if (cells == NULL || seen == NULL) {
+        fprintf(stderr, "Could not allocate %ld cells\n", MMBenchmarkQueueCapacity);
+        free(cells);
+        free(seen);
+        return 0;
+    }
+
+    double elapsed = 0.0;
+    long distinctTotal = 0;
+    for (long frame = 0; frame < MMBenchmarkQueueFrames; frame++) {
+        memset(seen, 0, (size_t)hotCells);
+        long expected = 0;
+        for (long i = 0; i < MMBenchmarkQueueCapacity; i++) {
+            long row = (long)(MMBenchmarkRandom() % (unsigned long)MMBenchmarkQueueHotRows);
+            long column = (long)(MMBenchmarkRandom() % (unsigned long)MMBenchmarkQueueHotColumns);
+            cells[i] = (MMGridCellIndex){ row, column };
+            if (!seen[row * MMBenchmarkQueueHotColumns + column]) {
+                seen[row * MMBenchmarkQueueHotColumns + column] = 1;
+                expected++;
+            }
+        }
+
+        double start = MMBenchmarkNow();
+        long distinct = MMGridCellIndexCoalesce(cells, MMBenchmarkQueueCapacity);
+        elapsed += MMBenchmarkNow() - start;
+
+        if (distinct != expected) {
+            fprintf(stderr, "coalesce: got %ld distinct cells, expected %ld\n", distinct, expected);
+            free(cells);
+            free(seen);
+            return 0;
+        }
+        for (long i = 0; i < distinct; i++) {
+            MMGridCellIndex cell = cells[i];
+            int ordered = i == 0 || cell.row > cells[i - 1].row || (cell.row == cells[i - 1].row && cell.column > cells[i - 1].column);
+            if (!ordered || !seen[cell.row * MMBenchmarkQueueHotColumns + cell.column]) {
+                fprintf(stderr, "coalesce: (%ld, %ld) out of order or never queued\n", cell.row, cell.column);
+                free(cells);
+                free(seen);
+                return 0;
+            }
+        }
+        for (long row = 0; row < MMBenchmarkQueueHotRows; row++) {
+            for (long column = 0; column < MMBenchmarkQueueHotColumns; column++) {
+                long position = MMGridCellIndexSearch(cells, distinct, (MMGridCellIndex){ row, column });
+                int found = position >= 0 && cells[position].row == row && cells[position].column == column;
+                if (found != seen[row * MMBenchmarkQueueHotColumns + column]) {
+                    fprintf(stderr, "search: (%ld, %ld) %s\n", row, column, found ? "found but never queued" : "queued but not found");
+                    free(cells);
+                    free(seen);
+                    return 0;
+                }
+            }
+        }
+        distinctTotal += distinct;
+    }
+
+    *nanosecondsPerCell = elapsed / (double)(MMBenchmarkQueueFrames * MMBenchmarkQueueCapacity);
+    *distinctFraction = (double)distinctTotal / (double)(MMBenchmarkQueueFrames * MMBenchmarkQueueCapacity);
+    free(cells);
+    free(seen);
+    return 1;
+}
+
+static int MMBenchmarkRunUpdateQueue(int quick)
+{
+    size_t producerCountCount = sizeof(MMBenchmarkQueueProducerCounts) / sizeof(MMBenchmarkQueueProducerCounts[0]);
+    if (quick) {
+        producerCountCount--;
+    }
+
+    printf("\n%-16s %14s %10s\n", "update producers", "ns/update", "verified");
+    for (size_t i = 0; i < producerCountCount; i++) {
+        long producerCount = MMBenchmarkQueueProducerCounts[i];
+        double updateTime = 0.0;
+        if (!MMBenchmarkQueueStream(producerCount, &updateTime)) {
+            return 0;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "%ld", producerCount);
+        printf("%-16s %14.1f %10s\n", name, updateTime, "yes");
+    }
+
+    double coalesceTime = 0.0;
+    double distinctFraction = 0.0;
+    if (!MMBenchmarkQueueCoalesce(&coalesceTime, &distinctFraction)) {
+        return 0;
+    }
+    printf("\n%-16s %14s %14s %10s\n", "coalesce", "ns/cell", "distinct", "verified");
+    printf("%-16ld %14.1f %13.0f%% %10s\n", MMBenchmarkQueueCapacity, coalesceTime, distinctFraction * 100.0, "yes");
+    return 1;
+}
+
+// MARK: - Main
+
+// MARK: - Uniform axes
+
+static int MMBenchmarkRunUniform(int quick)
+{
+    size_t rowCountCount = sizeof(MMBenchmarkUniformRowCounts) / sizeof(MMBenchmarkUniformRowCounts[0]);
+    if (quick) {
+        rowCountCount--;
+    }
+
+    printf("\n%-16s %14s %14s %10s\n", "uniform rows", "offset ns/op", "range ns/op", "verified");
+    for (size_t i = 0; i < rowCountCount; i++) {
+        long rowCount = MMBenchmarkUniformRowCounts[i];
+        MMGridAxis rows;
+        MMGridAxis copiedRows;
+        MMGridAxis columns;
+        MMGridAxisInit(&rows);
+        MMGridAxisInit(&copiedRows);
+        MMGridAxisInit(&columns);
+        if (!MMGridAxisFillUniform(&rows, rowCount, MMBenchmarkUniformRowHeight) ||
+            !MMGridAxisCopy(&copiedRows, &rows) ||
+            !MMBenchmarkFillMixed(&columns, MMBenchmarkUniformColumns, 60.0, 30.0)) {
+            fprintf(stderr, "Could not allocate a uniform %ld x %ld grid\n", rowCount, MMBenchmarkUniformColumns);
+            MMGridAxisFree(&rows);
+            MMGridAxisFree(&copiedRows);
+            MMGridAxisFree(&columns);
+            return 0;
+        }
+
+        int verified = 0;
+        if (rows.offsets != NULL || copiedRows.offsets != NULL ||
+            MMGridAxisLength(&copiedRows) != (double)rowCount * MMBenchmarkUniformRowHeight ||
+            MMGridAxisSize(&copiedRows, rowCount - 1) != MMBenchmarkUniformRowHeight) {
+            fprintf(stderr, "uniform axis of %ld rows has a table or the wrong length\n", rowCount);
+            verified = -1;
+        }
+        else if (rowCount <= MMBenchmarkVerifyRowLimit) {
+            MMGridSplit split = MMGridSplitMake(1, 1, 0);
+            verified = MMBenchmarkVerify(&copiedRows, &columns, split) && MMBenchmarkVerify(&columns, &copiedRows, split) ? 1 : -1;
+        }
+        if (verified < 0) {
+            MMGridAxisFree(&rows);
+            MMGridAxisFree(&copiedRows);
+            MMGridAxisFree(&columns);
+            return 0;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%ldx%ld", rowCount, MMBenchmarkUniformColumns);
+        printf("%-16s %14.1f %14.1f %10s\n",
+               name,
+               MMBenchmarkOffsetLookups(&rows, MMBenchmarkUniformQueries),
+               MMBenchmarkVisibleRanges(&rows, &columns, MMBenchmarkUniformQueries),
+               verified ? "yes" : "no");
+
+        MMGridAxisFree(&rows);
+        MMGridAxisFree(&copiedRows);
+        MMGridAxisFree(&columns);
+    }
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    // Pass --quick to skip the largest grid, e.g. on memory constrained machines.
+    int quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    size_t gridCount = sizeof(MMBenchmarkGrids) / sizeof(MMBenchmarkGrids[0]);
+    if (quick) {
+        gridCount--;
+    }
+
+    printf("%-16s %14s %14s %14s %10s\n", "grid", "offset ns/op", "range ns/op", "mapping ns/op", "verified");
+    for (size_t index = 0; index < gridCount; index++) {
+        MMBenchmarkGrid grid = MMBenchmarkGrids[index];
+        MMGridAxis rows;
+        MMGridAxis columns;
+        MMGridAxisInit(&rows);
+        MMGridAxisInit(&columns);
+        if (!MMBenchmarkFillMixed(&rows, grid.rows, 20.0, 10.0) || !MMBenchmarkFillMixed(&columns, grid.columns, 60.0, 30.0)) {
+            fprintf(stderr, "Could not allocate a %ld x %ld grid\n", grid.rows, grid.columns);
+            MMGridAxisFree(&rows);
+            MMGridAxisFree(&columns);
+            return 1;
+        }
+
+        MMGridSplit split = MMGridSplitMake(grid.rows > 1 ? 1 : 0, grid.columns > 1 ? 1 : 0, 0);
+        int verified = 0;
+        if (grid.rows <= MMBenchmarkVerifyRowLimit) {
+            if (!MMBenchmarkVerify(&rows, &columns, split) || !MMBenchmarkVerify(&columns, &rows, split)) {
+                MMGridAxisFree(&rows);
+                MMGridAxisFree(&columns);
+                return 1;
+            }
+            verified = 1;
+        }
+
+        char name[32];
+        snprintf(name, sizeof(name), "%ldx%ld", grid.rows, grid.columns);
+        printf("%-16s %14.1f %14.1f %14.1f %10s\n",
+               name,
+               MMBenchmarkOffsetLookups(&rows, grid.queries),
+               MMBenchmarkVisibleRanges(&rows, &columns, grid.queries),
+               MMBenchmarkIndexMapping(split, grid.rows, grid.columns, grid.queries),
+               verified ? "yes" : "no");
+
+        MMGridAxisFree(&rows);
+        MMGridAxisFree(&columns);
+    }
+    return MMBenchmarkRunUniform(quick) && MMBenchmarkRunSpans(quick) && MMBenchmarkRunSummaries(quick) && MMBenchmarkRunUpdateQueue(quick) ? 0 : 1;
+}
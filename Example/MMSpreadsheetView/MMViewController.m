@@ -27,7 +27,6 @@
 
 @interface MMViewController () <MMSpreadsheetViewDataSource, MMSpreadsheetViewDelegate>
 
-@property (nonatomic, strong) NSMutableSet *selectedGridCells;
 @property (nonatomic, strong) NSMutableArray *tableData;
 @property (nonatomic, strong) NSString *cellDataBuffer;
 
@@ -53,8 +52,6 @@
         [self.tableData addObject:row];
     }
     
-    self.selectedGridCells = [NSMutableSet set];
-
     // Create the spreadsheet in code.
     MMSpreadsheetView *spreadSheetView = [[MMSpreadsheetView alloc] initWithNumberOfHeaderRows:1 numberOfHeaderColumns:1 frame:self.view.bounds];
     self.restorationIdentifier = NSStringFromClass([self class]);
@@ -174,12 +171,20 @@
 
 - (void)spreadsheetView:(MMSpreadsheetView *)spreadsheetView didSelectItemAtIndexPath:(NSIndexPath *)indexPath
 {
-    if ([self.selectedGridCells containsObject:indexPath]) {
-        [self.selectedGridCells removeObject:indexPath];
+    if ([spreadsheetView isItemSelectedAtIndexPath:indexPath]) {
+        [spreadsheetView clearSelection];
         [spreadsheetView deselectItemAtIndexPath:indexPath animated:YES];
-    } else {
-        [self.selectedGridCells removeAllObjects];
-        [self.selectedGridCells addObject:indexPath];
+    }
+    else if (indexPath.mmSpreadsheetRow == 0 && indexPath.mmSpreadsheetColumn > 0) {
+        // Tapping a column header selects the whole column.
+        [spreadsheetView selectColumnsFromColumn:indexPath.mmSpreadsheetColumn toColumn:indexPath.mmSpreadsheetColumn addingToSelection:NO];
+    }
+    else if (indexPath.mmSpreadsheetColumn == 0 && indexPath.mmSpreadsheetRow > 0) {
+        // Tapping a row header selects the whole row.
+        [spreadsheetView selectRowsFromRow:indexPath.mmSpreadsheetRow toRow:indexPath.mmSpreadsheetRow addingToSelection:NO];
+    }
+    else {
+        [spreadsheetView selectCellsFromIndexPath:indexPath toIndexPath:indexPath addingToSelection:NO];
     }
 }
 
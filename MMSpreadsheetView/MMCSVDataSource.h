@@ -0,0 +1,105 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+#import "MMSpreadsheetView.h"
+
+/**
+ `MMCSVDataSource` is a spreadsheet data source backed by a memory-mapped CSV file. It is ready to display as soon as it is created, however large the file is.
+ 
+ Creating the data source finds the start of the first rows only. The rest of the file is indexed on a background queue, and each time a batch of rows is indexed the row count grows and the new rows are appended to spreadsheetView with `insertRows:`. The index holds one 8 byte offset per row. Cells are parsed from the mapped file when they are asked for, and recently parsed rows are cached.
+ 
+ Fields follow RFC 4180: a field may be quoted, quoted fields may contain the delimiter and line breaks, and `""` inside a quoted field is a literal quote. Lines may end in `\n` or `\r\n`. Text is read as UTF-8, falling back to ISO Latin 1 for fields that are not valid UTF-8.
+ 
+ The column count is the widest row indexed so far. When the background indexing finds a wider row, the new columns are appended with `insertColumns:` before the rows are.
+ */
+@interface MMCSVDataSource : NSObject <MMSpreadsheetViewDataSource, MMSpreadsheetViewValueDataSource>
+
+/**
+ Maps a comma separated file and indexes its first rows.
+ 
+ @param path The path of the file.
+ @param error On failure, the error from reading the file.
+ 
+ @return A data source, or nil if the file could not be mapped.
+ */
+- (instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error;
+
+/**
+ Maps a delimited file and indexes its first rows.
+ 
+ @param path The path of the file.
+ @param delimiter The field delimiter, such as `,` or `\t`.
+ @param error On failure, the error from reading the file.
+ 
+ @return A data source, or nil if the file could not be mapped.
+ */
+- (instancetype)initWithContentsOfFile:(NSString *)path delimiter:(char)delimiter error:(NSError **)error;
+
+/**
+ The spreadsheet view this data source is displayed in. Rows indexed in the background are inserted into it. Set it along with the view's dataSource, in the same pass of the run loop.
+ */
+@property (nonatomic, weak) MMSpreadsheetView *spreadsheetView;
+
+/**
+ The number of rows indexed so far. This is what `numberOfRowsInSpreadsheetView:` returns.
+ */
+@property (nonatomic, readonly) NSUInteger rowCount;
+
+/**
+ The number of columns.
+ */
+@property (nonatomic, readonly) NSUInteger columnCount;
+
+/**
+ A Boolean value that is YES once the whole file has been indexed.
+ */
+@property (nonatomic, readonly, getter = isFinishedIndexing) BOOL finishedIndexing;
+
+/**
+ Called on the main thread once the whole file has been indexed.
+ */
+@property (nonatomic, copy) void (^indexingCompletionBlock)(void);
+
+/**
+ The size returned for every cell. Since every row has the same height, it is also given as the uniform row height, so no table of row heights is kept. Default is 100 x 30.
+ */
+@property (nonatomic, assign) CGSize itemSize;
+
+/**
+ The reuse identifier cells are dequeued with. Register a cell class for it on the spreadsheet view. Default is `MMCSVCell`.
+ */
+@property (nonatomic, copy) NSString *cellReuseIdentifier;
+
+/**
+ Called to put a cell's text into a dequeued cell. Without it, cells are returned as dequeued.
+ */
+@property (nonatomic, copy) void (^cellConfigurationBlock)(UICollectionViewCell *cell, NSString *text, NSIndexPath *indexPath);
+
+/**
+ The text of a cell, parsed from the mapped file. Safe to call from any thread.
+ 
+ @param indexPath A spreadsheet index path, using *indexPath.mmSpreadsheetRow* and *indexPath.mmSpreadsheetColumn*.
+ 
+ @return The cell's text, or nil if the row has not been indexed or has no such field.
+ */
+- (NSString *)textForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+@end
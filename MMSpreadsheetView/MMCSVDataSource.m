@@ -0,0 +1,399 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "MMCSVDataSource.h"
+#import <QuartzCore/QuartzCore.h>
+#import "NSIndexPath+MMSpreadsheetView.h"
+
+static const NSUInteger MMCSVInitialRowCount = 256;
+static const NSUInteger MMCSVIndexBatchLength = 1024;
+static const CFTimeInterval MMCSVPublishInterval = 0.25;
+static const NSUInteger MMCSVRowCacheLimit = 1024;
+static const NSUInteger MMCSVRowIndexBlockLength = 65536;
+
+typedef struct {
+    uint64_t position;
+    BOOL inQuotes;
+    NSUInteger fieldCount;
+    NSUInteger maxFieldCount;
+} MMCSVScanState;
+
+static NSUInteger MMCSVCountByte(const uint8_t *bytes, uint64_t length, uint8_t byte)
+{
+    NSUInteger count = 0;
+    const uint8_t *end = bytes + length;
+    while ((bytes = memchr(bytes, byte, (size_t)(end - bytes)))) {
+        count++;
+        bytes++;
+    }
+    return count;
+}
+
+// Finds the starts of up to capacity rows after state->position. A row ends at a line feed outside of quotes.
+// Returns the number of row starts written, and leaves state at the first byte not yet scanned. Delimiters
+// outside of quotes are counted on the way, so state->maxFieldCount is the widest row scanned so far.
+static NSUInteger MMCSVScanRows(const uint8_t *bytes, uint64_t length, char delimiter, MMCSVScanState *state, uint64_t *rowStarts, NSUInteger capacity)
+{
+    NSUInteger found = 0;
+    uint64_t position = state->position;
+    while (position < length && found < capacity) {
+        if (state->inQuotes) {
+            const uint8_t *quote = memchr(bytes + position, '"', (size_t)(length - position));
+            if (quote == NULL) {
+                position = length;
+                break;
+            }
+            position = quote - bytes + 1;
+            state->inQuotes = NO;
+            continue;
+        }
+
+        const uint8_t *newline = memchr(bytes + position, '\n', (size_t)(length - position));
+        uint64_t lineEnd = newline ? (uint64_t)(newline - bytes) : length;
+        const uint8_t *quote = memchr(bytes + position, '"', (size_t)(lineEnd - position));
+        uint64_t segmentEnd = quote ? (uint64_t)(quote - bytes) : lineEnd;
+        state->fieldCount += MMCSVCountByte(bytes + position, segmentEnd - position, (uint8_t)delimiter);
+        state->maxFieldCount = MAX(state->maxFieldCount, state->fieldCount);
+        if (quote) {
+            // An escaped quote toggles twice, so tracking parity is enough.
+            position = quote - bytes + 1;
+            state->inQuotes = YES;
+        }
+        else if (newline) {
+            position = lineEnd + 1;
+            rowStarts[found++] = position;
+            state->fieldCount = 1;
+        }
+        else {
+            position = length;
+        }
+    }
+    state->position = position;
+    return found;
+}
+
+static NSString *MMCSVStringFromBytes(const void *bytes, NSUInteger length)
+{
+    NSString *string = [[NSString alloc] initWithBytes:bytes length:length encoding:NSUTF8StringEncoding];
+    return string ?: [[NSString alloc] initWithBytes:bytes length:length encoding:NSISOLatin1StringEncoding];
+}
+
+static NSArray *MMCSVParseFields(const uint8_t *bytes, NSUInteger length, char delimiter)
+{
+    NSMutableArray *fields = [NSMutableArray array];
+    NSUInteger position = 0;
+    while (YES) {
+        const uint8_t *next = NULL;
+        if (position < length && bytes[position] == '"') {
+            NSMutableData *field = [NSMutableData data];
+            position++;
+            while (position < length) {
+                const uint8_t *quote = memchr(bytes + position, '"', length - position);
+                NSUInteger quoteIndex = quote ? (NSUInteger)(quote - bytes) : length;
+                [field appendBytes:bytes + position length:quoteIndex - position];
+                position = quoteIndex + 1;
+                if (position < length && bytes[position] == '"') {
+                    [field appendBytes:"\"" length:1];
+                    position++;
+                }
+                else {
+                    break;
+                }
+            }
+            [fields addObject:MMCSVStringFromBytes(field.bytes, [field length])];
+
+            // Anything between the closing quote and the delimiter is dropped.
+            if (position < length) {
+                next = memchr(bytes + position, delimiter, length - position);
+            }
+        }
+        else {
+            next = memchr(bytes + position, delimiter, length - position);
+            NSUInteger fieldEnd = next ? (NSUInteger)(next - bytes) : length;
+            [fields addObject:MMCSVStringFromBytes(bytes + position, fieldEnd - position)];
+        }
+        if (next == NULL) {
+            break;
+        }
+        position = next - bytes + 1;
+    }
+    return fields;
+}
+
+#pragma mark - MMCSVRowIndex
+
+/**
+ Row start offsets, stored in fixed blocks that never move once allocated. One thread appends while others read entries that were published to them, without locking.
+ */
+@interface MMCSVRowIndex : NSObject
+
+@property (nonatomic, readonly) NSUInteger count;
+
+- (instancetype)initWithFileLength:(uint64_t)fileLength;
+- (void)appendOffsets:(const uint64_t *)offsets count:(NSUInteger)count;
+- (uint64_t)offsetAtIndex:(NSUInteger)index;
+
+@end
+
+@implementation MMCSVRowIndex
+{
+    uint64_t **_blocks;
+    NSUInteger _blockCapacity;
+}
+
+- (instancetype)initWithFileLength:(uint64_t)fileLength
+{
+    self = [super init];
+    if (self) {
+        // A file of n bytes has at most n + 1 rows, plus the end of file entry.
+        _blockCapacity = (NSUInteger)((fileLength + 2) / MMCSVRowIndexBlockLength) + 1;
+        _blocks = calloc(_blockCapacity, sizeof(uint64_t *));
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    for (NSUInteger block = 0; block < _blockCapacity; block++) {
+        free(_blocks[block]);
+    }
+    free(_blocks);
+}
+
+- (void)appendOffsets:(const uint64_t *)offsets count:(NSUInteger)count
+{
+    for (NSUInteger i = 0; i < count; i++) {
+        NSUInteger block = _count / MMCSVRowIndexBlockLength;
+        NSAssert(block < _blockCapacity, @"More rows than bytes in the file.");
+        if (_blocks[block] == NULL) {
+            _blocks[block] = malloc(MMCSVRowIndexBlockLength * sizeof(uint64_t));
+        }
+        _blocks[block][_count % MMCSVRowIndexBlockLength] = offsets[i];
+        _count++;
+    }
+}
+
+- (uint64_t)offsetAtIndex:(NSUInteger)index
+{
+    NSParameterAssert(index < _count);
+    return _blocks[index / MMCSVRowIndexBlockLength][index % MMCSVRowIndexBlockLength];
+}
+
+@end
+
+// Once the whole file is scanned, adds the end of the last row if the file does not end in a line feed.
+static BOOL MMCSVFinishIndexIfScanReachedEnd(MMCSVRowIndex *rowIndex, MMCSVScanState state, uint64_t length)
+{
+    if (state.position < length) {
+        return NO;
+    }
+    if ([rowIndex offsetAtIndex:rowIndex.count - 1] < length) {
+        [rowIndex appendOffsets:&length count:1];
+    }
+    return YES;
+}
+
+#pragma mark - MMCSVDataSource
+
+@interface MMCSVDataSource ()
+
+@property (nonatomic, strong) NSData *fileData;
+@property (nonatomic, strong) MMCSVRowIndex *rowIndex;
+@property (nonatomic, strong) NSCache *rowCache;
+@property (nonatomic, assign) char delimiter;
+@property (nonatomic, assign) NSUInteger rowCount;
+@property (nonatomic, assign) NSUInteger columnCount;
+@property (nonatomic, assign) BOOL finishedIndexing;
+
+@end
+
+@implementation MMCSVDataSource
+
+- (instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error
+{
+    return [self initWithContentsOfFile:path delimiter:',' error:error];
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path delimiter:(char)delimiter error:(NSError **)error
+{
+    self = [super init];
+    if (self) {
+        _delimiter = delimiter;
+        _itemSize = CGSizeMake(100.0f, 30.0f);
+        _cellReuseIdentifier = @"MMCSVCell";
+        _rowCache = [[NSCache alloc] init];
+        _rowCache.countLimit = MMCSVRowCacheLimit;
+
+        _fileData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:error];
+        if (_fileData == nil) {
+            return nil;
+        }
+
+        const uint8_t *bytes = _fileData.bytes;
+        uint64_t length = [_fileData length];
+        uint64_t start = (length >= 3 && memcmp(bytes, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+        _rowIndex = [[MMCSVRowIndex alloc] initWithFileLength:length];
+        [_rowIndex appendOffsets:&start count:1];
+
+        // Only the first rows are indexed here, so opening takes the same time for any file size.
+        MMCSVScanState state = {start, NO, 1, 0};
+        uint64_t rowStarts[MMCSVInitialRowCount];
+        NSUInteger found = MMCSVScanRows(bytes, length, delimiter, &state, rowStarts, MMCSVInitialRowCount);
+        [_rowIndex appendOffsets:rowStarts count:found];
+        _finishedIndexing = MMCSVFinishIndexIfScanReachedEnd(_rowIndex, state, length);
+        _rowCount = _rowIndex.count - 1;
+        _columnCount = state.maxFieldCount;
+        if (!_finishedIndexing) {
+            [self indexRemainingRowsFromState:state];
+        }
+    }
+    return self;
+}
+
+#pragma mark - Indexing
+
+- (void)indexRemainingRowsFromState:(MMCSVScanState)initialState
+{
+    __weak MMCSVDataSource *weakSelf = self;
+    NSData *fileData = self.fileData;
+    MMCSVRowIndex *rowIndex = self.rowIndex;
+    char delimiter = self.delimiter;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_LOW, 0), ^{
+        const uint8_t *bytes = fileData.bytes;
+        uint64_t length = [fileData length];
+        MMCSVScanState state = initialState;
+        uint64_t rowStarts[MMCSVIndexBatchLength];
+        CFTimeInterval lastPublishTime = CACurrentMediaTime();
+        BOOL finished = NO;
+        while (!finished && weakSelf) {
+            NSUInteger found = MMCSVScanRows(bytes, length, delimiter, &state, rowStarts, MMCSVIndexBatchLength);
+            [rowIndex appendOffsets:rowStarts count:found];
+            finished = MMCSVFinishIndexIfScanReachedEnd(rowIndex, state, length);
+
+            CFTimeInterval now = CACurrentMediaTime();
+            if (finished || now - lastPublishTime >= MMCSVPublishInterval) {
+                lastPublishTime = now;
+                NSUInteger rowCount = rowIndex.count - 1;
+                NSUInteger columnCount = state.maxFieldCount;
+                dispatch_async(dispatch_get_main_queue(), ^{
+                    [weakSelf didIndexRowCount:rowCount columnCount:columnCount finished:finished];
+                });
+            }
+        }
+    });
+}
+
+- (void)didIndexRowCount:(NSUInteger)rowCount columnCount:(NSUInteger)columnCount finished:(BOOL)finished
+{
+    BOOL showing = self.spreadsheetView.dataSource == self;
+    // Columns go in first, while the row count is still the one the spreadsheet view has.
+    NSUInteger previousColumnCount = self.columnCount;
+    if (columnCount > previousColumnCount) {
+        self.columnCount = columnCount;
+        if (showing) {
+            [self.spreadsheetView insertColumns:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(previousColumnCount, columnCount - previousColumnCount)]];
+        }
+    }
+    NSUInteger previousRowCount = self.rowCount;
+    self.rowCount = rowCount;
+    self.finishedIndexing = finished;
+    if (rowCount > previousRowCount && showing) {
+        [self.spreadsheetView insertRows:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(previousRowCount, rowCount - previousRowCount)]];
+    }
+    if (finished && self.indexingCompletionBlock) {
+        self.indexingCompletionBlock();
+    }
+}
+
+#pragma mark - Cell Text
+
+- (NSArray *)fieldsInRow:(NSUInteger)row
+{
+    NSNumber *key = @(row);
+    NSArray *fields = [self.rowCache objectForKey:key];
+    if (fields) {
+        return fields;
+    }
+
+    const uint8_t *bytes = self.fileData.bytes;
+    uint64_t start = [self.rowIndex offsetAtIndex:row];
+    uint64_t end = [self.rowIndex offsetAtIndex:row + 1];
+    if (end > start && bytes[end - 1] == '\n') {
+        end--;
+    }
+    if (end > start && bytes[end - 1] == '\r') {
+        end--;
+    }
+    fields = MMCSVParseFields(bytes + start, (NSUInteger)(end - start), self.delimiter);
+    [self.rowCache setObject:fields forKey:key];
+    return fields;
+}
+
+- (NSString *)textForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    NSInteger row = indexPath.mmSpreadsheetRow;
+    NSInteger column = indexPath.mmSpreadsheetColumn;
+    if (row < 0 || column < 0 || row >= (NSInteger)self.rowCount) {
+        return nil;
+    }
+    NSArray *fields = [self fieldsInRow:row];
+    return column < (NSInteger)[fields count] ? fields[column] : nil;
+}
+
+#pragma mark - MMSpreadsheetViewDataSource
+
+- (CGSize)spreadsheetView:(MMSpreadsheetView *)spreadsheetView sizeForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    return self.itemSize;
+}
+
+- (CGFloat)uniformRowHeightInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+{
+    return self.itemSize.height;
+}
+
+- (NSInteger)numberOfRowsInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+{
+    return self.rowCount;
+}
+
+- (NSInteger)numberOfColumnsInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+{
+    return self.columnCount;
+}
+
+- (UICollectionViewCell *)spreadsheetView:(MMSpreadsheetView *)spreadsheetView cellForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    UICollectionViewCell *cell = [spreadsheetView dequeueReusableCellWithReuseIdentifier:self.cellReuseIdentifier forIndexPath:indexPath];
+    if (self.cellConfigurationBlock) {
+        self.cellConfigurationBlock(cell, [self textForItemAtIndexPath:indexPath], indexPath);
+    }
+    return cell;
+}
+
+#pragma mark - MMSpreadsheetViewValueDataSource
+
+- (MMSpreadsheetCellValue *)spreadsheetView:(MMSpreadsheetView *)spreadsheetView valueForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    NSString *text = [self textForItemAtIndexPath:indexPath];
+    return [text length] > 0 ? [MMSpreadsheetCellValue valueWithText:text] : nil;
+}
+
+@end
@@ -0,0 +1,135 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+#import "MMSpreadsheetView.h"
+
+extern NSString *const MMColumnarDataSourceErrorDomain;
+
+typedef NS_ENUM(NSInteger, MMColumnarDataSourceError)
+{
+    MMColumnarDataSourceErrorInvalidFile = 1,
+    MMColumnarDataSourceErrorWriteFailed,
+};
+
+/**
+ The storage type of a column in a columnar file.
+ */
+typedef NS_ENUM(uint32_t, MMColumnarType)
+{
+    MMColumnarTypeInt64 = 0,
+    MMColumnarTypeDouble = 1,
+    MMColumnarTypeString = 2,
+};
+
+/**
+ `MMColumnarDataSource` is a spreadsheet data source backed by a memory-mapped, column-oriented file, for sheets too large to hold as an array of strings.
+ 
+ Only the file header is read when the data source is opened. Cell text is created when a cell is asked for, straight from the mapped bytes, so resident memory stays close to what is on screen no matter how many rows the file has.
+ 
+ ## File Format
+ All integers are little-endian.
+ 
+ - A 24 byte header: the 8 bytes `MMCOLS01`, the row count (uint64), the column count (uint32) and 4 reserved bytes.
+ - One 40 byte descriptor per column: type (uint32, a `MMColumnarType`), name length (uint32), name offset (uint64), data offset (uint64), string data offset (uint64) and string data length (uint64). Offsets are from the start of the file and names are UTF-8.
+ - Int64 and double columns store rowCount 8 byte values at the data offset.
+ - String columns store rowCount + 1 uint64 offsets at the data offset. The text of row n is the UTF-8 bytes from offset n to offset n + 1 within the string data.
+ 
+ Files can be produced with writeFileAtPath:columnNames:columnTypes:rowCount:values:error: or by any tool that writes the same layout.
+ 
+ The data source also adopts `MMSpreadsheetViewValueDataSource`, so it can back tiled rendering directly.
+ */
+@interface MMColumnarDataSource : NSObject <MMSpreadsheetViewDataSource, MMSpreadsheetViewValueDataSource>
+
+/**
+ Maps a columnar file.
+ 
+ @param path The path of the file.
+ @param error On failure, an error in `MMColumnarDataSourceErrorDomain` or from reading the file.
+ 
+ @return A data source, or nil if the file could not be mapped or its header is invalid.
+ */
+- (instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error;
+
+/**
+ The number of data rows in the file, not counting the column name row.
+ */
+@property (nonatomic, readonly) NSUInteger fileRowCount;
+
+/**
+ The names of the columns, in order.
+ */
+@property (nonatomic, readonly) NSArray *columnNames;
+
+/**
+ The storage type of a column.
+ */
+- (MMColumnarType)typeOfColumn:(NSUInteger)column;
+
+/**
+ A Boolean value that determines whether row 0 of the spreadsheet shows the column names. When YES, file row n is spreadsheet row n + 1. Default is YES.
+ */
+@property (nonatomic, assign) BOOL showsColumnNames;
+
+/**
+ The size returned for every cell. Since every row has the same height, it is also given as the uniform row height, so no table of row heights is kept. Default is 100 x 30.
+ */
+@property (nonatomic, assign) CGSize itemSize;
+
+/**
+ The reuse identifier cells are dequeued with. Register a cell class for it on the spreadsheet view. Default is `MMColumnarCell`.
+ */
+@property (nonatomic, copy) NSString *cellReuseIdentifier;
+
+/**
+ Called to put a cell's text into a dequeued cell. Without it, cells are returned as dequeued.
+ */
+@property (nonatomic, copy) void (^cellConfigurationBlock)(UICollectionViewCell *cell, NSString *text, NSIndexPath *indexPath);
+
+/**
+ The text of a cell, created from the mapped file. Safe to call from any thread.
+ 
+ @param indexPath A spreadsheet index path, using *indexPath.mmSpreadsheetRow* and *indexPath.mmSpreadsheetColumn*.
+ 
+ @return The cell's text, or nil if the cell is empty or out of range.
+ */
+- (NSString *)textForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ Writes a columnar file one column at a time.
+ 
+ @param path The path to write to. An existing file is replaced.
+ @param columnNames The name of each column.
+ @param columnTypes An `NSNumber` holding the `MMColumnarType` of each column.
+ @param rowCount The number of rows.
+ @param values Returns the value of a cell: an `NSNumber` for numeric columns or an `NSString` for string columns. nil is written as 0 or an empty string.
+ @param error On failure, an error in `MMColumnarDataSourceErrorDomain`.
+ 
+ @return YES if the file was written.
+ @discussion Values are requested column by column, so the block is called rowCount times per column. String columns hold their offset table in memory while they are written, 8 bytes per row.
+ */
++ (BOOL)writeFileAtPath:(NSString *)path
+            columnNames:(NSArray *)columnNames
+            columnTypes:(NSArray *)columnTypes
+               rowCount:(NSUInteger)rowCount
+                 values:(id (^)(NSUInteger row, NSUInteger column))values
+                  error:(NSError **)error;
+
+@end
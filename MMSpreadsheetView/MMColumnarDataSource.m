@@ -0,0 +1,390 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "MMColumnarDataSource.h"
+#import <libkern/OSByteOrder.h>
+#import <stdio.h>
+#import "NSIndexPath+MMSpreadsheetView.h"
+
+NSString *const MMColumnarDataSourceErrorDomain = @"MMColumnarDataSourceErrorDomain";
+
+static const char MMColumnarFileMagic[8] = {'M', 'M', 'C', 'O', 'L', 'S', '0', '1'};
+static const uint64_t MMColumnarFileHeaderLength = 24;
+static const uint64_t MMColumnarFileDescriptorLength = 40;
+static const NSUInteger MMColumnarWriterRowsPerPool = 4096;
+
+typedef struct {
+    MMColumnarType type;
+    uint64_t dataOffset;
+    uint64_t stringDataOffset;
+    uint64_t stringDataLength;
+} MMColumnarColumn;
+
+static uint32_t MMColumnarReadUInt32(const uint8_t *bytes)
+{
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return OSSwapLittleToHostInt32(value);
+}
+
+static uint64_t MMColumnarReadUInt64(const uint8_t *bytes)
+{
+    uint64_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return OSSwapLittleToHostInt64(value);
+}
+
+static BOOL MMColumnarRangeIsValid(uint64_t offset, uint64_t length, uint64_t fileLength)
+{
+    return offset <= fileLength && length <= fileLength - offset;
+}
+
+static NSError *MMColumnarError(MMColumnarDataSourceError code, NSString *description)
+{
+    return [NSError errorWithDomain:MMColumnarDataSourceErrorDomain code:code userInfo:@{NSLocalizedDescriptionKey: description}];
+}
+
+@interface MMColumnarDataSource ()
+
+@property (nonatomic, strong) NSData *fileData;
+@property (nonatomic, strong) NSData *columnData;
+@property (nonatomic, assign) NSUInteger fileRowCount;
+@property (nonatomic, strong) NSArray *columnNames;
+
+@end
+
+@implementation MMColumnarDataSource
+
+- (instancetype)initWithContentsOfFile:(NSString *)path error:(NSError **)error
+{
+    self = [super init];
+    if (self) {
+        _showsColumnNames = YES;
+        _itemSize = CGSizeMake(100.0f, 30.0f);
+        _cellReuseIdentifier = @"MMColumnarCell";
+
+        // Mapped, so only the pages that are read are ever brought into memory.
+        _fileData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedAlways error:error];
+        if (_fileData == nil || ![self readHeader:error]) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (BOOL)readHeader:(NSError **)error
+{
+    const uint8_t *bytes = self.fileData.bytes;
+    uint64_t fileLength = [self.fileData length];
+    if (fileLength < MMColumnarFileHeaderLength || memcmp(bytes, MMColumnarFileMagic, sizeof(MMColumnarFileMagic)) != 0) {
+        if (error) {
+            *error = MMColumnarError(MMColumnarDataSourceErrorInvalidFile, @"The file is not a columnar spreadsheet file.");
+        }
+        return NO;
+    }
+
+    uint64_t rowCount = MMColumnarReadUInt64(bytes + 8);
+    uint32_t columnCount = MMColumnarReadUInt32(bytes + 16);
+    BOOL valid = (rowCount < NSUIntegerMax && rowCount <= fileLength / sizeof(uint64_t) &&
+                  MMColumnarRangeIsValid(MMColumnarFileHeaderLength, (uint64_t)columnCount * MMColumnarFileDescriptorLength, fileLength));
+
+    NSMutableData *columnData = [NSMutableData dataWithLength:columnCount * sizeof(MMColumnarColumn)];
+    MMColumnarColumn *columns = columnData.mutableBytes;
+    NSMutableArray *columnNames = [NSMutableArray arrayWithCapacity:columnCount];
+    for (uint32_t column = 0; column < columnCount && valid; column++) {
+        const uint8_t *descriptor = bytes + MMColumnarFileHeaderLength + column * MMColumnarFileDescriptorLength;
+        uint32_t nameLength = MMColumnarReadUInt32(descriptor + 4);
+        uint64_t nameOffset = MMColumnarReadUInt64(descriptor + 8);
+        columns[column].type = MMColumnarReadUInt32(descriptor);
+        columns[column].dataOffset = MMColumnarReadUInt64(descriptor + 16);
+        columns[column].stringDataOffset = MMColumnarReadUInt64(descriptor + 24);
+        columns[column].stringDataLength = MMColumnarReadUInt64(descriptor + 32);
+
+        valid = MMColumnarRangeIsValid(nameOffset, nameLength, fileLength);
+        switch (columns[column].type) {
+            case MMColumnarTypeInt64:
+            case MMColumnarTypeDouble:
+                valid = valid && MMColumnarRangeIsValid(columns[column].dataOffset, rowCount * sizeof(uint64_t), fileLength);
+                break;
+
+            case MMColumnarTypeString:
+                valid = (valid && MMColumnarRangeIsValid(columns[column].dataOffset, (rowCount + 1) * sizeof(uint64_t), fileLength) &&
+                         MMColumnarRangeIsValid(columns[column].stringDataOffset, columns[column].stringDataLength, fileLength));
+                break;
+
+            default:
+                valid = NO;
+                break;
+        }
+        if (valid) {
+            NSString *name = [[NSString alloc] initWithBytes:bytes + nameOffset length:nameLength encoding:NSUTF8StringEncoding];
+            [columnNames addObject:name ?: @""];
+        }
+    }
+
+    if (!valid) {
+        if (error) {
+            *error = MMColumnarError(MMColumnarDataSourceErrorInvalidFile, @"The columnar file header points outside the file.");
+        }
+        return NO;
+    }
+    self.fileRowCount = (NSUInteger)rowCount;
+    self.columnData = columnData;
+    self.columnNames = columnNames;
+    return YES;
+}
+
+- (MMColumnarType)typeOfColumn:(NSUInteger)column
+{
+    NSParameterAssert(column < [self.columnNames count]);
+    const MMColumnarColumn *columns = self.columnData.bytes;
+    return columns[column].type;
+}
+
+#pragma mark - Cell Text
+
+- (NSString *)textForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    NSInteger row = indexPath.mmSpreadsheetRow;
+    NSInteger column = indexPath.mmSpreadsheetColumn;
+    if (column < 0 || column >= (NSInteger)[self.columnNames count]) {
+        return nil;
+    }
+    if (self.showsColumnNames) {
+        if (row == 0) {
+            return self.columnNames[column];
+        }
+        row--;
+    }
+    if (row < 0 || row >= (NSInteger)self.fileRowCount) {
+        return nil;
+    }
+
+    const uint8_t *bytes = self.fileData.bytes;
+    const MMColumnarColumn *columnInfo = (const MMColumnarColumn *)self.columnData.bytes + column;
+    char buffer[32];
+    switch (columnInfo->type) {
+        case MMColumnarTypeInt64: {
+            int64_t value = (int64_t)MMColumnarReadUInt64(bytes + columnInfo->dataOffset + row * sizeof(uint64_t));
+            snprintf(buffer, sizeof(buffer), "%lld", (long long)value);
+            return [NSString stringWithUTF8String:buffer];
+        }
+
+        case MMColumnarTypeDouble: {
+            uint64_t bits = MMColumnarReadUInt64(bytes + columnInfo->dataOffset + row * sizeof(uint64_t));
+            double value;
+            memcpy(&value, &bits, sizeof(value));
+            if (isnan(value)) {
+                return nil;
+            }
+            snprintf(buffer, sizeof(buffer), "%.10g", value);
+            return [NSString stringWithUTF8String:buffer];
+        }
+
+        case MMColumnarTypeString: {
+            // Offsets are only checked when used, so opening a file never touches its offset tables.
+            const uint8_t *offsets = bytes + columnInfo->dataOffset + row * sizeof(uint64_t);
+            uint64_t start = MMColumnarReadUInt64(offsets);
+            uint64_t end = MMColumnarReadUInt64(offsets + sizeof(uint64_t));
+            if (start > end || end > columnInfo->stringDataLength || start == end) {
+                return nil;
+            }
+            return [[NSString alloc] initWithBytes:bytes + columnInfo->stringDataOffset + start
+                                            length:(NSUInteger)(end - start)
+                                          encoding:NSUTF8StringEncoding];
+        }
+
+        default:
+            NSAssert(NO, @"What have you done?");
+            return nil;
+    }
+}
+
+#pragma mark - MMSpreadsheetViewDataSource
+
+- (CGSize)spreadsheetView:(MMSpreadsheetView *)spreadsheetView sizeForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    return self.itemSize;
+}
+
+- (CGFloat)uniformRowHeightInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+{
+    return self.itemSize.height;
+}
+
+- (NSInteger)numberOfRowsInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+{
+    return self.fileRowCount + (self.showsColumnNames ? 1 : 0);
+}
+
+- (NSInteger)numberOfColumnsInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+{
+    return [self.columnNames count];
+}
+
+- (UICollectionViewCell *)spreadsheetView:(MMSpreadsheetView *)spreadsheetView cellForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    UICollectionViewCell *cell = [spreadsheetView dequeueReusableCellWithReuseIdentifier:self.cellReuseIdentifier forIndexPath:indexPath];
+    if (self.cellConfigurationBlock) {
+        self.cellConfigurationBlock(cell, [self textForItemAtIndexPath:indexPath], indexPath);
+    }
+    return cell;
+}
+
+#pragma mark - MMSpreadsheetViewValueDataSource
+
+- (MMSpreadsheetCellValue *)spreadsheetView:(MMSpreadsheetView *)spreadsheetView valueForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    NSString *text = [self textForItemAtIndexPath:indexPath];
+    if (text == nil) {
+        return nil;
+    }
+    MMSpreadsheetCellValue *value = [MMSpreadsheetCellValue valueWithText:text];
+    NSInteger column = indexPath.mmSpreadsheetColumn;
+    if (self.showsColumnNames && indexPath.mmSpreadsheetRow == 0) {
+        value.font = [UIFont boldSystemFontOfSize:12.0f];
+        value.backgroundColor = [UIColor colorWithWhite:0.9f alpha:1.0f];
+    }
+    else if ([self typeOfColumn:column] != MMColumnarTypeString) {
+        value.textAlignment = NSTextAlignmentRight;
+    }
+    return value;
+}
+
+#pragma mark - Writing
+
++ (BOOL)writeFileAtPath:(NSString *)path
+            columnNames:(NSArray *)columnNames
+            columnTypes:(NSArray *)columnTypes
+               rowCount:(NSUInteger)rowCount
+                 values:(id (^)(NSUInteger row, NSUInteger column))values
+                  error:(NSError **)error
+{
+    NSParameterAssert([columnNames count] == [columnTypes count]);
+    NSParameterAssert(values);
+
+    FILE *file = fopen([path fileSystemRepresentation], "wb");
+    if (file == NULL) {
+        if (error) {
+            *error = MMColumnarError(MMColumnarDataSourceErrorWriteFailed, @"The columnar file could not be created.");
+        }
+        return NO;
+    }
+
+    uint32_t columnCount = (uint32_t)[columnNames count];
+    uint64_t position = 0;
+
+    // Header, then zeroed descriptors that are filled in once every column's offsets are known.
+    uint8_t header[MMColumnarFileHeaderLength] = {0};
+    memcpy(header, MMColumnarFileMagic, sizeof(MMColumnarFileMagic));
+    uint64_t littleRowCount = OSSwapHostToLittleInt64((uint64_t)rowCount);
+    uint32_t littleColumnCount = OSSwapHostToLittleInt32(columnCount);
+    memcpy(header + 8, &littleRowCount, sizeof(littleRowCount));
+    memcpy(header + 16, &littleColumnCount, sizeof(littleColumnCount));
+    NSMutableData *descriptors = [NSMutableData dataWithLength:columnCount * MMColumnarFileDescriptorLength];
+    BOOL ok = fwrite(header, sizeof(header), 1, file) == 1;
+    ok = ok && (columnCount == 0 || fwrite(descriptors.bytes, [descriptors length], 1, file) == 1);
+    position += sizeof(header) + [descriptors length];
+
+    uint8_t *descriptorBytes = descriptors.mutableBytes;
+    for (uint32_t column = 0; column < columnCount && ok; column++) {
+        uint8_t *descriptor = descriptorBytes + column * MMColumnarFileDescriptorLength;
+        MMColumnarType type = [columnTypes[column] unsignedIntValue];
+        NSData *name = [columnNames[column] dataUsingEncoding:NSUTF8StringEncoding];
+        uint32_t littleType = OSSwapHostToLittleInt32(type);
+        uint32_t littleNameLength = OSSwapHostToLittleInt32((uint32_t)[name length]);
+        uint64_t littleNameOffset = OSSwapHostToLittleInt64(position);
+        memcpy(descriptor, &littleType, sizeof(littleType));
+        memcpy(descriptor + 4, &littleNameLength, sizeof(littleNameLength));
+        memcpy(descriptor + 8, &littleNameOffset, sizeof(littleNameOffset));
+        ok = [name length] == 0 || fwrite(name.bytes, [name length], 1, file) == 1;
+        position += [name length];
+
+        // String bytes go first so the offset table can follow them in one pass over the values.
+        uint64_t stringDataOffset = position;
+        NSMutableData *stringOffsets = nil;
+        if (type == MMColumnarTypeString) {
+            stringOffsets = [NSMutableData dataWithLength:(rowCount + 1) * sizeof(uint64_t)];
+            uint64_t *offsets = stringOffsets.mutableBytes;
+            for (NSUInteger chunkStart = 0; chunkStart < rowCount && ok; chunkStart += MMColumnarWriterRowsPerPool) {
+                @autoreleasepool {
+                    NSUInteger chunkEnd = MIN(chunkStart + MMColumnarWriterRowsPerPool, rowCount);
+                    for (NSUInteger row = chunkStart; row < chunkEnd && ok; row++) {
+                        NSData *text = [[values(row, column) description] dataUsingEncoding:NSUTF8StringEncoding];
+                        offsets[row] = OSSwapHostToLittleInt64(position - stringDataOffset);
+                        ok = [text length] == 0 || fwrite(text.bytes, [text length], 1, file) == 1;
+                        position += [text length];
+                    }
+                }
+            }
+            offsets[rowCount] = OSSwapHostToLittleInt64(position - stringDataOffset);
+        }
+        uint64_t littleStringDataOffset = OSSwapHostToLittleInt64(stringDataOffset);
+        uint64_t littleStringDataLength = OSSwapHostToLittleInt64(position - stringDataOffset);
+        memcpy(descriptor + 24, &littleStringDataOffset, sizeof(littleStringDataOffset));
+        memcpy(descriptor + 32, &littleStringDataLength, sizeof(littleStringDataLength));
+
+        // Keep fixed-width data 8 byte aligned.
+        static const uint8_t padding[8] = {0};
+        uint64_t paddingLength = (8 - position % 8) % 8;
+        ok = ok && (paddingLength == 0 || fwrite(padding, paddingLength, 1, file) == 1);
+        position += paddingLength;
+        uint64_t littleDataOffset = OSSwapHostToLittleInt64(position);
+        memcpy(descriptor + 16, &littleDataOffset, sizeof(littleDataOffset));
+
+        if (stringOffsets) {
+            ok = ok && fwrite(stringOffsets.bytes, [stringOffsets length], 1, file) == 1;
+            position += [stringOffsets length];
+            continue;
+        }
+        for (NSUInteger chunkStart = 0; chunkStart < rowCount && ok; chunkStart += MMColumnarWriterRowsPerPool) {
+            @autoreleasepool {
+                NSUInteger chunkEnd = MIN(chunkStart + MMColumnarWriterRowsPerPool, rowCount);
+                for (NSUInteger row = chunkStart; row < chunkEnd && ok; row++) {
+                    NSNumber *number = values(row, column);
+                    uint64_t bits;
+                    if (type == MMColumnarTypeDouble) {
+                        double value = [number doubleValue];
+                        memcpy(&bits, &value, sizeof(bits));
+                    }
+                    else {
+                        bits = (uint64_t)[number longLongValue];
+                    }
+                    bits = OSSwapHostToLittleInt64(bits);
+                    ok = fwrite(&bits, sizeof(bits), 1, file) == 1;
+                }
+            }
+        }
+        position += rowCount * sizeof(uint64_t);
+    }
+
+    ok = ok && fseeko(file, (off_t)MMColumnarFileHeaderLength, SEEK_SET) == 0;
+    ok = ok && (columnCount == 0 || fwrite(descriptors.bytes, [descriptors length], 1, file) == 1);
+    ok = (fclose(file) == 0) && ok;
+    if (!ok) {
+        [[NSFileManager defaultManager] removeItemAtPath:path error:NULL];
+        if (error) {
+            *error = MMColumnarError(MMColumnarDataSourceErrorWriteFailed, @"The columnar file could not be written.");
+        }
+    }
+    return ok;
+}
+
+@end
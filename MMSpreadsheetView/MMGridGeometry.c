@@ -0,0 +1,467 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#include "MMGridGeometry.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// MARK: - Axis
+
+void MMGridAxisInit(MMGridAxis *axis)
+{
+    axis->offsets = NULL;
+    axis->count = 0;
+    axis->capacity = 0;
+    axis->uniformSize = 0.0;
+}
+
+void MMGridAxisFree(MMGridAxis *axis)
+{
+    free(axis->offsets);
+    MMGridAxisInit(axis);
+}
+
+double *MMGridAxisPrepare(MMGridAxis *axis, long count)
+{
+    if (count < 0) {
+        count = 0;
+    }
+    if (axis->offsets == NULL || axis->capacity < count + 1) {
+        double *offsets = realloc(axis->offsets, (size_t)(count + 1) * sizeof(double));
+        if (offsets == NULL) {
+            MMGridAxisFree(axis);
+            return NULL;
+        }
+        axis->offsets = offsets;
+        axis->capacity = count + 1;
+    }
+    axis->count = count;
+    axis->uniformSize = 0.0;
+    axis->offsets[0] = 0.0;
+    return axis->offsets;
+}
+
+int MMGridAxisFillUniform(MMGridAxis *axis, long count, double size)
+{
+    MMGridAxisFree(axis);
+    if (!(size > 0.0)) {
+        return 0;
+    }
+    axis->count = count < 0 ? 0 : count;
+    axis->uniformSize = size;
+    return 1;
+}
+
+int MMGridAxisCopy(MMGridAxis *destination, const MMGridAxis *source)
+{
+    if (source->offsets == NULL) {
+        MMGridAxisFree(destination);
+        destination->count = source->count;
+        destination->uniformSize = source->uniformSize;
+        return 1;
+    }
+    double *offsets = MMGridAxisPrepare(destination, source->count);
+    if (offsets == NULL) {
+        return 0;
+    }
+    memcpy(offsets, source->offsets, (size_t)(source->count + 1) * sizeof(double));
+    return 1;
+}
+
+double MMGridAxisLength(const MMGridAxis *axis)
+{
+    return axis->offsets ? axis->offsets[axis->count] : (double)axis->count * axis->uniformSize;
+}
+
+double MMGridAxisOffset(const MMGridAxis *axis, long index)
+{
+    return axis->offsets ? axis->offsets[index] : (double)index * axis->uniformSize;
+}
+
+double MMGridAxisSize(const MMGridAxis *axis, long index)
+{
+    return axis->offsets ? axis->offsets[index + 1] - axis->offsets[index] : axis->uniformSize;
+}
+
+long MMGridAxisIndexForOffset(const MMGridAxis *axis, double offset)
+{
+    if (axis->count == 0) {
+        return -1;
+    }
+    if (axis->offsets == NULL) {
+        double index = floor(offset / axis->uniformSize);
+        return index < 0.0 ? 0 : (index >= (double)axis->count ? axis->count - 1 : (long)index);
+    }
+    // The last offset that is <= the target.
+    const double *offsets = axis->offsets;
+    long low = 0;
+    long high = axis->count - 1;
+    while (low < high) {
+        long mid = low + (high - low + 1) / 2;
+        if (offsets[mid] <= offset) {
+            low = mid;
+        }
+        else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+MMGridRange MMGridAxisRangeForSpan(const MMGridAxis *axis, double minOffset, double maxOffset)
+{
+    MMGridRange range = { 0, 0 };
+    if (axis->count == 0) {
+        return range;
+    }
+    long start = MMGridAxisIndexForOffset(axis, minOffset);
+    long end = MMGridAxisIndexForOffset(axis, maxOffset);
+    range.location = start;
+    range.length = end - start + 1;
+    return range;
+}
+
+// MARK: - Pane split
+
+MMGridSplit MMGridSplitMake(long headerRowCount, long headerColumnCount, int singlePane)
+{
+    MMGridSplit split = { headerRowCount, headerColumnCount, singlePane };
+    return split;
+}
+
+MMGridPane MMGridSplitPaneForCell(MMGridSplit split, long row, long column)
+{
+    if (split.singlePane) {
+        return MMGridPaneSingle;
+    }
+    if (row >= split.headerRowCount) {
+        return column >= split.headerColumnCount ? MMGridPaneLowerRight : MMGridPaneLowerLeft;
+    }
+    return column >= split.headerColumnCount ? MMGridPaneUpperRight : MMGridPaneUpperLeft;
+}
+
+long MMGridSplitRowOffset(MMGridSplit split, MMGridPane pane)
+{
+    if (pane == MMGridPaneLowerLeft || pane == MMGridPaneLowerRight) {
+        return split.headerRowCount;
+    }
+    return 0;
+}
+
+long MMGridSplitColumnOffset(MMGridSplit split, MMGridPane pane)
+{
+    if (pane == MMGridPaneUpperRight || pane == MMGridPaneLowerRight) {
+        return split.headerColumnCount;
+    }
+    return 0;
+}
+
+long MMGridSplitPaneRowCount(MMGridSplit split, MMGridPane pane, long rowCount)
+{
+    switch (pane) {
+        case MMGridPaneUpperLeft:
+        case MMGridPaneUpperRight:
+            return split.headerRowCount;
+
+        case MMGridPaneLowerLeft:
+        case MMGridPaneLowerRight:
+            return rowCount - split.headerRowCount;
+
+        case MMGridPaneSingle:
+            return rowCount;
+
+        default:
+            return 0;
+    }
+}
+
+long MMGridSplitPaneColumnCount(MMGridSplit split, MMGridPane pane, long columnCount)
+{
+    switch (pane) {
+        case MMGridPaneUpperLeft:
+        case MMGridPaneLowerLeft:
+            return split.headerColumnCount;
+
+        case MMGridPaneUpperRight:
+        case MMGridPaneLowerRight:
+            return columnCount - split.headerColumnCount;
+
+        case MMGridPaneSingle:
+            return columnCount;
+
+        default:
+            return 0;
+    }
+}
+
+MMGridCellIndex MMGridSplitCellFromPaneIndex(MMGridSplit split, MMGridPane pane, MMGridCellIndex paneIndex)
+{
+    MMGridCellIndex cell = { paneIndex.row + MMGridSplitRowOffset(split, pane),
+                             paneIndex.column + MMGridSplitColumnOffset(split, pane) };
+    return cell;
+}
+
+MMGridCellIndex MMGridSplitPaneIndexFromCell(MMGridSplit split, MMGridPane pane, MMGridCellIndex cell)
+{
+    MMGridCellIndex paneIndex = { cell.row - MMGridSplitRowOffset(split, pane),
+                                  cell.column - MMGridSplitColumnOffset(split, pane) };
+    return paneIndex;
+}
+
+// MARK: - Scroll indicators
+
+MMGridScrollIndicator MMGridScrollIndicatorMake(double contentLength, double viewportLength, double contentOffset, double trackLength, double minimumLength)
+{
+    MMGridScrollIndicator indicator = { 0.0, 0.0 };
+    if (viewportLength > contentLength) {
+        return indicator;
+    }
+    indicator.length = viewportLength / contentLength * trackLength;
+    if (indicator.length < minimumLength) {
+        indicator.length = minimumLength;
+    }
+    double divideByZeroOffset = contentLength == viewportLength ? 1.0 : 0.0;
+    indicator.offset = contentOffset / (contentLength - viewportLength + divideByZeroOffset) * (trackLength - indicator.length);
+    return indicator;
+}
+
+// MARK: - Virtual window
+
+const double MMGridVirtualWindowLength = 1048576.0;
+
+static const double MMGridVirtualWindowGranularity = 1024.0;
+
+double MMGridVirtualWindowOrigin(double axisLength, double windowLength, double viewportLength, double offset, double currentOrigin)
+{
+    if (axisLength <= windowLength) {
+        return 0.0;
+    }
+    double maximumOrigin = axisLength - windowLength;
+    double margin = windowLength / 4.0;
+    double localOffset = offset - currentOrigin;
+    if (currentOrigin >= 0.0 && currentOrigin <= maximumOrigin &&
+        localOffset >= margin && localOffset + viewportLength <= windowLength - margin) {
+        return currentOrigin;
+    }
+
+    double origin = floor((offset + (viewportLength - windowLength) / 2.0) / MMGridVirtualWindowGranularity) * MMGridVirtualWindowGranularity;
+    if (origin > maximumOrigin) {
+        origin = maximumOrigin;
+    }
+    if (origin < 0.0) {
+        origin = 0.0;
+    }
+    return origin;
+}
+
+// MARK: - Merged cells
+
+// Below this level a subtree has at most 16 spans, which are cheaper to scan than to descend.
+static const int MMGridSpanIndexScanLevel = 3;
+
+static long MMGridSpanRowEnd(const MMGridSpan *span)
+{
+    return span->row + span->rowCount;
+}
+
+static int MMGridSpanCompareRows(const void *first, const void *second)
+{
+    const MMGridSpan *left = first;
+    const MMGridSpan *right = second;
+    if (left->row != right->row) {
+        return left->row < right->row ? -1 : 1;
+    }
+    if (left->column != right->column) {
+        return left->column < right->column ? -1 : 1;
+    }
+    return 0;
+}
+
+// Node i of the implicit tree is at the level of its lowest clear bit, with children i - 2^(level - 1) and
+// i + 2^(level - 1). Nodes past the end of the array stand for subtrees that end with the last span.
+static int MMGridSpanIndexBuildTree(const MMGridSpan *spans, long *maxRowEnds, long count)
+{
+    if (count == 0) {
+        return -1;
+    }
+    long lastNode = 0;
+    long lastEnd = 0;
+    for (long i = 0; i < count; i += 2) {
+        lastNode = i;
+        lastEnd = maxRowEnds[i] = MMGridSpanRowEnd(&spans[i]);
+    }
+    int level = 1;
+    for (; (1L << level) <= count; level++) {
+        long half = 1L << (level - 1);
+        for (long i = (half << 1) - 1; i < count; i += half << 2) {
+            long leftEnd = maxRowEnds[i - half];
+            long rightEnd = i + half < count ? maxRowEnds[i + half] : lastEnd;
+            long end = MMGridSpanRowEnd(&spans[i]);
+            end = leftEnd > end ? leftEnd : end;
+            end = rightEnd > end ? rightEnd : end;
+            maxRowEnds[i] = end;
+        }
+        // Follow the rightmost node up to its parent, which may now end further down.
+        lastNode = (lastNode >> level & 1) ? lastNode - half : lastNode + half;
+        if (lastNode < count && maxRowEnds[lastNode] > lastEnd) {
+            lastEnd = maxRowEnds[lastNode];
+        }
+    }
+    return level - 1;
+}
+
+void MMGridSpanIndexInit(MMGridSpanIndex *index)
+{
+    index->spans = NULL;
+    index->maxRowEnds = NULL;
+    index->count = 0;
+    index->maxLevel = -1;
+}
+
+void MMGridSpanIndexFree(MMGridSpanIndex *index)
+{
+    free(index->spans);
+    free(index->maxRowEnds);
+    MMGridSpanIndexInit(index);
+}
+
+int MMGridSpanIndexBuild(MMGridSpanIndex *index, const MMGridSpan *spans, long count)
+{
+    MMGridSpanIndexFree(index);
+    if (count <= 0) {
+        return 1;
+    }
+    MMGridSpan *sortedSpans = malloc((size_t)count * sizeof(MMGridSpan));
+    long *maxRowEnds = malloc((size_t)count * sizeof(long));
+    if (sortedSpans == NULL || maxRowEnds == NULL) {
+        free(sortedSpans);
+        free(maxRowEnds);
+        return 0;
+    }
+
+    long keptCount = 0;
+    for (long i = 0; i < count; i++) {
+        if (spans[i].rowCount > 0 && spans[i].columnCount > 0) {
+            sortedSpans[keptCount++] = spans[i];
+        }
+    }
+    qsort(sortedSpans, (size_t)keptCount, sizeof(MMGridSpan), MMGridSpanCompareRows);
+
+    index->spans = sortedSpans;
+    index->maxRowEnds = maxRowEnds;
+    index->count = keptCount;
+    index->maxLevel = MMGridSpanIndexBuildTree(sortedSpans, maxRowEnds, keptCount);
+    return 1;
+}
+
+long MMGridSpanIndexQuery(const MMGridSpanIndex *index, MMGridRange rows, MMGridRange columns, MMGridSpanVisitor visitor, void *context)
+{
+    if (index->count == 0 || rows.length <= 0 || columns.length <= 0) {
+        return 0;
+    }
+    const MMGridSpan *spans = index->spans;
+    long count = index->count;
+    long firstRow = rows.location;
+    long endRow = rows.location + rows.length;
+    long firstColumn = columns.location;
+    long endColumn = columns.location + columns.length;
+    long visitedCount = 0;
+
+    // A top-down walk that visits spans in array order, so by first row. A node goes back on the stack
+    // once its left subtree is pushed, and is checked itself before its right subtree.
+    struct {
+        long node;
+        int level;
+        int leftSubtreeDone;
+    } stack[64];
+    int depth = 0;
+    stack[depth].node = (1L << index->maxLevel) - 1;
+    stack[depth].level = index->maxLevel;
+    stack[depth++].leftSubtreeDone = 0;
+
+    while (depth > 0) {
+        long node = stack[--depth].node;
+        int level = stack[depth].level;
+        int leftSubtreeDone = stack[depth].leftSubtreeDone;
+        long candidate = -1;
+
+        if (level <= MMGridSpanIndexScanLevel) {
+            long first = node >> level << level;
+            long last = first + (1L << (level + 1)) - 1;
+            last = last < count ? last : count;
+            for (long i = first; i < last && spans[i].row < endRow; i++) {
+                if (firstRow < MMGridSpanRowEnd(&spans[i]) &&
+                    spans[i].column < endColumn && firstColumn < spans[i].column + spans[i].columnCount) {
+                    visitedCount++;
+                    if (visitor && visitor(&spans[i], context)) {
+                        return visitedCount;
+                    }
+                }
+            }
+            continue;
+        }
+        if (!leftSubtreeDone) {
+            long left = node - (1L << (level - 1));
+            stack[depth].node = node;
+            stack[depth].level = level;
+            stack[depth++].leftSubtreeDone = 1;
+            if (left >= count || index->maxRowEnds[left] > firstRow) {
+                stack[depth].node = left;
+                stack[depth].level = level - 1;
+                stack[depth++].leftSubtreeDone = 0;
+            }
+            continue;
+        }
+        if (node < count && spans[node].row < endRow) {
+            if (firstRow < MMGridSpanRowEnd(&spans[node])) {
+                candidate = node;
+            }
+            stack[depth].node = node + (1L << (level - 1));
+            stack[depth].level = level - 1;
+            stack[depth++].leftSubtreeDone = 0;
+        }
+        if (candidate >= 0 && spans[candidate].column < endColumn && firstColumn < spans[candidate].column + spans[candidate].columnCount) {
+            visitedCount++;
+            if (visitor && visitor(&spans[candidate], context)) {
+                return visitedCount;
+            }
+        }
+    }
+    return visitedCount;
+}
+
+int MMGridSpanClip(MMGridSpan span, MMGridRange rows, MMGridRange columns, MMGridSpan *clipped)
+{
+    long firstRow = span.row > rows.location ? span.row : rows.location;
+    long endRow = MMGridSpanRowEnd(&span) < rows.location + rows.length ? MMGridSpanRowEnd(&span) : rows.location + rows.length;
+    long firstColumn = span.column > columns.location ? span.column : columns.location;
+    long spanEndColumn = span.column + span.columnCount;
+    long endColumn = spanEndColumn < columns.location + columns.length ? spanEndColumn : columns.location + columns.length;
+    if (firstRow >= endRow || firstColumn >= endColumn) {
+        return 0;
+    }
+    clipped->row = firstRow;
+    clipped->column = firstColumn;
+    clipped->rowCount = endRow - firstRow;
+    clipped->columnCount = endColumn - firstColumn;
+    return 1;
+}
@@ -0,0 +1,225 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#ifndef MMGridGeometry_h
+#define MMGridGeometry_h
+
+#include <stddef.h>
+
+/*
+ Grid geometry for `MMSpreadsheetView` and `MMGridLayout` with no UIKit dependency.
+ 
+ Everything here is plain C so the math for pane splits, index mapping, offset lookups, visible ranges and scroll indicator sizing can be built and benchmarked off-device (see Benchmarks/).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ The panes of a spreadsheet. The values match the collection view tags used by `MMSpreadsheetView`.
+ */
+typedef enum {
+    MMGridPaneNone = 0,
+    MMGridPaneUpperLeft = 1,
+    MMGridPaneUpperRight,
+    MMGridPaneLowerLeft,
+    MMGridPaneLowerRight,
+    MMGridPaneSingle,
+} MMGridPane;
+
+/*
+ A row and column pair, either in data source coordinates or in a pane's coordinates.
+ */
+typedef struct {
+    long row;
+    long column;
+} MMGridCellIndex;
+
+/*
+ A half-open range of rows or columns.
+ */
+typedef struct {
+    long location;
+    long length;
+} MMGridRange;
+
+// MARK: - Axis
+
+/*
+ One axis (rows or columns) of a grid, stored as count + 1 ascending prefix sums so that offsets[i] is the leading edge of index i and offsets[count] is the total length.
+ A uniform axis has no table: offsets is NULL and every entry is uniformSize long, so its offsets are computed.
+ */
+typedef struct {
+    double *offsets;
+    long count;
+    long capacity;
+    double uniformSize;
+} MMGridAxis;
+
+void MMGridAxisInit(MMGridAxis *axis);
+void MMGridAxisFree(MMGridAxis *axis);
+
+/*
+ Sizes the axis for count entries and returns its offsets for the caller to fill. offsets[0] is set to 0; the caller sets offsets[i + 1] = offsets[i] + size of i. Returns NULL if the allocation fails, in which case the axis is left empty.
+ */
+double *MMGridAxisPrepare(MMGridAxis *axis, long count);
+
+/*
+ Makes an axis where every entry has the same size. The offset table is freed, so the axis takes no memory however long it is. Returns 0 if size is not positive, in which case the axis is left empty.
+ */
+int MMGridAxisFillUniform(MMGridAxis *axis, long count, double size);
+
+/*
+ Copies source into destination, which must have been initialized. Returns 0 if the allocation fails.
+ */
+int MMGridAxisCopy(MMGridAxis *destination, const MMGridAxis *source);
+
+double MMGridAxisLength(const MMGridAxis *axis);
+double MMGridAxisOffset(const MMGridAxis *axis, long index);
+double MMGridAxisSize(const MMGridAxis *axis, long index);
+
+/*
+ The index containing the offset, found by binary search. Offsets before the start clamp to 0 and offsets past the end clamp to count - 1. Returns -1 for an empty axis.
+ */
+long MMGridAxisIndexForOffset(const MMGridAxis *axis, double offset);
+
+/*
+ The indexes that intersect [minOffset, maxOffset]. The length is 0 for an empty axis.
+ */
+MMGridRange MMGridAxisRangeForSpan(const MMGridAxis *axis, double minOffset, double maxOffset);
+
+// MARK: - Pane split
+
+/*
+ How a spreadsheet is split into panes. With singlePane set every cell lives in MMGridPaneSingle.
+ */
+typedef struct {
+    long headerRowCount;
+    long headerColumnCount;
+    int singlePane;
+} MMGridSplit;
+
+MMGridSplit MMGridSplitMake(long headerRowCount, long headerColumnCount, int singlePane);
+
+/*
+ The pane that displays a data source cell.
+ */
+MMGridPane MMGridSplitPaneForCell(MMGridSplit split, long row, long column);
+
+/*
+ The data source row and column of a pane's first cell.
+ */
+long MMGridSplitRowOffset(MMGridSplit split, MMGridPane pane);
+long MMGridSplitColumnOffset(MMGridSplit split, MMGridPane pane);
+
+/*
+ The number of rows and columns a pane shows out of the whole sheet.
+ */
+long MMGridSplitPaneRowCount(MMGridSplit split, MMGridPane pane, long rowCount);
+long MMGridSplitPaneColumnCount(MMGridSplit split, MMGridPane pane, long columnCount);
+
+/*
+ Converts between data source cells and pane cells.
+ */
+MMGridCellIndex MMGridSplitCellFromPaneIndex(MMGridSplit split, MMGridPane pane, MMGridCellIndex paneIndex);
+MMGridCellIndex MMGridSplitPaneIndexFromCell(MMGridSplit split, MMGridPane pane, MMGridCellIndex cell);
+
+// MARK: - Scroll indicators
+
+/*
+ The position and length of a scroll indicator segment along its track.
+ */
+typedef struct {
+    double offset;
+    double length;
+} MMGridScrollIndicator;
+
+/*
+ Sizes a scroll indicator for a viewport over some content. The length is proportional to the visible fraction but never shorter than minimumLength, and is 0 when all of the content fits in the viewport.
+ */
+MMGridScrollIndicator MMGridScrollIndicatorMake(double contentLength, double viewportLength, double contentOffset, double trackLength, double minimumLength);
+
+// MARK: - Virtual window
+
+/*
+ The length of the window a scroll view works in when a long axis is laid out in virtual coordinates. Float coordinates still resolve well under a pixel at this size, and scroll views handle it without trouble.
+ */
+extern const double MMGridVirtualWindowLength;
+
+/*
+ Where a virtual window should start on an axis so a viewport at offset (in logical, whole-axis coordinates) stays well inside it.
+ 
+ Returns currentOrigin while the viewport is in the middle half of the window. Otherwise the window is recentered on the viewport, with its origin rounded down to a multiple of 1024 points so cell edges keep their pixel alignment. The origin is clamped so the window stays within the axis, and is always 0 when the whole axis fits in the window.
+ */
+double MMGridVirtualWindowOrigin(double axisLength, double windowLength, double viewportLength, double offset, double currentOrigin);
+
+// MARK: - Merged cells
+
+/*
+ A block of cells shown as one: rowCount rows starting at row, and columnCount columns starting at column.
+ */
+typedef struct {
+    long row;
+    long column;
+    long rowCount;
+    long columnCount;
+} MMGridSpan;
+
+/*
+ A static index of spans, for finding the ones that intersect a block of cells.
+ 
+ Spans are sorted by first row and laid out as an implicit interval tree over rows: the sorted array is read as a balanced binary tree, and each node also records the largest row end in its subtree so subtrees that end before the query are skipped. A query costs O(log n + k) for the k spans that intersect the rows, which are then filtered by column. Building sorts a copy of the spans, in O(n log n).
+ */
+typedef struct {
+    MMGridSpan *spans;
+    long *maxRowEnds;
+    long count;
+    int maxLevel;
+} MMGridSpanIndex;
+
+void MMGridSpanIndexInit(MMGridSpanIndex *index);
+void MMGridSpanIndexFree(MMGridSpanIndex *index);
+
+/*
+ Replaces the spans in the index with a copy of spans. Spans with no rows or no columns are dropped. Returns 0 if the allocation fails, in which case the index is left empty.
+ */
+int MMGridSpanIndexBuild(MMGridSpanIndex *index, const MMGridSpan *spans, long count);
+
+/*
+ Called with each span a query finds. Return non-zero to end the query.
+ */
+typedef int (*MMGridSpanVisitor)(const MMGridSpan *span, void *context);
+
+/*
+ Visits every span that intersects a block of cells, in order of first row. The visitor may be NULL to only count them. Returns the number of spans visited.
+ */
+long MMGridSpanIndexQuery(const MMGridSpanIndex *index, MMGridRange rows, MMGridRange columns, MMGridSpanVisitor visitor, void *context);
+
+/*
+ Clips a span to a block of cells. Returns 0, leaving clipped unchanged, if they do not intersect.
+ */
+int MMGridSpanClip(MMGridSpan span, MMGridRange rows, MMGridRange columns, MMGridSpan *clipped);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
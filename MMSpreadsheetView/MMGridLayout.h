@@ -19,6 +19,43 @@
 // THE SOFTWARE.
 
 #import <UIKit/UIKit.h>
+#import "MMGridGeometry.h"
+
+@class MMGridLayout;
+@class MMSpreadsheetViewMetrics;
+
+/**
+ The `MMGridLayoutDelegate` protocol lets the collection view delegate hand row heights and column widths to the layout directly. Rows and columns only have sizes of their own when both heightForRow: and widthForColumn: are implemented. Otherwise every cell takes the size collectionView:layout:sizeForItemAtIndexPath: gives for item 0 of section 0, or itemSize, so rebuilding the offsets never asks the delegate about every row and column.
+ */
+@protocol MMGridLayoutDelegate <UICollectionViewDelegateFlowLayout>
+
+@optional
+
+/**
+ The height of a row (section) in the collection view, not including cell spacing.
+ */
+- (CGFloat)collectionView:(UICollectionView *)collectionView layout:(MMGridLayout *)layout heightForRow:(NSInteger)row;
+
+/**
+ The width of a column (item) in the collection view, not including cell spacing.
+ */
+- (CGFloat)collectionView:(UICollectionView *)collectionView layout:(MMGridLayout *)layout widthForColumn:(NSInteger)column;
+
+/**
+ The height shared by every row (section) in the collection view, not including cell spacing, or 0 if rows have their own heights.
+ 
+ When it is positive, heightForRow: and sizeForItemAtIndexPath: are not asked about rows, and the layout keeps no row offset table, so its memory does not grow with the row count.
+ */
+- (CGFloat)collectionView:(UICollectionView *)collectionView uniformRowHeightForLayout:(MMGridLayout *)layout;
+
+/**
+ Calls a block with each merged cell that intersects a block of rows (sections) and columns (items) of the collection view.
+ 
+ Merged cells must not overlap, and must be clipped to the collection view's rows and columns. The layout gives each one a single cell at the index path of its top-left cell, sized to cover the block, and leaves out the cells it covers. Where a merged cell crosses the edge of the frozen rows or columns, each side gets its own cell so the frozen part stays pinned.
+ */
+- (void)collectionView:(UICollectionView *)collectionView layout:(MMGridLayout *)layout enumerateMergedCellsInRows:(NSRange)rows columns:(NSRange)columns usingBlock:(void (^)(MMGridSpan span))block;
+
+@end
 
 /**
  `MMGridLayout` provides the grid layout of cells for the spreadsheet.
@@ -33,9 +70,11 @@
 ///---------------------------------------
 
 /**
- The size for each cell in the grid.
+ The default size for each cell in the grid.
+ 
+ @discussion This will be set by `MMSpreadsheetView` via the `setItemSize:` method. When the collection view delegate implements collectionView:layout:heightForRow: and collectionView:layout:widthForColumn: (see `MMGridLayoutDelegate`), the layout packs the sizes they give into cumulative offset tables, so rows and columns may vary in size. Otherwise every cell has the size collectionView:layout:sizeForItemAtIndexPath: gives for the first item, and the itemSize is only used when the delegate does not provide sizes at all. The layout is invalidated when the itemSize is changed.
  
- @discussion This will be set either by `MMSpreadsheetView` or `MMGridLayout` using a delegate call to collectionView:layout:sizeForItemAtIndexPath: via the `setItemSize:` method. The layout is invalidated when the itemSize is changed.
+ Sizes are fetched once each time the layout is invalidated (for example, on reloadData). Visible rows and columns are located with a binary search over the offset tables, so the cost of a layout pass does not grow with the number of rows or columns.
  */
 @property (nonatomic, assign) CGSize itemSize;
 
@@ -46,4 +85,119 @@
  */
 @property (nonatomic, assign) CGFloat cellSpacing;
 
+/**
+ The number of leading rows that stay pinned to the top of the collection view while it scrolls.
+ 
+ @discussion Frozen rows are laid out on top of the scrolling cells, the same way a header row pane would be. When this or frozenColumnCount is non-zero the layout is invalidated on every bounds change so the pinned cells can follow the content offset; the row and column offsets and cached attributes are kept across those invalidations. Default is 0.
+ */
+@property (nonatomic, assign) NSUInteger frozenRowCount;
+
+/**
+ The number of leading columns that stay pinned to the left edge of the collection view while it scrolls.
+ 
+ @discussion See frozenRowCount. Cells that are in both a frozen row and a frozen column are placed above both. Default is 0.
+ */
+@property (nonatomic, assign) NSUInteger frozenColumnCount;
+
+/**
+ A Boolean value that determines whether the layout leaves out attributes for cells that are not frozen.
+ 
+ @discussion The content size and the row and column offsets are unaffected, so the collection view scrolls over the full grid without creating a cell for every item. `MMSpreadsheetView` sets this when the content is drawn as tiles instead of cells. Frozen cells are still laid out and pinned. The layout is invalidated when this is changed. Default is NO.
+ */
+@property (nonatomic, assign) BOOL omitsCells;
+
+/**
+ A Boolean value that determines whether a very long row or column axis is laid out in a bounded window instead of at its full length.
+ 
+ @discussion Content sizes past a few million points lose precision as floats, and scroll views stop behaving well long before that. When an axis is longer than `MMGridVirtualWindowLength`, collectionViewContentSize is clamped to the window and frames are placed relative to rowOrigin or columnOrigin. Offsets are kept as doubles, so rows stay exact however long the grid is. The owner of the collection view moves the window with setRowOrigin:columnOrigin: as the scroll position nears its edges. Axes that fit in the window are unaffected. The layout is invalidated when this is changed. Default is NO.
+ */
+@property (nonatomic, assign) BOOL usesVirtualCoordinates;
+
+/**
+ The logical offset along the whole row axis of the top of the collection view's content. Always 0 unless usesVirtualCoordinates is set and the rows are longer than the window.
+ */
+@property (nonatomic, readonly) double rowOrigin;
+
+/**
+ The logical offset along the whole column axis of the left edge of the collection view's content. See rowOrigin.
+ */
+@property (nonatomic, readonly) double columnOrigin;
+
+/**
+ The full height of the grid, which is larger than collectionViewContentSize when the rows are laid out in a virtual window.
+ */
+@property (nonatomic, readonly) double virtualContentHeight;
+
+/**
+ The full width of the grid, which is larger than collectionViewContentSize when the columns are laid out in a virtual window.
+ */
+@property (nonatomic, readonly) double virtualContentWidth;
+
+/**
+ Moves the virtual window.
+ 
+ @param rowOrigin The logical row offset to show at the top of the content.
+ @param columnOrigin The logical column offset to show at the left of the content.
+ 
+ @discussion Origins are clamped so the window stays within the grid. Every frame moves by the change in origin, so the caller must move the collection view's content offset by the same amount to keep the same cells on screen. The row and column offsets are not rebuilt.
+ */
+- (void)setRowOrigin:(double)rowOrigin columnOrigin:(double)columnOrigin;
+
+/**
+ Invalidates the layout for a change to the columns only.
+ 
+ @discussion The column offsets and cached attributes are rebuilt by the next layout pass, but the row offsets are kept as long as the number of rows has not changed, so a column inserted into a long sheet does not ask for every row height again. Call it inside the batch update that tells the collection view about the change, so the layout pass at the end of the batch already keeps the rows.
+ */
+- (void)invalidateColumns;
+
+/**
+ The metrics object that layout passes are timed into, or nil to skip timing.
+ 
+ @discussion Each call to layoutAttributesForElementsInRect: is recorded against the collection view's tag. The layout maintains a weak reference to the metrics object.
+ */
+@property (nonatomic, weak) MMSpreadsheetViewMetrics *metrics;
+
+///---------------------------------------
+/// @name Locating Rows and Columns
+///---------------------------------------
+
+/**
+ The rows (sections) that intersect a rect in the collection view's content.
+ 
+ @param rect A rect in content coordinates, which are offset by rowOrigin in a virtual window.
+ 
+ @return The range of rows, found with a binary search over the row offsets. The length is 0 if the grid is empty.
+ */
+- (NSRange)rowRangeForRect:(CGRect)rect;
+
+/**
+ The columns (items) that intersect a rect in the collection view's content.
+ 
+ @param rect A rect in content coordinates, which are offset by columnOrigin in a virtual window.
+ 
+ @return The range of columns, found with a binary search over the column offsets. The length is 0 if the grid is empty.
+ */
+- (NSRange)columnRangeForRect:(CGRect)rect;
+
+/**
+ The logical offset of a row's top edge, including the spacing of the rows above it. Pass the row count to get the full height.
+ */
+- (double)offsetForRow:(NSInteger)row;
+
+/**
+ The logical offset of a column's left edge. See offsetForRow:.
+ */
+- (double)offsetForColumn:(NSInteger)column;
+
+/**
+ Copies the row and column offsets, including cell spacing, into axes owned by the caller.
+ 
+ @param rowAxis An initialized axis that receives the row offsets.
+ @param columnAxis An initialized axis that receives the column offsets.
+ 
+ @return NO if either axis could not be allocated.
+ @discussion The copies are plain C data, so they can be read on a background thread while the layout keeps changing on the main thread. Free them with MMGridAxisFree. Offsets are logical: subtract rowOrigin and columnOrigin to get content coordinates.
+ */
+- (BOOL)copyRowAxis:(MMGridAxis *)rowAxis columnAxis:(MMGridAxis *)columnAxis;
+
 @end
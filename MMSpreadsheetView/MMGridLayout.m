@@ -19,17 +19,37 @@
 // THE SOFTWARE.
 
 #import "MMGridLayout.h"
+#import <QuartzCore/QuartzCore.h>
 #import "MMSpreadsheetView.h"
+#import "MMSpreadsheetViewMetrics.h"
+#import "MMGridGeometry.h"
 
 @interface MMGridLayout ()
 
 @property (nonatomic, assign) NSInteger gridRowCount;
 @property (nonatomic, assign) NSInteger gridColumnCount;
 @property (nonatomic, assign) BOOL isInitialized;
+@property (nonatomic, assign) BOOL keepsRowOffsets;
+@property (nonatomic, strong) NSMutableDictionary *attributesCache;
+@property (nonatomic, strong) NSMutableDictionary *mergedAttributesCache;
+@property (nonatomic, assign) BOOL delegateProvidesMergedCells;
+@property (nonatomic, strong) NSArray *visibleAttributes;
+@property (nonatomic, assign) NSRange visibleRows;
+@property (nonatomic, assign) NSRange visibleColumns;
+@property (nonatomic, assign) BOOL keepsOffsetsOnInvalidation;
 
 @end
 
+// The cache holds this many screens of cells, and never fewer than the minimum. Past that, the cells
+// outside the visible rows and columns are dropped, so the ones on screen are never made again.
+const static NSUInteger MMGridLayoutAttributesCacheScreens = 4;
+const static NSUInteger MMGridLayoutAttributesCacheMinimum = 1024;
+
 @implementation MMGridLayout
+{
+    MMGridAxis _rowAxis;
+    MMGridAxis _columnAxis;
+}
 
 - (instancetype)init
 {
@@ -37,10 +57,20 @@
     if (self) {
         _cellSpacing = 1.0f;
         _itemSize = CGSizeMake(120.0f, 120.0f);
+        _attributesCache = [NSMutableDictionary dictionary];
+        _mergedAttributesCache = [NSMutableDictionary dictionary];
+        MMGridAxisInit(&_rowAxis);
+        MMGridAxisInit(&_columnAxis);
     }
     return self;
 }
 
+- (void)dealloc
+{
+    MMGridAxisFree(&_rowAxis);
+    MMGridAxisFree(&_columnAxis);
+}
+
 - (void)setItemSize:(CGSize)itemSize
 {
     _itemSize = CGSizeMake(itemSize.width + self.cellSpacing, itemSize.height + self.cellSpacing);
@@ -53,20 +83,214 @@
     [self invalidateLayout];
 }
 
+- (void)setFrozenRowCount:(NSUInteger)frozenRowCount
+{
+    _frozenRowCount = frozenRowCount;
+    [self invalidateLayout];
+}
+
+- (void)setFrozenColumnCount:(NSUInteger)frozenColumnCount
+{
+    _frozenColumnCount = frozenColumnCount;
+    [self invalidateLayout];
+}
+
+- (void)setOmitsCells:(BOOL)omitsCells
+{
+    _omitsCells = omitsCells;
+    [self invalidateLayout];
+}
+
+- (void)setUsesVirtualCoordinates:(BOOL)usesVirtualCoordinates
+{
+    _usesVirtualCoordinates = usesVirtualCoordinates;
+    _rowOrigin = 0.0;
+    _columnOrigin = 0.0;
+    [self invalidateLayout];
+}
+
+- (void)setRowOrigin:(double)rowOrigin columnOrigin:(double)columnOrigin
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    rowOrigin = [self clampedOrigin:rowOrigin forAxis:&_rowAxis];
+    columnOrigin = [self clampedOrigin:columnOrigin forAxis:&_columnAxis];
+    if (rowOrigin == _rowOrigin && columnOrigin == _columnOrigin) {
+        return;
+    }
+    _rowOrigin = rowOrigin;
+    _columnOrigin = columnOrigin;
+
+    // Every frame moves, but no size changes, so the offsets are kept.
+    [self.attributesCache removeAllObjects];
+    [self.mergedAttributesCache removeAllObjects];
+    self.visibleAttributes = nil;
+    self.keepsOffsetsOnInvalidation = YES;
+    [self invalidateLayout];
+}
+
+- (double)clampedOrigin:(double)origin forAxis:(const MMGridAxis *)axis
+{
+    if (!self.usesVirtualCoordinates) {
+        return 0.0;
+    }
+    double maximumOrigin = MAX(MMGridAxisLength(axis) - MMGridVirtualWindowLength, 0.0);
+    return MIN(MAX(origin, 0.0), maximumOrigin);
+}
+
+- (double)windowLengthForAxis:(const MMGridAxis *)axis origin:(double)origin
+{
+    double length = MMGridAxisLength(axis);
+    if (self.usesVirtualCoordinates && length > MMGridVirtualWindowLength) {
+        return MIN(length - origin, MMGridVirtualWindowLength);
+    }
+    return length;
+}
+
+- (double)virtualContentHeight
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    return MMGridAxisLength(&_rowAxis);
+}
+
+- (double)virtualContentWidth
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    return MMGridAxisLength(&_columnAxis);
+}
+
+- (BOOL)hasFrozenCells
+{
+    return self.frozenRowCount > 0 || self.frozenColumnCount > 0;
+}
+
+- (void)invalidateLayout
+{
+    // On iOS 6 scrolling a layout with frozen cells comes through here, as does moving the virtual window.
+    // The sizes have not changed, so keep the offsets and cached attributes; only the pinned cells need to move.
+    // On iOS 7 and later super calls invalidateLayoutWithContext:, which must see the flag too, so it is cleared afterwards.
+    BOOL keepsOffsets = self.keepsOffsetsOnInvalidation;
+    [super invalidateLayout];
+    self.keepsOffsetsOnInvalidation = NO;
+    if (!keepsOffsets) {
+        [self resetCachedLayout];
+    }
+}
+
+- (void)invalidateLayoutWithContext:(UICollectionViewLayoutInvalidationContext *)context
+{
+    [super invalidateLayoutWithContext:context];
+    if (self.keepsOffsetsOnInvalidation) {
+        return;
+    }
+    // Only called on iOS 7 and later. invalidateDataSourceCounts is iOS 8 only; on iOS 7 count changes invalidate everything.
+    BOOL invalidatesCounts = [context respondsToSelector:@selector(invalidateDataSourceCounts)] && context.invalidateDataSourceCounts;
+    if (context.invalidateEverything || invalidatesCounts) {
+        [self resetCachedLayout];
+    }
+}
+
+- (void)resetCachedLayout
+{
+    self.isInitialized = NO;
+    [self.attributesCache removeAllObjects];
+    [self.mergedAttributesCache removeAllObjects];
+    self.visibleAttributes = nil;
+}
+
+- (void)invalidateColumns
+{
+    // Outlives the invalidations UIKit makes for the same update, and is used up by the next layout pass.
+    self.keepsOffsetsOnInvalidation = NO;
+    self.keepsRowOffsets = YES;
+    [self invalidateLayout];
+}
+
 - (void)prepareLayout
 {
     [super prepareLayout];
+    self.keepsOffsetsOnInvalidation = NO;
     self.gridRowCount = [self.collectionView numberOfSections];
-    self.gridColumnCount = [self.collectionView numberOfItemsInSection:0];
+    self.gridColumnCount = self.gridRowCount > 0 ? [self.collectionView numberOfItemsInSection:0] : 0;
+    self.delegateProvidesMergedCells = [self.collectionView.delegate respondsToSelector:@selector(collectionView:layout:enumerateMergedCellsInRows:columns:usingBlock:)];
 
     if (!self.isInitialized) {
-        id<UICollectionViewDelegateFlowLayout> delegate = (id)self.collectionView.delegate;
-        CGSize size = [delegate collectionView:self.collectionView
-                                        layout:self
-                        sizeForItemAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:0]];
-        self.itemSize = size;
+        [self prepareOffsets];
         self.isInitialized = YES;
     }
+    self.keepsRowOffsets = NO;
+}
+
+- (void)prepareOffsets
+{
+    id<MMGridLayoutDelegate> delegate = (id)self.collectionView.delegate;
+    BOOL delegateProvidesSizes = [delegate respondsToSelector:@selector(collectionView:layout:sizeForItemAtIndexPath:)];
+    BOOL delegateProvidesOffsets = ([delegate respondsToSelector:@selector(collectionView:layout:heightForRow:)] &&
+                                    [delegate respondsToSelector:@selector(collectionView:layout:widthForColumn:)]);
+
+    CGFloat uniformRowHeight = 0.0f;
+    if ([delegate respondsToSelector:@selector(collectionView:uniformRowHeightForLayout:)]) {
+        uniformRowHeight = [delegate collectionView:self.collectionView uniformRowHeightForLayout:self];
+    }
+
+    // Rows and columns have their own sizes only when the delegate gives them through heightForRow: and widthForColumn:.
+    // Otherwise every cell is the size of item (0, 0), or itemSize, so a reload makes one delegate call rather than one
+    // per row and column. Rows that all share a height need no offset table, which is what keeps very long sheets small.
+    CGSize itemSize = self.itemSize;
+    if (!delegateProvidesOffsets && delegateProvidesSizes && self.gridRowCount > 0 && self.gridColumnCount > 0) {
+        itemSize = [delegate collectionView:self.collectionView layout:self sizeForItemAtIndexPath:[NSIndexPath indexPathForItem:0 inSection:0]];
+        itemSize = CGSizeMake(itemSize.width + self.cellSpacing, itemSize.height + self.cellSpacing);
+    }
+    BOOL uniformRows = uniformRowHeight > 0.0f || !delegateProvidesOffsets;
+    double uniformRowPitch = uniformRowHeight > 0.0f ? uniformRowHeight + self.cellSpacing : itemSize.height;
+
+    // After a change to the columns only, the rows keep their offsets.
+    BOOL keepsRows = self.keepsRowOffsets && _rowAxis.count == self.gridRowCount;
+    double *rowOffsets = NULL;
+    if (keepsRows) {
+        // rowOffsets stays NULL, so the loop below does not run.
+    }
+    else if (uniformRows) {
+        if (!MMGridAxisFillUniform(&_rowAxis, self.gridRowCount, uniformRowPitch)) {
+            self.gridRowCount = 0;
+        }
+    }
+    else {
+        rowOffsets = MMGridAxisPrepare(&_rowAxis, self.gridRowCount);
+        if (rowOffsets == NULL) {
+            self.gridRowCount = 0;
+        }
+    }
+    for (NSInteger row = 0; rowOffsets != NULL && row < self.gridRowCount; row++) {
+        CGFloat height = [delegate collectionView:self.collectionView layout:self heightForRow:row] + self.cellSpacing;
+        rowOffsets[row + 1] = rowOffsets[row] + height;
+    }
+
+    double *columnOffsets = NULL;
+    if (!delegateProvidesOffsets) {
+        if (!MMGridAxisFillUniform(&_columnAxis, self.gridColumnCount, itemSize.width)) {
+            self.gridColumnCount = 0;
+        }
+    }
+    else {
+        columnOffsets = MMGridAxisPrepare(&_columnAxis, self.gridColumnCount);
+        if (columnOffsets == NULL) {
+            self.gridColumnCount = 0;
+        }
+    }
+    for (NSInteger column = 0; columnOffsets != NULL && column < self.gridColumnCount; column++) {
+        CGFloat width = [delegate collectionView:self.collectionView layout:self widthForColumn:column] + self.cellSpacing;
+        columnOffsets[column + 1] = columnOffsets[column] + width;
+    }
+
+    // The grid may have shrunk under the window.
+    _rowOrigin = [self clampedOrigin:_rowOrigin forAxis:&_rowAxis];
+    _columnOrigin = [self clampedOrigin:_columnOrigin forAxis:&_columnAxis];
 }
 
 - (CGSize)collectionViewContentSize
@@ -74,40 +298,318 @@
     if (!self.isInitialized) {
         [self prepareLayout];
     }
-    CGSize size = CGSizeMake(self.gridColumnCount * self.itemSize.width, self.gridRowCount * self.itemSize.height);
+    CGSize size = CGSizeMake([self windowLengthForAxis:&_columnAxis origin:self.columnOrigin],
+                             [self windowLengthForAxis:&_rowAxis origin:self.rowOrigin]);
     return size;
 }
 
 - (NSArray *)layoutAttributesForElementsInRect:(CGRect)rect
 {
-    NSMutableArray *attributes = [NSMutableArray array];
-    NSUInteger startRow = floorf(rect.origin.y / self.itemSize.height);
-    NSUInteger startCol = floorf(rect.origin.x / self.itemSize.width);
-    NSUInteger endRow = MIN(self.gridRowCount - 1, ceilf(CGRectGetMaxY(rect) / self.itemSize.height));
-    NSUInteger endCol = MIN(self.gridColumnCount - 1, ceilf(CGRectGetMaxX(rect) / self.itemSize.width));
-    NSParameterAssert(self.gridRowCount > 0);
-    NSParameterAssert(self.gridColumnCount > 0);
-    
-    for (NSUInteger row = startRow; row <= endRow; row++) {
-        for (NSUInteger col = startCol; col <=  endCol; col++) {
-            NSIndexPath *indexPath = [NSIndexPath indexPathForItem:col inSection:row];
-            UICollectionViewLayoutAttributes *layoutAttributes = [self layoutAttributesForItemAtIndexPath:indexPath];
-            [attributes addObject:layoutAttributes];
+    if (self.gridRowCount == 0 || self.gridColumnCount == 0) {
+        return @[];
+    }
+
+    CFTimeInterval startTime = CACurrentMediaTime();
+    NSRange rows = [self rowRangeForRect:rect];
+    NSRange columns = [self columnRangeForRect:rect];
+    NSArray *attributes = self.omitsCells ? @[] : [self cachedLayoutAttributesForRows:rows columns:columns];
+    if ([self hasFrozenCells]) {
+        attributes = [self pinnedLayoutAttributesForRows:rows columns:columns attributes:attributes];
+    }
+    [self.metrics recordLayoutDuration:CACurrentMediaTime() - startTime forPane:self.collectionView.tag];
+    return attributes;
+}
+
+- (NSArray *)cachedLayoutAttributesForRows:(NSRange)rows columns:(NSRange)columns
+{
+    // Most scroll frames stay within the same rows and columns, so hand back the same array.
+    if (self.visibleAttributes && NSEqualRanges(rows, self.visibleRows) && NSEqualRanges(columns, self.visibleColumns)) {
+        return self.visibleAttributes;
+    }
+
+    NSUInteger visibleCount = rows.length * columns.length;
+    NSUInteger limit = MAX(visibleCount * MMGridLayoutAttributesCacheScreens, MMGridLayoutAttributesCacheMinimum);
+    if ([self.attributesCache count] + visibleCount > limit) {
+        [self evictCachedAttributesOutsideRows:rows columns:columns];
+    }
+
+    NSMutableArray *attributes = [NSMutableArray arrayWithCapacity:rows.length * columns.length];
+    [self addLayoutAttributesForRows:rows columns:columns pinned:NO toArray:attributes];
+    self.visibleRows = rows;
+    self.visibleColumns = columns;
+    self.visibleAttributes = attributes;
+    return attributes;
+}
+
+- (void)evictCachedAttributesOutsideRows:(NSRange)rows columns:(NSRange)columns
+{
+    // Frozen cells are shown whatever the scroll position, so they stay too.
+    NSInteger frozenRows = self.frozenRowCount;
+    NSInteger frozenColumns = self.frozenColumnCount;
+    NSMutableArray *keys = [NSMutableArray array];
+    [self.attributesCache enumerateKeysAndObjectsUsingBlock:^(NSNumber *key, UICollectionViewLayoutAttributes *attributes, BOOL *stop) {
+        NSInteger row = attributes.indexPath.section;
+        NSInteger column = attributes.indexPath.item;
+        BOOL rowShown = row < frozenRows || NSLocationInRange(row, rows);
+        BOOL columnShown = column < frozenColumns || NSLocationInRange(column, columns);
+        if (!rowShown || !columnShown) {
+            [keys addObject:key];
+        }
+    }];
+    [self.attributesCache removeObjectsForKeys:keys];
+    // There are few merged cells, and one may cover the visible cells from outside them, so these are simply made again.
+    [self.mergedAttributesCache removeAllObjects];
+}
+
+- (NSArray *)pinnedLayoutAttributesForRows:(NSRange)rows columns:(NSRange)columns attributes:(NSArray *)cachedAttributes
+{
+    NSUInteger frozenRows = MIN(self.frozenRowCount, (NSUInteger)self.gridRowCount);
+    NSUInteger frozenColumns = MIN(self.frozenColumnCount, (NSUInteger)self.gridColumnCount);
+
+    // The cached attributes leave out the frozen cells, which are added below as pinned copies.
+    NSMutableArray *attributes = [NSMutableArray arrayWithArray:cachedAttributes];
+
+    // Frozen rows are always on screen, across the visible columns, and frozen columns across the visible rows.
+    NSMutableIndexSet *visibleRows = [NSMutableIndexSet indexSetWithIndexesInRange:rows];
+    [visibleRows addIndexesInRange:NSMakeRange(0, frozenRows)];
+    NSMutableIndexSet *visibleColumns = [NSMutableIndexSet indexSetWithIndexesInRange:columns];
+    [visibleColumns addIndexesInRange:NSMakeRange(0, frozenColumns)];
+
+    [visibleRows enumerateRangesUsingBlock:^(NSRange rowRange, BOOL *stopRows) {
+        [visibleColumns enumerateRangesUsingBlock:^(NSRange columnRange, BOOL *stopColumns) {
+            if (rowRange.location < frozenRows || columnRange.location < frozenColumns) {
+                [self addLayoutAttributesForRows:rowRange columns:columnRange pinned:YES toArray:attributes];
+            }
+        }];
+    }];
+    return attributes;
+}
+
+// Adds the cells of a block, either only the pinned ones or only the scrolling ones.
+// Each merged cell is added once, in place of the cells it covers.
+- (void)addLayoutAttributesForRows:(NSRange)rows columns:(NSRange)columns pinned:(BOOL)pinned toArray:(NSMutableArray *)attributes
+{
+    NSInteger frozenRows = self.frozenRowCount;
+    NSInteger frozenColumns = self.frozenColumnCount;
+
+    NSData *mergedCells = [self mergedCellsInRows:rows columns:columns];
+    const MMGridSpan *spans = [mergedCells bytes];
+    NSUInteger spanCount = [mergedCells length] / sizeof(MMGridSpan);
+    NSMutableData *coveredCells = spanCount > 0 ? [NSMutableData dataWithLength:rows.length * columns.length] : nil;
+    uint8_t *covered = [coveredCells mutableBytes];
+    MMGridRange blockRows = { rows.location, rows.length };
+    MMGridRange blockColumns = { columns.location, columns.length };
+    for (NSUInteger index = 0; index < spanCount; index++) {
+        MMGridSpan visible;
+        if (!MMGridSpanClip(spans[index], blockRows, blockColumns, &visible)) {
+            continue;
         }
+        for (long row = visible.row; row < visible.row + visible.rowCount; row++) {
+            memset(covered + (row - rows.location) * columns.length + (visible.column - columns.location), 1, visible.columnCount);
+        }
+        if ((spans[index].row < frozenRows || spans[index].column < frozenColumns) == pinned) {
+            UICollectionViewLayoutAttributes *spanAttributes = [self cachedLayoutAttributesForMergedCell:spans[index]];
+            [attributes addObject:pinned ? [self pinnedLayoutAttributesFromAttributes:spanAttributes] : spanAttributes];
+        }
+    }
+
+    for (NSInteger row = rows.location; row < NSMaxRange(rows); row++) {
+        for (NSInteger column = columns.location; column < NSMaxRange(columns); column++) {
+            if (covered && covered[(row - rows.location) * columns.length + (column - columns.location)]) {
+                continue;
+            }
+            if ((row < frozenRows || column < frozenColumns) == pinned) {
+                UICollectionViewLayoutAttributes *cellAttributes = [self cachedLayoutAttributesForRow:row column:column];
+                [attributes addObject:pinned ? [self pinnedLayoutAttributesFromAttributes:cellAttributes] : cellAttributes];
+            }
+        }
+    }
+}
+
+// The merged cells that intersect a block, split at the edges of the frozen rows and columns so each piece is either pinned or not.
+- (NSData *)mergedCellsInRows:(NSRange)rows columns:(NSRange)columns
+{
+    if (!self.delegateProvidesMergedCells || rows.length == 0 || columns.length == 0) {
+        return nil;
     }
+    long frozenRows = MIN((NSInteger)self.frozenRowCount, self.gridRowCount);
+    long frozenColumns = MIN((NSInteger)self.frozenColumnCount, self.gridColumnCount);
+    long rowCount = self.gridRowCount;
+    long columnCount = self.gridColumnCount;
+    MMGridRange blockRows = { rows.location, rows.length };
+    MMGridRange blockColumns = { columns.location, columns.length };
+    NSMutableData *pieces = [NSMutableData data];
+    id<MMGridLayoutDelegate> delegate = (id)self.collectionView.delegate;
+    [delegate collectionView:self.collectionView layout:self enumerateMergedCellsInRows:rows columns:columns usingBlock:^(MMGridSpan span) {
+        MMGridRange rowParts[2] = { { 0, frozenRows }, { frozenRows, rowCount - frozenRows } };
+        MMGridRange columnParts[2] = { { 0, frozenColumns }, { frozenColumns, columnCount - frozenColumns } };
+        for (int rowPart = 0; rowPart < 2; rowPart++) {
+            for (int columnPart = 0; columnPart < 2; columnPart++) {
+                MMGridSpan piece;
+                MMGridSpan visible;
+                if (MMGridSpanClip(span, rowParts[rowPart], columnParts[columnPart], &piece) &&
+                    MMGridSpanClip(piece, blockRows, blockColumns, &visible)) {
+                    [pieces appendBytes:&piece length:sizeof(MMGridSpan)];
+                }
+            }
+        }
+    }];
+    return pieces;
+}
+
+- (UICollectionViewLayoutAttributes *)pinnedLayoutAttributesFromAttributes:(UICollectionViewLayoutAttributes *)cachedAttributes
+{
+    NSInteger row = cachedAttributes.indexPath.section;
+    NSInteger column = cachedAttributes.indexPath.item;
+    BOOL pinnedRow = row < self.frozenRowCount;
+    BOOL pinnedColumn = column < self.frozenColumnCount;
+
+    // Pinned cells move with the content offset, so they are copies rather than the cached objects.
+    // Past the top or left edge (in a bounce) they stay attached to the content, like the separate header panes do.
+    // They are placed from their logical offset, since a virtual window may have scrolled far past them.
+    CGPoint contentOffset = self.collectionView.contentOffset;
+    UICollectionViewLayoutAttributes *attributes = [cachedAttributes copy];
+    CGRect frame = attributes.frame;
+    if (pinnedRow) {
+        frame.origin.y = MMGridAxisOffset(&_rowAxis, row) + MAX(contentOffset.y, 0.0f);
+    }
+    if (pinnedColumn) {
+        frame.origin.x = MMGridAxisOffset(&_columnAxis, column) + MAX(contentOffset.x, 0.0f);
+    }
+    attributes.frame = frame;
+    attributes.zIndex = (pinnedRow ? 1 : 0) + (pinnedColumn ? 1 : 0);
     return attributes;
 }
 
+- (NSRange)rowRangeForRect:(CGRect)rect
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    MMGridRange rows = MMGridAxisRangeForSpan(&_rowAxis, self.rowOrigin + CGRectGetMinY(rect), self.rowOrigin + CGRectGetMaxY(rect));
+    return NSMakeRange(rows.location, rows.length);
+}
+
+- (NSRange)columnRangeForRect:(CGRect)rect
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    MMGridRange columns = MMGridAxisRangeForSpan(&_columnAxis, self.columnOrigin + CGRectGetMinX(rect), self.columnOrigin + CGRectGetMaxX(rect));
+    return NSMakeRange(columns.location, columns.length);
+}
+
+- (double)offsetForRow:(NSInteger)row
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    if (_rowAxis.offsets == NULL) {
+        return 0.0;
+    }
+    return MMGridAxisOffset(&_rowAxis, MAX(MIN(row, _rowAxis.count), 0));
+}
+
+- (double)offsetForColumn:(NSInteger)column
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    if (_columnAxis.offsets == NULL) {
+        return 0.0;
+    }
+    return MMGridAxisOffset(&_columnAxis, MAX(MIN(column, _columnAxis.count), 0));
+}
+
+- (BOOL)copyRowAxis:(MMGridAxis *)rowAxis columnAxis:(MMGridAxis *)columnAxis
+{
+    if (!self.isInitialized) {
+        [self prepareLayout];
+    }
+    return MMGridAxisCopy(rowAxis, &_rowAxis) && MMGridAxisCopy(columnAxis, &_columnAxis);
+}
+
 - (UICollectionViewLayoutAttributes *)layoutAttributesForItemAtIndexPath:(NSIndexPath *)indexPath
 {
-    UICollectionViewLayoutAttributes *attributes = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
-    attributes.frame = CGRectMake(indexPath.item * self.itemSize.width, indexPath.section * self.itemSize.height, self.itemSize.width-self.cellSpacing, self.itemSize.height-self.cellSpacing);
+    NSInteger row = indexPath.section;
+    NSInteger column = indexPath.item;
+    UICollectionViewLayoutAttributes *attributes = nil;
+    BOOL covered = NO;
+    NSData *mergedCells = [self mergedCellsInRows:NSMakeRange(row, 1) columns:NSMakeRange(column, 1)];
+    if ([mergedCells length] > 0) {
+        const MMGridSpan *span = [mergedCells bytes];
+        if (span->row == row && span->column == column) {
+            attributes = [self cachedLayoutAttributesForMergedCell:*span];
+        }
+        else {
+            covered = YES;
+        }
+    }
+    if (attributes == nil) {
+        attributes = [self cachedLayoutAttributesForRow:row column:column];
+    }
+    if (row < self.frozenRowCount || column < self.frozenColumnCount) {
+        attributes = [self pinnedLayoutAttributesFromAttributes:attributes];
+    }
+    // A cell under a merged cell is never shown, but UICollectionView may still ask for it while animating.
+    if (covered) {
+        attributes = [attributes copy];
+        attributes.hidden = YES;
+    }
+    return attributes;
+}
+
+- (UICollectionViewLayoutAttributes *)cachedLayoutAttributesForRow:(NSInteger)row column:(NSInteger)column
+{
+    // The key is a number rather than an index path, which is cheaper to make and hash. It is 64 bits so a long
+    // sheet cannot overflow it on 32-bit devices, where the number is a small allocation rather than a tagged pointer.
+    NSNumber *key = @((long long)row * self.gridColumnCount + column);
+    UICollectionViewLayoutAttributes *attributes = self.attributesCache[key];
+    if (attributes == nil) {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForItem:column inSection:row];
+        attributes = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
+        attributes.frame = [self frameForItemAtRow:row column:column];
+        self.attributesCache[key] = attributes;
+    }
     return attributes;
 }
 
+- (UICollectionViewLayoutAttributes *)cachedLayoutAttributesForMergedCell:(MMGridSpan)span
+{
+    // Merged cells do not overlap, so the top-left cell identifies one.
+    NSNumber *key = @((long long)span.row * self.gridColumnCount + span.column);
+    UICollectionViewLayoutAttributes *attributes = self.mergedAttributesCache[key];
+    if (attributes == nil) {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForItem:span.column inSection:span.row];
+        attributes = [UICollectionViewLayoutAttributes layoutAttributesForCellWithIndexPath:indexPath];
+        attributes.frame = [self frameForMergedCell:span];
+        self.mergedAttributesCache[key] = attributes;
+    }
+    return attributes;
+}
+
+- (CGRect)frameForMergedCell:(MMGridSpan)span
+{
+    double x = MMGridAxisOffset(&_columnAxis, span.column);
+    double y = MMGridAxisOffset(&_rowAxis, span.row);
+    return CGRectMake(x - self.columnOrigin,
+                      y - self.rowOrigin,
+                      MMGridAxisOffset(&_columnAxis, span.column + span.columnCount) - x - self.cellSpacing,
+                      MMGridAxisOffset(&_rowAxis, span.row + span.rowCount) - y - self.cellSpacing);
+}
+
+- (CGRect)frameForItemAtRow:(NSInteger)row column:(NSInteger)column
+{
+    return CGRectMake(MMGridAxisOffset(&_columnAxis, column) - self.columnOrigin,
+                      MMGridAxisOffset(&_rowAxis, row) - self.rowOrigin,
+                      MMGridAxisSize(&_columnAxis, column) - self.cellSpacing,
+                      MMGridAxisSize(&_rowAxis, row) - self.cellSpacing);
+}
+
 - (BOOL)shouldInvalidateLayoutForBoundsChange:(CGRect)newBounds
 {
-    return NO;
+    self.keepsOffsetsOnInvalidation = [self hasFrozenCells];
+    return self.keepsOffsetsOnInvalidation;
 }
 
 @end
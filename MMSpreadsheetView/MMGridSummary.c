@@ -0,0 +1,240 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "MMGridSummary.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+#if defined(__APPLE__)
+#include <Accelerate/Accelerate.h>
+#endif
+
+// 8 KB of doubles, so re-reducing the block under an edited value is cheap.
+const long MMGridSummaryBlockLength = 1024;
+
+// The total follows block changes by difference, and is recombined from the blocks this often so rounding cannot build up.
+static const long MMGridSummaryUpdatesPerCombine = 1024;
+
+static MMGridAggregate MMGridAggregateEmpty(void)
+{
+    MMGridAggregate aggregate = { 0.0, NAN, NAN, 0 };
+    return aggregate;
+}
+
+static MMGridAggregate MMGridAggregateCombine(MMGridAggregate a, MMGridAggregate b)
+{
+    if (a.count == 0) {
+        return b;
+    }
+    if (b.count == 0) {
+        return a;
+    }
+    MMGridAggregate aggregate;
+    aggregate.sum = a.sum + b.sum;
+    aggregate.minimum = a.minimum < b.minimum ? a.minimum : b.minimum;
+    aggregate.maximum = a.maximum > b.maximum ? a.maximum : b.maximum;
+    aggregate.count = a.count + b.count;
+    return aggregate;
+}
+
+// Skips NaN one value at a time. Only used for runs the vector pass found a NaN in.
+static MMGridAggregate MMGridAggregateValuesSkippingNaN(const double *values, long count)
+{
+    MMGridAggregate aggregate = MMGridAggregateEmpty();
+    for (long i = 0; i < count; i++) {
+        double value = values[i];
+        if (isnan(value)) {
+            continue;
+        }
+        if (aggregate.count == 0) {
+            aggregate.minimum = value;
+            aggregate.maximum = value;
+        }
+        else {
+            aggregate.minimum = value < aggregate.minimum ? value : aggregate.minimum;
+            aggregate.maximum = value > aggregate.maximum ? value : aggregate.maximum;
+        }
+        aggregate.sum += value;
+        aggregate.count++;
+    }
+    return aggregate;
+}
+
+MMGridAggregate MMGridAggregateValues(const double *values, long count)
+{
+    if (count <= 0) {
+        return MMGridAggregateEmpty();
+    }
+    MMGridAggregate aggregate;
+#if defined(__APPLE__)
+    vDSP_sveD(values, 1, &aggregate.sum, (vDSP_Length)count);
+    vDSP_minvD(values, 1, &aggregate.minimum, (vDSP_Length)count);
+    vDSP_maxvD(values, 1, &aggregate.maximum, (vDSP_Length)count);
+#else
+    double sum = 0.0;
+    double minimum = values[0];
+    double maximum = values[0];
+    for (long i = 0; i < count; i++) {
+        sum += values[i];
+        minimum = values[i] < minimum ? values[i] : minimum;
+        maximum = values[i] > maximum ? values[i] : maximum;
+    }
+    aggregate.sum = sum;
+    aggregate.minimum = minimum;
+    aggregate.maximum = maximum;
+#endif
+    aggregate.count = count;
+    // Any NaN makes the sum NaN (as do infinities of both signs), so check once instead of per value.
+    if (isnan(aggregate.sum)) {
+        return MMGridAggregateValuesSkippingNaN(values, count);
+    }
+    return aggregate;
+}
+
+double MMGridAggregateAverage(MMGridAggregate aggregate)
+{
+    return aggregate.count > 0 ? aggregate.sum / (double)aggregate.count : NAN;
+}
+
+// MARK: - Summary
+
+void MMGridSummaryInit(MMGridSummary *summary)
+{
+    summary->blocks = NULL;
+    summary->blockCount = 0;
+    summary->valueCount = 0;
+    summary->total = MMGridAggregateEmpty();
+    summary->updatesSinceCombine = 0;
+}
+
+void MMGridSummaryFree(MMGridSummary *summary)
+{
+    free(summary->blocks);
+    MMGridSummaryInit(summary);
+}
+
+static void MMGridSummaryReduceBlock(MMGridSummary *summary, const double *values, long block)
+{
+    long first = block * MMGridSummaryBlockLength;
+    long length = summary->valueCount - first;
+    length = length < MMGridSummaryBlockLength ? length : MMGridSummaryBlockLength;
+    summary->blocks[block] = MMGridAggregateValues(values + first, length);
+}
+
+static void MMGridSummaryCombineBlocks(MMGridSummary *summary)
+{
+    MMGridAggregate total = MMGridAggregateEmpty();
+    for (long block = 0; block < summary->blockCount; block++) {
+        total = MMGridAggregateCombine(total, summary->blocks[block]);
+    }
+    summary->total = total;
+    summary->updatesSinceCombine = 0;
+}
+
+// Moves the total from an old block summary to a new one. Returns 0 when that cannot be done by difference,
+// because the old block held the minimum or maximum and the new one does not.
+static int MMGridSummaryReplaceBlock(MMGridSummary *summary, MMGridAggregate oldBlock, MMGridAggregate newBlock)
+{
+    MMGridAggregate *total = &summary->total;
+    if (oldBlock.count > 0 && (oldBlock.minimum == total->minimum || oldBlock.maximum == total->maximum)) {
+        return 0;
+    }
+    long count = total->count;
+    MMGridAggregate combined = MMGridAggregateCombine(*total, newBlock);
+    combined.sum = total->sum - oldBlock.sum + newBlock.sum;
+    combined.count = count - oldBlock.count + newBlock.count;
+    if (combined.count == 0) {
+        combined = MMGridAggregateEmpty();
+    }
+    *total = combined;
+    return 1;
+}
+
+int MMGridSummaryBuild(MMGridSummary *summary, const double *values, long count)
+{
+    MMGridSummaryFree(summary);
+    if (count <= 0) {
+        return 1;
+    }
+    long blockCount = (count + MMGridSummaryBlockLength - 1) / MMGridSummaryBlockLength;
+    MMGridAggregate *blocks = malloc((size_t)blockCount * sizeof(MMGridAggregate));
+    if (blocks == NULL) {
+        return 0;
+    }
+    summary->blocks = blocks;
+    summary->blockCount = blockCount;
+    summary->valueCount = count;
+    for (long block = 0; block < blockCount; block++) {
+        MMGridSummaryReduceBlock(summary, values, block);
+    }
+    MMGridSummaryCombineBlocks(summary);
+    return 1;
+}
+
+void MMGridSummaryUpdate(MMGridSummary *summary, const double *values, MMGridRange changed)
+{
+    long first = changed.location > 0 ? changed.location : 0;
+    long end = changed.location + changed.length;
+    end = end < summary->valueCount ? end : summary->valueCount;
+    if (first >= end) {
+        return;
+    }
+    int needsCombine = ++summary->updatesSinceCombine >= MMGridSummaryUpdatesPerCombine;
+    for (long block = first / MMGridSummaryBlockLength; block <= (end - 1) / MMGridSummaryBlockLength; block++) {
+        MMGridAggregate oldBlock = summary->blocks[block];
+        MMGridSummaryReduceBlock(summary, values, block);
+        needsCombine = needsCombine || !MMGridSummaryReplaceBlock(summary, oldBlock, summary->blocks[block]);
+    }
+    if (needsCombine) {
+        MMGridSummaryCombineBlocks(summary);
+    }
+}
+
+int MMGridSummaryAppend(MMGridSummary *summary, const double *values, long count)
+{
+    if (count <= summary->valueCount) {
+        return 1;
+    }
+    long blockCount = (count + MMGridSummaryBlockLength - 1) / MMGridSummaryBlockLength;
+    if (blockCount > summary->blockCount) {
+        MMGridAggregate *blocks = realloc(summary->blocks, (size_t)blockCount * sizeof(MMGridAggregate));
+        if (blocks == NULL) {
+            return 0;
+        }
+        summary->blocks = blocks;
+    }
+
+    // The last block may be partial. Its old values are still there, so the minimum and maximum can only widen
+    // and the total only has to give back the block's sum and count.
+    long firstBlock = summary->valueCount / MMGridSummaryBlockLength;
+    MMGridAggregate total = summary->total;
+    if (firstBlock < summary->blockCount) {
+        total.sum -= summary->blocks[firstBlock].sum;
+        total.count -= summary->blocks[firstBlock].count;
+    }
+    summary->blockCount = blockCount;
+    summary->valueCount = count;
+    for (long block = firstBlock; block < blockCount; block++) {
+        MMGridSummaryReduceBlock(summary, values, block);
+        total = MMGridAggregateCombine(total, summary->blocks[block]);
+    }
+    summary->total = total.count > 0 ? total : MMGridAggregateEmpty();
+    return 1;
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef MMGridSummary_h
+#define MMGridSummary_h
+
+#include "MMGridGeometry.h"
+
+/*
+ Column summaries (sum, minimum, maximum, count) for the footer of `MMSpreadsheetView`, with no UIKit dependency.
+ 
+ A column is split into fixed-size blocks and each block keeps its own summary, so changing a few values only re-reduces the blocks they fall in. The total follows by difference, and is only recombined from every block when a block that held the minimum or maximum changes. Blocks are reduced with vDSP on Apple platforms and with plain loops elsewhere, so the benchmark builds anywhere (see Benchmarks/).
+ 
+ NaN values are skipped, so blanks can be stored as NaN.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ The summary of a run of values. minimum and maximum are NaN when count is 0.
+ */
+typedef struct {
+    double sum;
+    double minimum;
+    double maximum;
+    long count;
+} MMGridAggregate;
+
+/*
+ The number of values in each block.
+ */
+extern const long MMGridSummaryBlockLength;
+
+/*
+ The block summaries of a column and their combined total.
+ */
+typedef struct {
+    MMGridAggregate *blocks;
+    long blockCount;
+    long valueCount;
+    MMGridAggregate total;
+    long updatesSinceCombine;
+} MMGridSummary;
+
+void MMGridSummaryInit(MMGridSummary *summary);
+void MMGridSummaryFree(MMGridSummary *summary);
+
+/*
+ Summarizes count values. Returns 0 if the allocation fails, in which case the summary is left empty.
+ */
+int MMGridSummaryBuild(MMGridSummary *summary, const double *values, long count);
+
+/*
+ Re-summarizes the blocks that hold the given values after they changed. values is the whole column, which must still hold valueCount values.
+ */
+void MMGridSummaryUpdate(MMGridSummary *summary, const double *values, MMGridRange changed);
+
+/*
+ Extends the summary to count values after values were appended to the column. Only the last partial block and the new blocks are reduced. values is the whole column. Returns 0 if the allocation fails, in which case the summary is left as it was.
+ */
+int MMGridSummaryAppend(MMGridSummary *summary, const double *values, long count);
+
+/*
+ Summarizes a run of values directly.
+ */
+MMGridAggregate MMGridAggregateValues(const double *values, long count);
+
+/*
+ The mean of the summarized values, or NaN if there are none.
+ */
+double MMGridAggregateAverage(MMGridAggregate aggregate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,157 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#include "MMGridUpdateQueue.h"
+
+#include <stdlib.h>
+
+int MMGridUpdateQueueInit(MMGridUpdateQueue *queue, long capacity)
+{
+    unsigned long slotCount = 2;
+    while (slotCount < (unsigned long)capacity) {
+        slotCount <<= 1;
+    }
+    queue->slots = malloc(slotCount * sizeof(MMGridUpdateSlot));
+    queue->mask = queue->slots ? slotCount - 1 : 0;
+    queue->dequeuePosition = 0;
+    atomic_init(&queue->enqueuePosition, 0);
+    atomic_init(&queue->overflowCount, 0);
+    if (queue->slots == NULL) {
+        return 0;
+    }
+    // A slot is free for the producer whose position matches its sequence.
+    for (unsigned long i = 0; i < slotCount; i++) {
+        atomic_init(&queue->slots[i].sequence, i);
+    }
+    return 1;
+}
+
+void MMGridUpdateQueueFree(MMGridUpdateQueue *queue)
+{
+    free(queue->slots);
+    queue->slots = NULL;
+    queue->mask = 0;
+}
+
+int MMGridUpdateQueuePush(MMGridUpdateQueue *queue, MMGridCellIndex cell)
+{
+    if (queue->slots == NULL) {
+        atomic_fetch_add_explicit(&queue->overflowCount, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    unsigned long position = atomic_load_explicit(&queue->enqueuePosition, memory_order_relaxed);
+    for (;;) {
+        MMGridUpdateSlot *slot = &queue->slots[position & queue->mask];
+        unsigned long sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        long difference = (long)(sequence - position);
+        if (difference == 0) {
+            // The slot is free; claim it, or retry from wherever the winning producer left the position.
+            if (atomic_compare_exchange_weak_explicit(&queue->enqueuePosition, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                slot->cell = cell;
+                atomic_store_explicit(&slot->sequence, position + 1, memory_order_release);
+                return 1;
+            }
+        }
+        else if (difference < 0) {
+            // The consumer has not drained this slot from the previous lap yet.
+            atomic_fetch_add_explicit(&queue->overflowCount, 1, memory_order_relaxed);
+            return 0;
+        }
+        else {
+            position = atomic_load_explicit(&queue->enqueuePosition, memory_order_relaxed);
+        }
+    }
+}
+
+long MMGridUpdateQueueDrain(MMGridUpdateQueue *queue, MMGridCellIndex *cells, long capacity)
+{
+    if (queue->slots == NULL) {
+        return 0;
+    }
+
+    long count = 0;
+    while (count < capacity) {
+        unsigned long position = queue->dequeuePosition;
+        MMGridUpdateSlot *slot = &queue->slots[position & queue->mask];
+        unsigned long sequence = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        // Claimed but not yet written counts as empty; the cell is picked up next frame.
+        if (sequence != position + 1) {
+            break;
+        }
+        cells[count++] = slot->cell;
+        queue->dequeuePosition = position + 1;
+        atomic_store_explicit(&slot->sequence, position + queue->mask + 1, memory_order_release);
+    }
+    return count;
+}
+
+unsigned long MMGridUpdateQueueTakeOverflowCount(MMGridUpdateQueue *queue)
+{
+    return atomic_exchange_explicit(&queue->overflowCount, 0, memory_order_relaxed);
+}
+
+static int MMGridCellIndexCompare(const void *a, const void *b)
+{
+    const MMGridCellIndex *first = a;
+    const MMGridCellIndex *second = b;
+    if (first->row != second->row) {
+        return first->row < second->row ? -1 : 1;
+    }
+    if (first->column != second->column) {
+        return first->column < second->column ? -1 : 1;
+    }
+    return 0;
+}
+
+long MMGridCellIndexCoalesce(MMGridCellIndex *cells, long count)
+{
+    if (count < 2) {
+        return count;
+    }
+    qsort(cells, (size_t)count, sizeof(MMGridCellIndex), MMGridCellIndexCompare);
+    long distinct = 1;
+    for (long i = 1; i < count; i++) {
+        if (cells[i].row != cells[distinct - 1].row || cells[i].column != cells[distinct - 1].column) {
+            cells[distinct++] = cells[i];
+        }
+    }
+    return distinct;
+}
+
+long MMGridCellIndexSearch(const MMGridCellIndex *cells, long count, MMGridCellIndex cell)
+{
+    long low = 0;
+    long high = count;
+    while (low < high) {
+        long middle = low + (high - low) / 2;
+        int order = MMGridCellIndexCompare(&cells[middle], &cell);
+        if (order == 0) {
+            return middle;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#ifndef MMGridUpdateQueue_h
+#define MMGridUpdateQueue_h
+
+#include "MMGridGeometry.h"
+
+#include <stdatomic.h>
+
+/*
+ A bounded queue of changed cells for the live update stream of `MMSpreadsheetView`, with no UIKit dependency.
+ 
+ Any number of threads may push, without locks: each slot carries a sequence number that tells a producer whether the slot is free and tells the consumer whether it has been written (Vyukov's bounded MPMC queue, cut down to a single consumer). One thread drains the queue, once per display frame, and the drained cells are coalesced so a cell that changed many times in a frame is redrawn once.
+ 
+ A full queue refuses pushes rather than blocking the producer. The consumer notices through the overflow count and redraws everything that is visible instead.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    atomic_ulong sequence;
+    MMGridCellIndex cell;
+} MMGridUpdateSlot;
+
+typedef struct {
+    MMGridUpdateSlot *slots;
+    unsigned long mask;
+    atomic_ulong enqueuePosition;
+    unsigned long dequeuePosition;
+    atomic_ulong overflowCount;
+} MMGridUpdateQueue;
+
+/*
+ Allocates room for capacity cells, rounded up to a power of two. Returns 0 if the allocation fails.
+ */
+int MMGridUpdateQueueInit(MMGridUpdateQueue *queue, long capacity);
+void MMGridUpdateQueueFree(MMGridUpdateQueue *queue);
+
+/*
+ Queues a changed cell. Safe to call from any thread. Returns 0 if the queue is full, in which case the overflow count is bumped and the cell is not queued.
+ */
+int MMGridUpdateQueuePush(MMGridUpdateQueue *queue, MMGridCellIndex cell);
+
+/*
+ Moves up to capacity queued cells into cells, oldest first, and returns how many were moved. Only one thread may drain a queue.
+ */
+long MMGridUpdateQueueDrain(MMGridUpdateQueue *queue, MMGridCellIndex *cells, long capacity);
+
+/*
+ Returns the overflow count and resets it to 0.
+ */
+unsigned long MMGridUpdateQueueTakeOverflowCount(MMGridUpdateQueue *queue);
+
+/*
+ Sorts cells by row, then column, and removes duplicates. Returns the number of distinct cells left at the front.
+ */
+long MMGridCellIndexCoalesce(MMGridCellIndex *cells, long count);
+
+/*
+ The position of cell in cells, which must be sorted as MMGridCellIndexCoalesce leaves them, or -1 if it is not there.
+ */
+long MMGridCellIndexSearch(const MMGridCellIndex *cells, long count, MMGridCellIndex cell);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
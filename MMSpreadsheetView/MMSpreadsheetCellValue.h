@@ -0,0 +1,64 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+/**
+ `MMSpreadsheetCellValue` describes what a cell shows when a `MMSpreadsheetView` draws its content as tiles: a line of text and the colors to draw it with.
+ 
+ Values are created on background threads by the value data source and only read while a tile is drawn, so they should not be changed after they are returned.
+ */
+@interface MMSpreadsheetCellValue : NSObject
+
+/**
+ Creates a value with the default font, colors and alignment.
+ 
+ @param text The text to show in the cell.
+ 
+ @return A new cell value.
+ */
++ (instancetype)valueWithText:(NSString *)text;
+
+/**
+ The text drawn in the cell. It is drawn on one line, vertically centered, and truncated at the end if it does not fit. Default is nil.
+ */
+@property (nonatomic, copy) NSString *text;
+
+/**
+ The font of the text. Default is the system font at 12 points.
+ */
+@property (nonatomic, strong) UIFont *font;
+
+/**
+ The color of the text. Default is black.
+ */
+@property (nonatomic, strong) UIColor *textColor;
+
+/**
+ The fill color of the cell. Default is white.
+ */
+@property (nonatomic, strong) UIColor *backgroundColor;
+
+/**
+ The horizontal alignment of the text. Default is NSTextAlignmentLeft.
+ */
+@property (nonatomic, assign) NSTextAlignment textAlignment;
+
+@end
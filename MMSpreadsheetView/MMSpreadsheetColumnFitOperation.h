@@ -0,0 +1,73 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import <UIKit/UIKit.h>
+
+@class MMSpreadsheetView;
+@class MMSpreadsheetMergedCells;
+@protocol MMSpreadsheetViewValueDataSource;
+
+/**
+ `MMSpreadsheetColumnFitOperation` measures how wide columns need to be to show their text, without blocking the main thread.
+ 
+ Cell text and fonts come from a value data source, so no cells are created. Measuring every row of a large sheet would take seconds, so a chosen set of rows (typically the header rows and the rows on screen) is measured exactly and the rest are sampled: the sampled rows are split into as many equal strata as the sample limit allows and one row is picked at random from each, so the sample covers the whole sheet at a fixed cost per column. Columns are measured in parallel with `dispatch_apply`, and cancelling is checked between small batches of rows.
+ 
+ Text is measured on one line in the value's font, the way tiles draw it. Cells covered by a merged cell that spans several columns are skipped, since their text is shared between the columns.
+ 
+ Run the operation on a background queue; `MMSpreadsheetView` does this for you with fitWidthsOfColumns:completion:.
+ */
+@interface MMSpreadsheetColumnFitOperation : NSOperation
+
+/**
+ Creates a fit of some columns.
+ 
+ @param spreadsheetView The spreadsheet view passed to the value data source. The operation keeps a weak reference.
+ @param valueDataSource Supplies the text of each cell. It is called concurrently on several threads.
+ @param columns The data source columns to measure.
+ @param exactRows Data source rows that are always measured.
+ @param sampledRows The data source rows to sample from.
+ @param sampleLimit The most rows of sampledRows measured per column. If sampledRows is no longer than this, every row in it is measured.
+ @param mergedCells The merged cells, in data source rows and columns, or nil.
+ 
+ @return An operation that has not started.
+ */
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                        valueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+                                columns:(NSIndexSet *)columns
+                              exactRows:(NSIndexSet *)exactRows
+                            sampledRows:(NSRange)sampledRows
+                            sampleLimit:(NSUInteger)sampleLimit
+                            mergedCells:(MMSpreadsheetMergedCells *)mergedCells;
+
+@property (nonatomic, readonly) NSIndexSet *columns;
+@property (nonatomic, readonly) NSIndexSet *exactRows;
+@property (nonatomic, readonly) NSRange sampledRows;
+@property (nonatomic, readonly) NSUInteger sampleLimit;
+
+/**
+ The width of the widest text measured in a column, in points, not counting any padding. 0 if the column has no text or is not one of the fitted columns. Only complete once the operation has finished.
+ */
+- (CGFloat)measuredWidthForColumn:(NSInteger)column;
+
+/**
+ Called once on the main thread when the operation ends. `finished` is NO if the operation was cancelled. The block is released once it has been called.
+ */
+@property (nonatomic, copy) void (^fitCompletionBlock)(BOOL finished);
+
+@end
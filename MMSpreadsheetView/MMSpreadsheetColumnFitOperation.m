@@ -0,0 +1,172 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import "MMSpreadsheetColumnFitOperation.h"
+#import "MMSpreadsheetView.h"
+#import "MMSpreadsheetMergedCells.h"
+
+// Small enough that cancelling is noticed quickly.
+const static NSUInteger MMSpreadsheetColumnFitRowsPerBatch = 256;
+
+@interface MMSpreadsheetColumnFitOperation ()
+
+@property (nonatomic, weak) MMSpreadsheetView *spreadsheetView;
+@property (nonatomic, strong) id<MMSpreadsheetViewValueDataSource> valueDataSource;
+@property (nonatomic, strong) MMSpreadsheetMergedCells *mergedCells;
+@property (nonatomic, copy) NSIndexSet *columns;
+@property (nonatomic, copy) NSIndexSet *exactRows;
+@property (nonatomic, assign) NSRange sampledRows;
+@property (nonatomic, assign) NSUInteger sampleLimit;
+
+// One width per fitted column, in column order. Each column is written by one thread.
+@property (nonatomic, strong) NSMutableData *widths;
+
+@property (nonatomic, assign) BOOL fitFinished;
+
+@end
+
+@implementation MMSpreadsheetColumnFitOperation
+
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                        valueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+                                columns:(NSIndexSet *)columns
+                              exactRows:(NSIndexSet *)exactRows
+                            sampledRows:(NSRange)sampledRows
+                            sampleLimit:(NSUInteger)sampleLimit
+                            mergedCells:(MMSpreadsheetMergedCells *)mergedCells
+{
+    NSParameterAssert(valueDataSource);
+    NSParameterAssert(columns);
+    self = [super init];
+    if (self) {
+        _spreadsheetView = spreadsheetView;
+        _valueDataSource = valueDataSource;
+        _columns = [columns copy];
+        _exactRows = exactRows ? [exactRows copy] : [NSIndexSet indexSet];
+        _sampledRows = sampledRows;
+        _sampleLimit = sampleLimit;
+        _mergedCells = mergedCells;
+        _widths = [NSMutableData dataWithLength:[columns count] * sizeof(CGFloat)];
+    }
+    return self;
+}
+
+- (void)start
+{
+    // A cancelled operation finishes without running main, but its completion block is still owed a call.
+    MMSpreadsheetColumnFitOperation *strongSelf = self;
+    [super start];
+    [strongSelf reportCompletion];
+}
+
+- (void)main
+{
+    NSUInteger columnCount = [self.columns count];
+    NSUInteger *columns = malloc(columnCount * sizeof(NSUInteger));
+    if (columns == NULL) {
+        return;
+    }
+    [self.columns getIndexes:columns maxCount:columnCount inIndexRange:NULL];
+    CGFloat *widths = self.widths.mutableBytes;
+
+    dispatch_apply(columnCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t index) {
+        if (!self.isCancelled) {
+            widths[index] = [self measureColumn:columns[index]];
+        }
+    });
+
+    free(columns);
+    self.fitFinished = !self.isCancelled;
+}
+
+#pragma mark - Measuring
+
+- (CGFloat)measureColumn:(NSInteger)column
+{
+    MMSpreadsheetView *spreadsheetView = self.spreadsheetView;
+    __block CGFloat width = 0.0f;
+    __block NSUInteger measuredCount = 0;
+    [self.exactRows enumerateIndexesUsingBlock:^(NSUInteger row, BOOL *stop) {
+        width = MAX(width, [self widthOfRow:row column:column spreadsheetView:spreadsheetView]);
+        *stop = ++measuredCount % MMSpreadsheetColumnFitRowsPerBatch == 0 && self.isCancelled;
+    }];
+
+    // One random row from each of sampleCount equal strata, so the whole range is covered however it is ordered.
+    NSRange rows = self.sampledRows;
+    BOOL samples = rows.length > self.sampleLimit;
+    NSUInteger sampleCount = samples ? self.sampleLimit : rows.length;
+    for (NSUInteger sample = 0; sample < sampleCount; sample++) {
+        if (sample % MMSpreadsheetColumnFitRowsPerBatch == 0 && self.isCancelled) {
+            break;
+        }
+        NSUInteger row = rows.location + sample;
+        if (samples) {
+            NSUInteger stratumStart = (NSUInteger)((unsigned long long)sample * rows.length / sampleCount);
+            NSUInteger stratumEnd = (NSUInteger)((unsigned long long)(sample + 1) * rows.length / sampleCount);
+            row = rows.location + stratumStart + arc4random_uniform((u_int32_t)(stratumEnd - stratumStart));
+        }
+        if (![self.exactRows containsIndex:row]) {
+            width = MAX(width, [self widthOfRow:row column:column spreadsheetView:spreadsheetView]);
+        }
+    }
+    return width;
+}
+
+- (CGFloat)widthOfRow:(NSInteger)row column:(NSInteger)column spreadsheetView:(MMSpreadsheetView *)spreadsheetView
+{
+    MMGridSpan mergedCell;
+    if (self.mergedCells && [self.mergedCells getSpan:&mergedCell containingRow:row column:column] && mergedCell.columnCount > 1) {
+        return 0.0f;
+    }
+    @autoreleasepool {
+        NSIndexPath *indexPath = [NSIndexPath indexPathForItem:column inSection:row];
+        MMSpreadsheetCellValue *value = [self.valueDataSource spreadsheetView:spreadsheetView valueForItemAtIndexPath:indexPath];
+        if ([value.text length] == 0) {
+            return 0.0f;
+        }
+        NSDictionary *attributes = value.font ? @{NSFontAttributeName: value.font} : nil;
+        return ceil([[[NSAttributedString alloc] initWithString:value.text attributes:attributes] size].width);
+    }
+}
+
+- (CGFloat)measuredWidthForColumn:(NSInteger)column
+{
+    if (column < 0 || ![self.columns containsIndex:column]) {
+        return 0.0f;
+    }
+    const CGFloat *widths = self.widths.bytes;
+    return widths[[self.columns countOfIndexesInRange:NSMakeRange(0, column)]];
+}
+
+#pragma mark - Reporting
+
+- (void)reportCompletion
+{
+    BOOL finished = self.fitFinished;
+    dispatch_async(dispatch_get_main_queue(), ^{
+        // Keeps the operation alive until its block has run, so the block can read the widths through a weak reference.
+        void (^fitCompletionBlock)(BOOL) = self.fitCompletionBlock;
+        self.fitCompletionBlock = nil;
+        if (fitCompletionBlock) {
+            fitCompletionBlock(finished);
+        }
+    });
+}
+
+@end
@@ -0,0 +1,85 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import <Foundation/Foundation.h>
+
+typedef NS_ENUM(NSUInteger, MMSpreadsheetSummaryFunction)
+{
+    MMSpreadsheetSummaryFunctionSum = 0,
+    MMSpreadsheetSummaryFunctionAverage,
+    MMSpreadsheetSummaryFunctionMinimum,
+    MMSpreadsheetSummaryFunctionMaximum,
+    MMSpreadsheetSummaryFunctionCount,
+};
+
+/**
+ `MMSpreadsheetColumnSummary` keeps the sum, minimum, maximum and count of a buffer of doubles, one per data source row, for the summary footer of a `MMSpreadsheetView`.
+ 
+ The values are summarized in fixed-size blocks, with vDSP, the first time. After that only the blocks holding changed values are summarized again, so editing a cell in a column of a million rows does not revisit the whole column. NaN values are blanks and are skipped.
+ 
+ The buffer is not copied. It may be mutable data the caller changes in place, as long as every change is followed by valuesDidChangeInRows:.
+ */
+@interface MMSpreadsheetColumnSummary : NSObject
+
+/**
+ Summarizes a range of a buffer of doubles.
+ 
+ @param values One double per data source row.
+ @param rows The rows to summarize. The range is clipped to the buffer.
+ 
+ @return A summary, or nil if its blocks could not be allocated.
+ */
+- (instancetype)initWithValues:(NSData *)values rows:(NSRange)rows;
+
+@property (nonatomic, readonly) NSData *values;
+@property (nonatomic, readonly) NSRange rows;
+
+@property (nonatomic, readonly) double sum;
+@property (nonatomic, readonly) double minimum;
+@property (nonatomic, readonly) double maximum;
+@property (nonatomic, readonly) double average;
+
+/**
+ The number of values that are not blank.
+ */
+@property (nonatomic, readonly) NSInteger count;
+
+/**
+ The result of a summary function. Minimum, maximum and average are NaN when every value is blank.
+ */
+- (double)valueForFunction:(MMSpreadsheetSummaryFunction)function;
+
+/**
+ Brings the summary up to date after values changed in place.
+ 
+ @param rows The data source rows whose values changed. Rows outside the summarized rows are ignored.
+ */
+- (void)valuesDidChangeInRows:(NSRange)rows;
+
+/**
+ Extends the summary over rows appended to the end of the column. Only the values that were not summarized before are read, along with the rest of the last block.
+ 
+ @param values The column's buffer. It may be the buffer the summary was made with, grown in place, or a new one, but the values already summarized must not have changed.
+ @param rows The rows to summarize now. They must start where the summarized rows start. The range is clipped to the buffer.
+ 
+ @return NO if the summary could not be extended, in which case it is unchanged and should be made again.
+ */
+- (BOOL)appendValues:(NSData *)values rows:(NSRange)rows;
+
+@end
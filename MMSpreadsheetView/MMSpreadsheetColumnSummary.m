@@ -0,0 +1,137 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import "MMSpreadsheetColumnSummary.h"
+#import "MMGridSummary.h"
+
+@interface MMSpreadsheetColumnSummary ()
+
+@property (nonatomic, strong) NSData *values;
+@property (nonatomic, assign) NSRange rows;
+
+@end
+
+@implementation MMSpreadsheetColumnSummary
+{
+    MMGridSummary _summary;
+}
+
+- (instancetype)initWithValues:(NSData *)values rows:(NSRange)rows
+{
+    self = [super init];
+    if (self) {
+        NSUInteger valueCount = [values length] / sizeof(double);
+        NSUInteger location = MIN(rows.location, valueCount);
+        _values = values;
+        _rows = NSMakeRange(location, MIN(rows.length, valueCount - location));
+        MMGridSummaryInit(&_summary);
+        const double *bytes = [values bytes];
+        if (!MMGridSummaryBuild(&_summary, bytes + _rows.location, _rows.length)) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    MMGridSummaryFree(&_summary);
+}
+
+- (double)sum
+{
+    return _summary.total.sum;
+}
+
+- (double)minimum
+{
+    return _summary.total.minimum;
+}
+
+- (double)maximum
+{
+    return _summary.total.maximum;
+}
+
+- (double)average
+{
+    return MMGridAggregateAverage(_summary.total);
+}
+
+- (NSInteger)count
+{
+    return _summary.total.count;
+}
+
+- (double)valueForFunction:(MMSpreadsheetSummaryFunction)function
+{
+    switch (function) {
+        case MMSpreadsheetSummaryFunctionSum:
+            return self.sum;
+
+        case MMSpreadsheetSummaryFunctionAverage:
+            return self.average;
+
+        case MMSpreadsheetSummaryFunctionMinimum:
+            return self.minimum;
+
+        case MMSpreadsheetSummaryFunctionMaximum:
+            return self.maximum;
+
+        case MMSpreadsheetSummaryFunctionCount:
+            return self.count;
+
+        default:
+            NSAssert(NO, @"What have you done?");
+            return NAN;
+    }
+}
+
+- (void)valuesDidChangeInRows:(NSRange)rows
+{
+    NSRange changed = NSIntersectionRange(rows, self.rows);
+    if (changed.length == 0) {
+        return;
+    }
+    // The buffer may have been reallocated by an in-place edit, so read its bytes again.
+    const double *bytes = [self.values bytes];
+    MMGridRange blockRows = { changed.location - self.rows.location, changed.length };
+    MMGridSummaryUpdate(&_summary, bytes + self.rows.location, blockRows);
+}
+
+- (BOOL)appendValues:(NSData *)values rows:(NSRange)rows
+{
+    NSUInteger valueCount = [values length] / sizeof(double);
+    if (rows.location != self.rows.location || rows.location > valueCount) {
+        return NO;
+    }
+    NSRange appendedRows = NSMakeRange(rows.location, MIN(rows.length, valueCount - rows.location));
+    if (appendedRows.length < self.rows.length) {
+        return NO;
+    }
+    const double *bytes = [values bytes];
+    if (!MMGridSummaryAppend(&_summary, bytes + appendedRows.location, appendedRows.length)) {
+        return NO;
+    }
+    self.values = values;
+    self.rows = appendedRows;
+    return YES;
+}
+
+@end
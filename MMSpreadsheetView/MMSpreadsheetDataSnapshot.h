@@ -0,0 +1,119 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+@class MMSpreadsheetView;
+@class MMSpreadsheetMergedCells;
+@protocol MMSpreadsheetViewDataSource;
+
+/**
+ `MMSpreadsheetDataSnapshot` holds the row and column counts, the header split, the row height and column width tables and the merged cells for a `MMSpreadsheetView`.
+ 
+ The snapshot is captured once from the data source and shared by all of the panes, so counts and sizes are not re-queried on every collection view callback. It is only refreshed when the spreadsheet view is told that its data changed (reloadData or one of the incremental update methods).
+ */
+@interface MMSpreadsheetDataSnapshot : NSObject
+
+/**
+ Captures counts and sizes from the data source.
+ 
+ @param spreadsheetView The spreadsheet view passed to the data source calls.
+ @param dataSource The data source to read from.
+ @param headerRowCount The number of header rows.
+ @param headerColumnCount The number of header columns.
+ 
+ @return A snapshot of the data source's current shape.
+ */
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                             dataSource:(id<MMSpreadsheetViewDataSource>)dataSource
+                         headerRowCount:(NSUInteger)headerRowCount
+                      headerColumnCount:(NSUInteger)headerColumnCount;
+
+@property (nonatomic, readonly) NSInteger rowCount;
+@property (nonatomic, readonly) NSInteger columnCount;
+@property (nonatomic, readonly) NSUInteger headerRowCount;
+@property (nonatomic, readonly) NSUInteger headerColumnCount;
+
+/**
+ The merged cells, in data source rows and columns. A new object is created whenever they change, so the tile renderers can keep reading an old one.
+ */
+@property (nonatomic, readonly) MMSpreadsheetMergedCells *mergedCells;
+
+/**
+ The height of every row if the data source gives one through uniformRowHeightInSpreadsheetView:, otherwise 0. While it is positive no row height table is kept.
+ */
+@property (nonatomic, readonly) CGFloat uniformRowHeight;
+
+/**
+ The height of a row, taken from the cell in column 0 of that row, or uniformRowHeight.
+ */
+- (CGFloat)heightForRow:(NSInteger)row;
+
+/**
+ The width of a column, taken from the cell in row 0 of that column unless the column has a fitted width.
+ */
+- (CGFloat)widthForColumn:(NSInteger)column;
+
+/**
+ The columns whose width was set with setFittedWidth:forColumn: instead of read from the data source. They follow their columns through inserts and deletes.
+ */
+@property (nonatomic, readonly) NSIndexSet *fittedColumns;
+
+/**
+ Replaces the width of a column with one measured from its content. reloadSizesForItemsAtIndexPaths: leaves it alone.
+ */
+- (void)setFittedWidth:(CGFloat)width forColumn:(NSInteger)column;
+
+/**
+ Goes back to the data source's width for a column.
+ */
+- (void)removeFittedWidthForColumn:(NSInteger)column;
+
+/**
+ The size of the cell at a data source index path.
+ */
+- (CGSize)sizeForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ Refreshes the counts and fetches sizes for just the inserted rows, then moves the merged cells past them. Indexes are relative to the data after the insertion.
+ */
+- (void)insertRows:(NSIndexSet *)rows;
+
+/**
+ Refreshes the counts and drops the sizes of the deleted rows, then moves the merged cells over them. Indexes are relative to the data before the deletion.
+ */
+- (void)deleteRows:(NSIndexSet *)rows;
+
+/**
+ Refreshes the counts and fetches sizes for just the inserted columns, then moves the merged cells past them. Indexes are relative to the data after the insertion.
+ */
+- (void)insertColumns:(NSIndexSet *)columns;
+
+/**
+ Refreshes the counts and drops the sizes of the deleted columns, then moves the merged cells over them. Indexes are relative to the data before the deletion.
+ */
+- (void)deleteColumns:(NSIndexSet *)columns;
+
+/**
+ Re-fetches the sizes that the given data source index paths contribute to the row and column tables, except for fitted column widths.
+ */
+- (void)reloadSizesForItemsAtIndexPaths:(NSArray *)indexPaths;
+
+@end
@@ -0,0 +1,284 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "MMSpreadsheetDataSnapshot.h"
+#import <QuartzCore/QuartzCore.h>
+#import "MMSpreadsheetView.h"
+#import "MMSpreadsheetMergedCells.h"
+#import "NSIndexPath+MMSpreadsheetView.h"
+
+const static CGFloat MMSpreadsheetDataSnapshotDefaultItemSize = 120.0f;
+
+@interface MMSpreadsheetDataSnapshot ()
+
+@property (nonatomic, weak) MMSpreadsheetView *spreadsheetView;
+@property (nonatomic, weak) id<MMSpreadsheetViewDataSource> dataSource;
+@property (nonatomic, assign) NSInteger rowCount;
+@property (nonatomic, assign) NSInteger columnCount;
+@property (nonatomic, assign) NSUInteger headerRowCount;
+@property (nonatomic, assign) NSUInteger headerColumnCount;
+@property (nonatomic, assign) CGFloat uniformRowHeight;
+// Nil while every row has uniformRowHeight.
+@property (nonatomic, strong) NSMutableData *rowHeights;
+@property (nonatomic, strong) NSMutableData *columnWidths;
+@property (nonatomic, strong) NSMutableIndexSet *fittedColumnIndexes;
+@property (nonatomic, strong) MMSpreadsheetMergedCells *mergedCells;
+
+@end
+
+// Copies a size table with a slot for each of indexes, which are relative to the new table, filled by fetch.
+// Runs between the inserted indexes are copied whole, so it is one pass however many indexes there are.
+static NSMutableData *MMSpreadsheetDataSnapshotSizesByInserting(NSData *sizes, NSIndexSet *indexes, CGFloat (^fetch)(NSUInteger index))
+{
+    NSUInteger count = [sizes length] / sizeof(CGFloat);
+    NSCParameterAssert([indexes count] == 0 || [indexes lastIndex] < count + [indexes count]);
+    NSMutableData *newSizes = [NSMutableData dataWithLength:(count + [indexes count]) * sizeof(CGFloat)];
+    const CGFloat *oldValues = sizes.bytes;
+    CGFloat *newValues = newSizes.mutableBytes;
+    __block NSUInteger copiedCount = 0;
+    __block NSUInteger position = 0;
+    [indexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        NSUInteger runLength = range.location - position;
+        memcpy(newValues + position, oldValues + copiedCount, runLength * sizeof(CGFloat));
+        copiedCount += runLength;
+        for (NSUInteger index = range.location; index < NSMaxRange(range); index++) {
+            newValues[index] = fetch(index);
+        }
+        position = NSMaxRange(range);
+    }];
+    memcpy(newValues + position, oldValues + copiedCount, (count - copiedCount) * sizeof(CGFloat));
+    return newSizes;
+}
+
+// Copies a size table without the slots at indexes, which are relative to the old table, in one pass.
+static NSMutableData *MMSpreadsheetDataSnapshotSizesByDeleting(NSData *sizes, NSIndexSet *indexes)
+{
+    NSUInteger count = [sizes length] / sizeof(CGFloat);
+    NSCParameterAssert([indexes count] == 0 || [indexes lastIndex] < count);
+    NSMutableData *newSizes = [NSMutableData dataWithLength:(count - [indexes count]) * sizeof(CGFloat)];
+    const CGFloat *oldValues = sizes.bytes;
+    CGFloat *newValues = newSizes.mutableBytes;
+    __block NSUInteger keptCount = 0;
+    __block NSUInteger position = 0;
+    [indexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        NSUInteger runLength = range.location - position;
+        memcpy(newValues + keptCount, oldValues + position, runLength * sizeof(CGFloat));
+        keptCount += runLength;
+        position = NSMaxRange(range);
+    }];
+    memcpy(newValues + keptCount, oldValues + position, (count - position) * sizeof(CGFloat));
+    return newSizes;
+}
+
+@implementation MMSpreadsheetDataSnapshot
+
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                             dataSource:(id<MMSpreadsheetViewDataSource>)dataSource
+                         headerRowCount:(NSUInteger)headerRowCount
+                      headerColumnCount:(NSUInteger)headerColumnCount
+{
+    self = [super init];
+    if (self) {
+        _spreadsheetView = spreadsheetView;
+        _dataSource = dataSource;
+        _headerRowCount = headerRowCount;
+        _headerColumnCount = headerColumnCount;
+        [self refreshCounts];
+        if ([dataSource respondsToSelector:@selector(uniformRowHeightInSpreadsheetView:)]) {
+            _uniformRowHeight = MAX([dataSource uniformRowHeightInSpreadsheetView:spreadsheetView], 0.0f);
+        }
+        _columnWidths = [NSMutableData dataWithLength:_columnCount * sizeof(CGFloat)];
+        _fittedColumnIndexes = [NSMutableIndexSet indexSet];
+
+        if (_uniformRowHeight == 0.0f) {
+            _rowHeights = [NSMutableData dataWithLength:_rowCount * sizeof(CGFloat)];
+            CGFloat *rowHeights = _rowHeights.mutableBytes;
+            for (NSInteger row = 0; row < _rowCount; row++) {
+                rowHeights[row] = [self fetchSizeForRow:row column:0].height;
+            }
+        }
+        CGFloat *columnWidths = _columnWidths.mutableBytes;
+        for (NSInteger column = 0; column < _columnCount; column++) {
+            columnWidths[column] = [self fetchSizeForRow:0 column:column].width;
+        }
+        [self loadMergedCells];
+    }
+    return self;
+}
+
+- (CGSize)fetchSizeForRow:(NSInteger)row column:(NSInteger)column
+{
+    if (![self.dataSource respondsToSelector:@selector(spreadsheetView:sizeForItemAtIndexPath:)]) {
+        return CGSizeMake(MMSpreadsheetDataSnapshotDefaultItemSize, MMSpreadsheetDataSnapshotDefaultItemSize);
+    }
+    NSIndexPath *indexPath = [NSIndexPath indexPathForItem:column inSection:row];
+    CFTimeInterval startTime = CACurrentMediaTime();
+    CGSize size = [self.dataSource spreadsheetView:self.spreadsheetView sizeForItemAtIndexPath:indexPath];
+    [self.spreadsheetView.metrics recordDuration:CACurrentMediaTime() - startTime forDataSourceCallback:MMSpreadsheetViewDataSourceCallbackSizeForItem];
+    return size;
+}
+
+- (void)loadMergedCells
+{
+    if (![self.dataSource respondsToSelector:@selector(numberOfMergedCellsInSpreadsheetView:)] ||
+        ![self.dataSource respondsToSelector:@selector(spreadsheetView:mergedCellAtIndex:)]) {
+        self.mergedCells = nil;
+        return;
+    }
+    NSInteger count = [self.dataSource numberOfMergedCellsInSpreadsheetView:self.spreadsheetView];
+    NSMutableData *spanData = [NSMutableData dataWithLength:MAX(count, 0) * sizeof(MMGridSpan)];
+    MMGridSpan *spans = spanData.mutableBytes;
+    MMGridRange rows = { 0, self.rowCount };
+    MMGridRange columns = { 0, self.columnCount };
+    NSInteger spanCount = 0;
+    for (NSInteger index = 0; index < count; index++) {
+        MMGridSpan span = [self.dataSource spreadsheetView:self.spreadsheetView mergedCellAtIndex:index];
+        if (MMGridSpanClip(span, rows, columns, &spans[spanCount])) {
+            spanCount++;
+        }
+    }
+    self.mergedCells = [[MMSpreadsheetMergedCells alloc] initWithSpans:spans count:spanCount];
+}
+
+#pragma mark - Sizes
+
+- (CGFloat)heightForRow:(NSInteger)row
+{
+    NSParameterAssert(row >= 0 && row < self.rowCount);
+    if (self.rowHeights == nil) {
+        return self.uniformRowHeight;
+    }
+    const CGFloat *rowHeights = self.rowHeights.bytes;
+    return rowHeights[row];
+}
+
+- (CGFloat)widthForColumn:(NSInteger)column
+{
+    NSParameterAssert(column >= 0 && column < self.columnCount);
+    const CGFloat *columnWidths = self.columnWidths.bytes;
+    return columnWidths[column];
+}
+
+- (CGSize)sizeForItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    return CGSizeMake([self widthForColumn:indexPath.mmSpreadsheetColumn], [self heightForRow:indexPath.mmSpreadsheetRow]);
+}
+
+- (NSIndexSet *)fittedColumns
+{
+    return [self.fittedColumnIndexes copy];
+}
+
+- (void)setFittedWidth:(CGFloat)width forColumn:(NSInteger)column
+{
+    NSParameterAssert(column >= 0 && column < self.columnCount);
+    CGFloat *columnWidths = self.columnWidths.mutableBytes;
+    columnWidths[column] = width;
+    [self.fittedColumnIndexes addIndex:column];
+}
+
+- (void)removeFittedWidthForColumn:(NSInteger)column
+{
+    if (![self.fittedColumnIndexes containsIndex:column]) {
+        return;
+    }
+    [self.fittedColumnIndexes removeIndex:column];
+    CGFloat *columnWidths = self.columnWidths.mutableBytes;
+    columnWidths[column] = [self fetchSizeForRow:0 column:column].width;
+}
+
+#pragma mark - Updates
+
+- (void)refreshCounts
+{
+    MMSpreadsheetViewMetrics *metrics = self.spreadsheetView.metrics;
+    CFTimeInterval startTime = CACurrentMediaTime();
+    self.rowCount = [self.dataSource numberOfRowsInSpreadsheetView:self.spreadsheetView];
+    CFTimeInterval midTime = CACurrentMediaTime();
+    self.columnCount = [self.dataSource numberOfColumnsInSpreadsheetView:self.spreadsheetView];
+    [metrics recordDuration:midTime - startTime forDataSourceCallback:MMSpreadsheetViewDataSourceCallbackNumberOfRows];
+    [metrics recordDuration:CACurrentMediaTime() - midTime forDataSourceCallback:MMSpreadsheetViewDataSourceCallbackNumberOfColumns];
+}
+
+- (void)insertRows:(NSIndexSet *)rows
+{
+    [self refreshCounts];
+    if (self.rowHeights) {
+        self.rowHeights = MMSpreadsheetDataSnapshotSizesByInserting(self.rowHeights, rows, ^CGFloat(NSUInteger row) {
+            return [self fetchSizeForRow:row column:0].height;
+        });
+        NSAssert([self.rowHeights length] == self.rowCount * sizeof(CGFloat), @"Row count does not match the inserted rows.");
+    }
+    // Merged cells are only read again by reloadData, so a streaming data source does not re-read them for every batch.
+    self.mergedCells = [self.mergedCells mergedCellsByInsertingRows:rows columns:nil];
+}
+
+- (void)deleteRows:(NSIndexSet *)rows
+{
+    [self refreshCounts];
+    if (self.rowHeights) {
+        self.rowHeights = MMSpreadsheetDataSnapshotSizesByDeleting(self.rowHeights, rows);
+        NSAssert([self.rowHeights length] == self.rowCount * sizeof(CGFloat), @"Row count does not match the deleted rows.");
+    }
+    self.mergedCells = [self.mergedCells mergedCellsByDeletingRows:rows columns:nil];
+}
+
+- (void)insertColumns:(NSIndexSet *)columns
+{
+    [self refreshCounts];
+    self.columnWidths = MMSpreadsheetDataSnapshotSizesByInserting(self.columnWidths, columns, ^CGFloat(NSUInteger column) {
+        return [self fetchSizeForRow:0 column:column].width;
+    });
+    NSAssert([self.columnWidths length] == self.columnCount * sizeof(CGFloat), @"Column count does not match the inserted columns.");
+    [columns enumerateIndexesUsingBlock:^(NSUInteger column, BOOL *stop) {
+        [self.fittedColumnIndexes shiftIndexesStartingAtIndex:column by:1];
+    }];
+    self.mergedCells = [self.mergedCells mergedCellsByInsertingRows:nil columns:columns];
+}
+
+- (void)deleteColumns:(NSIndexSet *)columns
+{
+    [self refreshCounts];
+    self.columnWidths = MMSpreadsheetDataSnapshotSizesByDeleting(self.columnWidths, columns);
+    NSAssert([self.columnWidths length] == self.columnCount * sizeof(CGFloat), @"Column count does not match the deleted columns.");
+    [columns enumerateIndexesWithOptions:NSEnumerationReverse usingBlock:^(NSUInteger column, BOOL *stop) {
+        [self.fittedColumnIndexes removeIndex:column];
+        [self.fittedColumnIndexes shiftIndexesStartingAtIndex:column + 1 by:-1];
+    }];
+    self.mergedCells = [self.mergedCells mergedCellsByDeletingRows:nil columns:columns];
+}
+
+- (void)reloadSizesForItemsAtIndexPaths:(NSArray *)indexPaths
+{
+    CGFloat *rowHeights = self.rowHeights.mutableBytes;
+    CGFloat *columnWidths = self.columnWidths.mutableBytes;
+    for (NSIndexPath *indexPath in indexPaths) {
+        NSInteger row = indexPath.mmSpreadsheetRow;
+        NSInteger column = indexPath.mmSpreadsheetColumn;
+        if (column == 0 && rowHeights) {
+            rowHeights[row] = [self fetchSizeForRow:row column:0].height;
+        }
+        if (row == 0 && ![self.fittedColumnIndexes containsIndex:column]) {
+            columnWidths[column] = [self fetchSizeForRow:0 column:column].width;
+        }
+    }
+}
+
+@end
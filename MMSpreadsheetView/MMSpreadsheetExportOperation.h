@@ -0,0 +1,88 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import <Foundation/Foundation.h>
+
+@class MMSpreadsheetView;
+@class MMSpreadsheetRowOrder;
+@protocol MMSpreadsheetViewValueDataSource;
+
+extern NSString *const MMSpreadsheetExportErrorDomain;
+
+typedef NS_ENUM(NSInteger, MMSpreadsheetExportError)
+{
+    MMSpreadsheetExportErrorWriteFailed = 1,
+};
+
+typedef NS_ENUM(NSUInteger, MMSpreadsheetExportFormat)
+{
+    MMSpreadsheetExportFormatCSV = 0,
+    MMSpreadsheetExportFormatTSV,
+};
+
+/**
+ Receives the exported text one chunk of UTF-8 at a time. Return NO and set `error` to stop the export.
+ */
+typedef BOOL (^MMSpreadsheetExportWriter)(NSData *chunk, NSError **error);
+
+/**
+ `MMSpreadsheetExportOperation` writes a rectangle of cells as CSV or TSV text, in chunks, without blocking the main thread.
+ 
+ Cell text comes from a value data source, so the export never touches cells. Rows are read a chunk at a time inside their own autorelease pool, turned into text and handed to the writer, so memory stays flat however large the rectangle is. Run the operation on a background queue; `MMSpreadsheetView` does this for you with exportRows:columns:format:toFileHandle:progress:completion: and copyRows:columns:format:toPasteboard:progress:completion:.
+ 
+ CSV follows RFC 4180: fields holding a comma, quote or line break are quoted and lines end in CRLF. TSV has no quoting, so tabs and line breaks inside fields are replaced with spaces and lines end in LF.
+ */
+@interface MMSpreadsheetExportOperation : NSOperation
+
+/**
+ Creates an export of a rectangle of cells.
+ 
+ @param spreadsheetView The spreadsheet view passed to the value data source. The operation keeps a weak reference.
+ @param valueDataSource Supplies the text of each cell. It is called on the operation's thread.
+ @param rows The display rows to export, already clipped to the grid.
+ @param columns The columns to export, already clipped to the grid.
+ @param rowOrder The order rows are displayed in, or nil for data source order.
+ @param format The text format to write.
+ @param writer Receives each chunk on the operation's thread.
+ 
+ @return An operation that has not started.
+ */
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                        valueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+                                   rows:(NSRange)rows
+                                columns:(NSRange)columns
+                               rowOrder:(MMSpreadsheetRowOrder *)rowOrder
+                                 format:(MMSpreadsheetExportFormat)format
+                                 writer:(MMSpreadsheetExportWriter)writer;
+
+@property (nonatomic, readonly) NSRange rows;
+@property (nonatomic, readonly) NSRange columns;
+@property (nonatomic, readonly) MMSpreadsheetExportFormat format;
+
+/**
+ Called on the main thread with the fraction of rows written, at most a few times a second.
+ */
+@property (nonatomic, copy) void (^progressBlock)(double fractionCompleted);
+
+/**
+ Called once on the main thread when the operation ends. `finished` is NO if the operation was cancelled or the writer failed, and `error` is the writer's error, if any.
+ */
+@property (nonatomic, copy) void (^exportCompletionBlock)(BOOL finished, NSError *error);
+
+@end
@@ -0,0 +1,211 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import "MMSpreadsheetExportOperation.h"
+#import <QuartzCore/QuartzCore.h>
+#import "MMSpreadsheetView.h"
+#import "MMSpreadsheetRowOrder.h"
+
+NSString *const MMSpreadsheetExportErrorDomain = @"MMSpreadsheetExportErrorDomain";
+
+// Enough cells that the writer is called rarely, few enough that a chunk's text stays small.
+const static NSInteger MMSpreadsheetExportCellsPerChunk = 16384;
+const static CFTimeInterval MMSpreadsheetExportProgressInterval = 0.2;
+
+@interface MMSpreadsheetExportOperation ()
+
+@property (nonatomic, weak) MMSpreadsheetView *spreadsheetView;
+@property (nonatomic, strong) id<MMSpreadsheetViewValueDataSource> valueDataSource;
+@property (nonatomic, strong) MMSpreadsheetRowOrder *rowOrder;
+@property (nonatomic, copy) MMSpreadsheetExportWriter writer;
+@property (nonatomic, assign) NSRange rows;
+@property (nonatomic, assign) NSRange columns;
+@property (nonatomic, assign) MMSpreadsheetExportFormat format;
+
+@property (nonatomic, assign) BOOL exportFinished;
+@property (nonatomic, strong) NSError *exportError;
+
+@end
+
+@implementation MMSpreadsheetExportOperation
+
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                        valueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+                                   rows:(NSRange)rows
+                                columns:(NSRange)columns
+                               rowOrder:(MMSpreadsheetRowOrder *)rowOrder
+                                 format:(MMSpreadsheetExportFormat)format
+                                 writer:(MMSpreadsheetExportWriter)writer
+{
+    NSParameterAssert(valueDataSource);
+    NSParameterAssert(writer);
+    self = [super init];
+    if (self) {
+        _spreadsheetView = spreadsheetView;
+        _valueDataSource = valueDataSource;
+        _rows = rows;
+        _columns = columns;
+        _rowOrder = rowOrder;
+        _format = format;
+        _writer = [writer copy];
+    }
+    return self;
+}
+
+- (void)start
+{
+    // A cancelled operation finishes without running main, but its completion block is still owed a call.
+    MMSpreadsheetExportOperation *strongSelf = self;
+    [super start];
+    [strongSelf reportCompletion];
+}
+
+- (void)main
+{
+    NSInteger rowsPerChunk = MAX(MMSpreadsheetExportCellsPerChunk / MAX((NSInteger)self.columns.length, 1), 1);
+    NSInteger rowCount = self.rows.length;
+    CFTimeInterval lastProgressTime = CACurrentMediaTime();
+    NSError *error = nil;
+    BOOL finished = YES;
+
+    for (NSInteger chunkStart = 0; chunkStart < rowCount; chunkStart += rowsPerChunk) {
+        if (self.isCancelled) {
+            finished = NO;
+            break;
+        }
+        NSInteger chunkEnd = MIN(chunkStart + rowsPerChunk, rowCount);
+        @autoreleasepool {
+            NSError *writeError = nil;
+            NSData *chunk = [self textForRows:NSMakeRange(self.rows.location + chunkStart, chunkEnd - chunkStart)];
+            if (!self.writer(chunk, &writeError)) {
+                // Copied out of the pool, which would otherwise release it.
+                error = writeError;
+                finished = NO;
+            }
+        }
+        if (!finished) {
+            break;
+        }
+
+        CFTimeInterval now = CACurrentMediaTime();
+        if (now - lastProgressTime >= MMSpreadsheetExportProgressInterval && chunkEnd < rowCount) {
+            lastProgressTime = now;
+            [self reportProgress:(double)chunkEnd / rowCount];
+        }
+    }
+
+    self.exportFinished = finished && !self.isCancelled;
+    self.exportError = error;
+}
+
+#pragma mark - Formatting
+
+- (NSData *)textForRows:(NSRange)rows
+{
+    NSString *fieldSeparator = self.format == MMSpreadsheetExportFormatCSV ? @"," : @"\t";
+    NSString *lineSeparator = self.format == MMSpreadsheetExportFormatCSV ? @"\r\n" : @"\n";
+    NSMutableString *text = [NSMutableString string];
+    MMSpreadsheetView *spreadsheetView = self.spreadsheetView;
+
+    for (NSUInteger row = rows.location; row < NSMaxRange(rows); row++) {
+        NSInteger dataRow = self.rowOrder ? [self.rowOrder dataRowForDisplayRow:row] : row;
+        for (NSUInteger column = self.columns.location; column < NSMaxRange(self.columns); column++) {
+            if (column > self.columns.location) {
+                [text appendString:fieldSeparator];
+            }
+            NSIndexPath *indexPath = [NSIndexPath indexPathForItem:column inSection:dataRow];
+            MMSpreadsheetCellValue *value = [self.valueDataSource spreadsheetView:spreadsheetView valueForItemAtIndexPath:indexPath];
+            [self appendField:value.text toText:text];
+        }
+        [text appendString:lineSeparator];
+    }
+    return [text dataUsingEncoding:NSUTF8StringEncoding];
+}
+
+- (void)appendField:(NSString *)field toText:(NSMutableString *)text
+{
+    if ([field length] == 0) {
+        return;
+    }
+
+    switch (self.format) {
+        case MMSpreadsheetExportFormatCSV: {
+            static NSCharacterSet *quotedCharacters = nil;
+            static dispatch_once_t onceToken;
+            dispatch_once(&onceToken, ^{
+                quotedCharacters = [NSCharacterSet characterSetWithCharactersInString:@",\"\r\n"];
+            });
+            if ([field rangeOfCharacterFromSet:quotedCharacters].location == NSNotFound) {
+                [text appendString:field];
+            }
+            else {
+                [text appendString:@"\""];
+                [text appendString:[field stringByReplacingOccurrencesOfString:@"\"" withString:@"\"\""]];
+                [text appendString:@"\""];
+            }
+            break;
+        }
+        case MMSpreadsheetExportFormatTSV: {
+            static NSCharacterSet *replacedCharacters = nil;
+            static dispatch_once_t onceToken;
+            dispatch_once(&onceToken, ^{
+                replacedCharacters = [NSCharacterSet characterSetWithCharactersInString:@"\t\r\n"];
+            });
+            if ([field rangeOfCharacterFromSet:replacedCharacters].location == NSNotFound) {
+                [text appendString:field];
+            }
+            else {
+                [text appendString:[[field componentsSeparatedByCharactersInSet:replacedCharacters] componentsJoinedByString:@" "]];
+            }
+            break;
+        }
+        default:
+            NSAssert(NO, @"What have you done?");
+            break;
+    }
+}
+
+#pragma mark - Reporting
+
+- (void)reportProgress:(double)fractionCompleted
+{
+    void (^progressBlock)(double) = self.progressBlock;
+    if (progressBlock) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            progressBlock(fractionCompleted);
+        });
+    }
+}
+
+- (void)reportCompletion
+{
+    void (^exportCompletionBlock)(BOOL, NSError *) = self.exportCompletionBlock;
+    BOOL finished = self.exportFinished;
+    NSError *error = self.exportError;
+    if (finished) {
+        [self reportProgress:1.0];
+    }
+    if (exportCompletionBlock) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            exportCompletionBlock(finished, error);
+        });
+    }
+}
+
+@end
@@ -0,0 +1,81 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import <Foundation/Foundation.h>
+#import "MMGridGeometry.h"
+
+/**
+ `MMSpreadsheetMergedCells` holds the merged cells of a spreadsheet view, indexed so the ones in a block of cells are found without looking at the rest.
+ 
+ Merged cells are immutable once created, so they can be read from any thread, including the tile renderers.
+ */
+@interface MMSpreadsheetMergedCells : NSObject
+
+/**
+ Indexes a copy of the given spans.
+ 
+ @param spans The merged cells, which must not overlap. Spans with no rows or no columns are dropped.
+ @param count The number of spans.
+ 
+ @return The indexed merged cells, or nil if the index could not be allocated.
+ */
+- (instancetype)initWithSpans:(const MMGridSpan *)spans count:(NSInteger)count;
+
+/**
+ The number of merged cells.
+ */
+@property (nonatomic, readonly) NSInteger count;
+
+/**
+ Calls a block with each merged cell that intersects a block of cells, in order of first row.
+ */
+- (void)enumerateSpansInRows:(NSRange)rows columns:(NSRange)columns usingBlock:(void (^)(MMGridSpan span, BOOL *stop))block;
+
+/**
+ Finds the merged cell covering a cell.
+ 
+ @param span Set to the merged cell, if there is one.
+ @param row The row of the cell.
+ @param column The column of the cell.
+ 
+ @return YES if a merged cell covers the cell.
+ */
+- (BOOL)getSpan:(MMGridSpan *)span containingRow:(NSInteger)row column:(NSInteger)column;
+
+/**
+ The merged cells after rows and columns are inserted, without asking the data source for them again.
+ 
+ @param rows The inserted rows, relative to the data after the insertion, or nil.
+ @param columns The inserted columns, relative to the data after the insertion, or nil.
+ 
+ @return New merged cells with every span moved past the inserted rows and columns before it. A span that an insertion falls inside grows to cover it.
+ */
+- (instancetype)mergedCellsByInsertingRows:(NSIndexSet *)rows columns:(NSIndexSet *)columns;
+
+/**
+ The merged cells after rows and columns are deleted, without asking the data source for them again.
+ 
+ @param rows The deleted rows, relative to the data before the deletion, or nil.
+ @param columns The deleted columns, relative to the data before the deletion, or nil.
+ 
+ @return New merged cells with every span moved back over the deleted rows and columns before it and shrunk by the ones inside it. Spans left with no rows or no columns are dropped.
+ */
+- (instancetype)mergedCellsByDeletingRows:(NSIndexSet *)rows columns:(NSIndexSet *)columns;
+
+@end
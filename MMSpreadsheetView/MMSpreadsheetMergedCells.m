@@ -0,0 +1,151 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import "MMSpreadsheetMergedCells.h"
+
+static int MMSpreadsheetMergedCellsVisit(const MMGridSpan *span, void *context)
+{
+    void (^block)(MMGridSpan, BOOL *) = (__bridge void (^)(MMGridSpan, BOOL *))context;
+    BOOL stop = NO;
+    block(*span, &stop);
+    return stop;
+}
+
+static int MMSpreadsheetMergedCellsFirst(const MMGridSpan *span, void *context)
+{
+    *(MMGridSpan *)context = *span;
+    return 1;
+}
+
+// Where an index ends up once indexes, which are relative to the data after the insertion, are inserted.
+static long MMSpreadsheetMergedCellsIndexAfterInserting(NSIndexSet *indexes, long index)
+{
+    __block long newIndex = index;
+    [indexes enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        if ((long)range.location > newIndex) {
+            *stop = YES;
+            return;
+        }
+        newIndex += range.length;
+    }];
+    return newIndex;
+}
+
+// Moves a run of indexes, such as a span's rows, for an insertion. An insertion inside the run lengthens it.
+static void MMSpreadsheetMergedCellsInsert(NSIndexSet *indexes, long *start, long *length)
+{
+    if ([indexes count] == 0 || *length <= 0) {
+        return;
+    }
+    long newStart = MMSpreadsheetMergedCellsIndexAfterInserting(indexes, *start);
+    long newEnd = MMSpreadsheetMergedCellsIndexAfterInserting(indexes, *start + *length - 1) + 1;
+    *start = newStart;
+    *length = newEnd - newStart;
+}
+
+// Moves a run of indexes for a deletion, relative to the data before it. A deletion inside the run shortens it.
+static void MMSpreadsheetMergedCellsDelete(NSIndexSet *indexes, long *start, long *length)
+{
+    if ([indexes count] == 0 || *length <= 0) {
+        return;
+    }
+    long deletedBefore = (long)[indexes countOfIndexesInRange:NSMakeRange(0, *start)];
+    long deletedInside = (long)[indexes countOfIndexesInRange:NSMakeRange(*start, *length)];
+    *start -= deletedBefore;
+    *length -= deletedInside;
+}
+
+@implementation MMSpreadsheetMergedCells
+{
+    MMGridSpanIndex _index;
+}
+
+- (instancetype)initWithSpans:(const MMGridSpan *)spans count:(NSInteger)count
+{
+    self = [super init];
+    if (self) {
+        MMGridSpanIndexInit(&_index);
+        if (!MMGridSpanIndexBuild(&_index, spans, count)) {
+            return nil;
+        }
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    MMGridSpanIndexFree(&_index);
+}
+
+- (NSInteger)count
+{
+    return _index.count;
+}
+
+- (instancetype)mergedCellsByInsertingRows:(NSIndexSet *)rows columns:(NSIndexSet *)columns
+{
+    NSMutableData *spanData = [NSMutableData dataWithBytes:_index.spans length:_index.count * sizeof(MMGridSpan)];
+    MMGridSpan *spans = spanData.mutableBytes;
+    for (long i = 0; i < _index.count; i++) {
+        MMSpreadsheetMergedCellsInsert(rows, &spans[i].row, &spans[i].rowCount);
+        MMSpreadsheetMergedCellsInsert(columns, &spans[i].column, &spans[i].columnCount);
+    }
+    return [[MMSpreadsheetMergedCells alloc] initWithSpans:spans count:_index.count];
+}
+
+- (instancetype)mergedCellsByDeletingRows:(NSIndexSet *)rows columns:(NSIndexSet *)columns
+{
+    NSMutableData *spanData = [NSMutableData dataWithBytes:_index.spans length:_index.count * sizeof(MMGridSpan)];
+    MMGridSpan *spans = spanData.mutableBytes;
+    for (long i = 0; i < _index.count; i++) {
+        MMSpreadsheetMergedCellsDelete(rows, &spans[i].row, &spans[i].rowCount);
+        MMSpreadsheetMergedCellsDelete(columns, &spans[i].column, &spans[i].columnCount);
+    }
+    return [[MMSpreadsheetMergedCells alloc] initWithSpans:spans count:_index.count];
+}
+
+- (void)enumerateSpansInRows:(NSRange)rows columns:(NSRange)columns usingBlock:(void (^)(MMGridSpan span, BOOL *stop))block
+{
+    if (_index.count == 0) {
+        return;
+    }
+    MMGridRange gridRows = { rows.location, rows.length };
+    MMGridRange gridColumns = { columns.location, columns.length };
+    MMGridSpanIndexQuery(&_index, gridRows, gridColumns, MMSpreadsheetMergedCellsVisit, (__bridge void *)block);
+}
+
+- (BOOL)getSpan:(MMGridSpan *)span containingRow:(NSInteger)row column:(NSInteger)column
+{
+    if (_index.count == 0) {
+        return NO;
+    }
+    // Merged cells do not overlap, so the first one found is the only one.
+    MMGridSpan found;
+    MMGridRange rows = { row, 1 };
+    MMGridRange columns = { column, 1 };
+    if (MMGridSpanIndexQuery(&_index, rows, columns, MMSpreadsheetMergedCellsFirst, &found) == 0) {
+        return NO;
+    }
+    if (span) {
+        *span = found;
+    }
+    return YES;
+}
+
+@end
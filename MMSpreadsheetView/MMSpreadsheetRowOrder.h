@@ -0,0 +1,107 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+/**
+ `MMSpreadsheetRowOrder` maps the rows a spreadsheet view displays to the rows of its data source, for sorting and filtering without moving any data.
+ 
+ The first fixedRowCount rows (the header rows) always map to themselves. The remaining display rows map to a permutation of the remaining data rows, or a subset of them when rows are filtered out. Both directions are table lookups.
+ 
+ Row orders are immutable, so they can be read from any thread. Sorting and filtering create a new order from an existing one on the calling thread, spreading the work over all cores with `dispatch_apply`. Call them from a background queue.
+ */
+@interface MMSpreadsheetRowOrder : NSObject
+
+/**
+ Creates the identity order, which displays every data row in data order.
+ 
+ @param dataRowCount The number of rows in the data source.
+ @param fixedRowCount The number of leading rows that are never moved or filtered.
+ 
+ @return A row order, or nil if its tables could not be allocated.
+ */
+- (instancetype)initWithDataRowCount:(NSInteger)dataRowCount fixedRowCount:(NSInteger)fixedRowCount;
+
+/**
+ The number of rows in the data source.
+ */
+@property (nonatomic, readonly) NSInteger dataRowCount;
+
+/**
+ The number of rows displayed, including the fixed rows.
+ */
+@property (nonatomic, readonly) NSInteger rowCount;
+
+/**
+ The number of leading rows that map to themselves.
+ */
+@property (nonatomic, readonly) NSInteger fixedRowCount;
+
+/**
+ The data row shown at a display row.
+ */
+- (NSInteger)dataRowForDisplayRow:(NSInteger)row;
+
+/**
+ The display row of a data row, or NSNotFound if it is filtered out.
+ */
+- (NSInteger)displayRowForDataRow:(NSInteger)row;
+
+/**
+ Sorts the displayed rows after the fixed rows.
+ 
+ @param key Returns the sort key of a data row. It is called once per row, concurrently on several threads.
+ @param comparator Compares two keys, or nil to use `compare:`. nil keys sort last.
+ @param cancelled Polled between rows and between passes. Return YES to abandon the sort.
+ 
+ @return A new order, or nil if the sort was cancelled. The sort is stable, so equal keys keep their current relative order.
+ */
+- (instancetype)rowOrderSortedByKey:(id (^)(NSInteger row))key comparator:(NSComparator)comparator cancelled:(BOOL (^)(void))cancelled;
+
+/**
+ Filters the displayed rows after the fixed rows.
+ 
+ @param predicate Returns YES to keep a data row. It is called once per displayed row, concurrently on several threads.
+ @param cancelled Polled between rows. Return YES to abandon the filter.
+ 
+ @return A new order with the kept rows in their current order, or nil if the filter was cancelled.
+ */
+- (instancetype)rowOrderFilteredByPredicate:(BOOL (^)(NSInteger row))predicate cancelled:(BOOL (^)(void))cancelled;
+
+/**
+ Follows rows inserted into the data source. Inserted rows are displayed at the end, unsorted and unfiltered.
+ 
+ @param rows The inserted data rows, relative to the data after the insertion. None may be a fixed row.
+ */
+- (instancetype)rowOrderByInsertingDataRows:(NSIndexSet *)rows;
+
+/**
+ Follows rows deleted from the data source.
+ 
+ @param rows The deleted data rows, relative to the data before the deletion. None may be a fixed row.
+ */
+- (instancetype)rowOrderByDeletingDataRows:(NSIndexSet *)rows;
+
+/**
+ The display rows of the given data rows, leaving out any that are filtered out.
+ */
+- (NSIndexSet *)displayRowsForDataRows:(NSIndexSet *)rows;
+
+@end
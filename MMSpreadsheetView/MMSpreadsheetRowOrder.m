@@ -0,0 +1,341 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "MMSpreadsheetRowOrder.h"
+
+// Below this many rows per chunk, spreading the work over threads costs more than it saves.
+const static NSInteger MMSpreadsheetRowOrderMinimumChunkLength = 4096;
+const static NSInteger MMSpreadsheetRowOrderRowsPerPoll = 1024;
+
+static size_t MMSpreadsheetRowOrderChunkCount(NSInteger count)
+{
+    // A few chunks per core evens out rows whose keys are slower to compute.
+    NSInteger chunkCount = MIN((NSInteger)[[NSProcessInfo processInfo] activeProcessorCount] * 4,
+                               count / MMSpreadsheetRowOrderMinimumChunkLength);
+    return MAX(chunkCount, 1);
+}
+
+static void MMSpreadsheetRowOrderMerge(const NSInteger *source, NSInteger low, NSInteger middle, NSInteger high,
+                                       NSInteger *destination, int (^compare)(const void *, const void *))
+{
+    NSInteger left = low;
+    NSInteger right = middle;
+    NSInteger index = low;
+    while (left < middle && right < high) {
+        destination[index++] = compare(&source[right], &source[left]) < 0 ? source[right++] : source[left++];
+    }
+    memcpy(destination + index, source + left, (middle - left) * sizeof(NSInteger));
+    index += middle - left;
+    memcpy(destination + index, source + right, (high - right) * sizeof(NSInteger));
+}
+
+@interface MMSpreadsheetRowOrder ()
+
+@property (nonatomic, assign) NSInteger dataRowCount;
+@property (nonatomic, assign) NSInteger rowCount;
+@property (nonatomic, assign) NSInteger fixedRowCount;
+
+// The data row of each display row after the fixed rows.
+@property (nonatomic, strong) NSData *bodyRows;
+
+// The display row of each data row, or -1 if it is filtered out.
+@property (nonatomic, strong) NSData *displayRows;
+
+@end
+
+@implementation MMSpreadsheetRowOrder
+
+- (instancetype)initWithDataRowCount:(NSInteger)dataRowCount fixedRowCount:(NSInteger)fixedRowCount
+{
+    fixedRowCount = MAX(MIN(fixedRowCount, dataRowCount), 0);
+    NSMutableData *bodyRows = [NSMutableData dataWithLength:(dataRowCount - fixedRowCount) * sizeof(NSInteger)];
+    NSInteger *rows = bodyRows.mutableBytes;
+    for (NSInteger row = fixedRowCount; row < dataRowCount; row++) {
+        rows[row - fixedRowCount] = row;
+    }
+    return [self initWithDataRowCount:dataRowCount fixedRowCount:fixedRowCount bodyRows:bodyRows];
+}
+
+- (instancetype)initWithDataRowCount:(NSInteger)dataRowCount fixedRowCount:(NSInteger)fixedRowCount bodyRows:(NSData *)bodyRows
+{
+    self = [super init];
+    if (self) {
+        NSInteger bodyRowCount = [bodyRows length] / sizeof(NSInteger);
+        _dataRowCount = dataRowCount;
+        _fixedRowCount = fixedRowCount;
+        _rowCount = fixedRowCount + bodyRowCount;
+        _bodyRows = bodyRows;
+
+        NSMutableData *displayRows = [NSMutableData dataWithLength:dataRowCount * sizeof(NSInteger)];
+        if (bodyRows == nil || displayRows == nil) {
+            return nil;
+        }
+        NSInteger *displayRowForDataRow = displayRows.mutableBytes;
+        if (dataRowCount > 0) {
+            memset(displayRowForDataRow, 0xff, dataRowCount * sizeof(NSInteger));
+        }
+        for (NSInteger row = 0; row < fixedRowCount; row++) {
+            displayRowForDataRow[row] = row;
+        }
+        const NSInteger *rows = bodyRows.bytes;
+        for (NSInteger row = 0; row < bodyRowCount; row++) {
+            displayRowForDataRow[rows[row]] = fixedRowCount + row;
+        }
+        _displayRows = displayRows;
+    }
+    return self;
+}
+
+#pragma mark - Mapping
+
+- (NSInteger)dataRowForDisplayRow:(NSInteger)row
+{
+    NSParameterAssert(row >= 0 && row < self.rowCount);
+    if (row < self.fixedRowCount) {
+        return row;
+    }
+    const NSInteger *rows = self.bodyRows.bytes;
+    return rows[row - self.fixedRowCount];
+}
+
+- (NSInteger)displayRowForDataRow:(NSInteger)row
+{
+    NSParameterAssert(row >= 0 && row < self.dataRowCount);
+    const NSInteger *displayRows = self.displayRows.bytes;
+    return displayRows[row] < 0 ? NSNotFound : displayRows[row];
+}
+
+- (NSIndexSet *)displayRowsForDataRows:(NSIndexSet *)rows
+{
+    NSMutableIndexSet *displayRows = [NSMutableIndexSet indexSet];
+    [rows enumerateIndexesUsingBlock:^(NSUInteger row, BOOL *stop) {
+        NSInteger displayRow = [self displayRowForDataRow:row];
+        if (displayRow != NSNotFound) {
+            [displayRows addIndex:displayRow];
+        }
+    }];
+    return displayRows;
+}
+
+#pragma mark - Sorting & Filtering
+
+- (instancetype)rowOrderSortedByKey:(id (^)(NSInteger row))key comparator:(NSComparator)comparator cancelled:(BOOL (^)(void))cancelled
+{
+    NSParameterAssert(key);
+    if (comparator == nil) {
+        comparator = ^NSComparisonResult(id left, id right) {
+            return [left compare:right];
+        };
+    }
+
+    NSInteger count = self.rowCount - self.fixedRowCount;
+    const NSInteger *rows = self.bodyRows.bytes;
+    size_t chunkCount = MMSpreadsheetRowOrderChunkCount(count);
+    NSInteger chunkLength = (count + chunkCount - 1) / chunkCount;
+    void **keys = calloc(MAX(count, 1), sizeof(void *));
+    NSInteger *positions = malloc(MAX(count, 1) * sizeof(NSInteger));
+    NSInteger *buffer = malloc(MAX(count, 1) * sizeof(NSInteger));
+    if (keys == NULL || positions == NULL || buffer == NULL) {
+        free(keys);
+        free(positions);
+        free(buffer);
+        return nil;
+    }
+
+    // Keys are computed once each, in parallel. They are retained by hand since ARC does not manage C arrays.
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+    dispatch_apply(chunkCount, queue, ^(size_t chunk) {
+        NSInteger start = chunk * chunkLength;
+        NSInteger end = MIN(start + chunkLength, count);
+        for (NSInteger pollStart = start; pollStart < end && !(cancelled && cancelled()); pollStart += MMSpreadsheetRowOrderRowsPerPoll) {
+            @autoreleasepool {
+                NSInteger pollEnd = MIN(pollStart + MMSpreadsheetRowOrderRowsPerPoll, end);
+                for (NSInteger i = pollStart; i < pollEnd; i++) {
+                    id value = key(rows[i]);
+                    keys[i] = value ? (void *)CFBridgingRetain(value) : NULL;
+                    positions[i] = i;
+                }
+            }
+        }
+    });
+
+    // Ties fall back to the current position, which keeps the sort stable.
+    int (^compare)(const void *, const void *) = ^int(const void *left, const void *right) {
+        NSInteger leftPosition = *(const NSInteger *)left;
+        NSInteger rightPosition = *(const NSInteger *)right;
+        id leftKey = (__bridge id)keys[leftPosition];
+        id rightKey = (__bridge id)keys[rightPosition];
+        if (leftKey && rightKey) {
+            NSComparisonResult result = comparator(leftKey, rightKey);
+            if (result != NSOrderedSame) {
+                return (int)result;
+            }
+        }
+        else if (leftKey || rightKey) {
+            return leftKey ? -1 : 1;
+        }
+        return leftPosition < rightPosition ? -1 : (leftPosition > rightPosition ? 1 : 0);
+    };
+
+    // Sort each chunk in parallel, then merge pairs of runs in parallel until one run is left.
+    if (!(cancelled && cancelled())) {
+        dispatch_apply(chunkCount, queue, ^(size_t chunk) {
+            NSInteger start = chunk * chunkLength;
+            NSInteger end = MIN(start + chunkLength, count);
+            if (end - start > 1) {
+                qsort_b(positions + start, end - start, sizeof(NSInteger), compare);
+            }
+        });
+    }
+    for (NSInteger width = chunkLength; width < count && !(cancelled && cancelled()); width *= 2) {
+        const NSInteger *source = positions;
+        NSInteger *destination = buffer;
+        size_t pairCount = (count + 2 * width - 1) / (2 * width);
+        dispatch_apply(pairCount, queue, ^(size_t pair) {
+            NSInteger low = pair * 2 * width;
+            MMSpreadsheetRowOrderMerge(source, low, MIN(low + width, count), MIN(low + 2 * width, count), destination, compare);
+        });
+        buffer = positions;
+        positions = destination;
+    }
+
+    MMSpreadsheetRowOrder *rowOrder = nil;
+    if (!(cancelled && cancelled())) {
+        NSMutableData *bodyRows = [NSMutableData dataWithLength:count * sizeof(NSInteger)];
+        NSInteger *sortedRows = bodyRows.mutableBytes;
+        for (NSInteger i = 0; i < count; i++) {
+            sortedRows[i] = rows[positions[i]];
+        }
+        rowOrder = [[MMSpreadsheetRowOrder alloc] initWithDataRowCount:self.dataRowCount fixedRowCount:self.fixedRowCount bodyRows:bodyRows];
+    }
+
+    for (NSInteger i = 0; i < count; i++) {
+        if (keys[i]) {
+            CFRelease(keys[i]);
+        }
+    }
+    free(keys);
+    free(positions);
+    free(buffer);
+    return rowOrder;
+}
+
+- (instancetype)rowOrderFilteredByPredicate:(BOOL (^)(NSInteger row))predicate cancelled:(BOOL (^)(void))cancelled
+{
+    NSParameterAssert(predicate);
+    NSInteger count = self.rowCount - self.fixedRowCount;
+    const NSInteger *rows = self.bodyRows.bytes;
+    size_t chunkCount = MMSpreadsheetRowOrderChunkCount(count);
+    NSInteger chunkLength = (count + chunkCount - 1) / chunkCount;
+    BOOL *keep = calloc(MAX(count, 1), sizeof(BOOL));
+    if (keep == NULL) {
+        return nil;
+    }
+
+    dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+        NSInteger start = chunk * chunkLength;
+        NSInteger end = MIN(start + chunkLength, count);
+        for (NSInteger pollStart = start; pollStart < end && !(cancelled && cancelled()); pollStart += MMSpreadsheetRowOrderRowsPerPoll) {
+            @autoreleasepool {
+                NSInteger pollEnd = MIN(pollStart + MMSpreadsheetRowOrderRowsPerPoll, end);
+                for (NSInteger i = pollStart; i < pollEnd; i++) {
+                    keep[i] = predicate(rows[i]);
+                }
+            }
+        }
+    });
+
+    MMSpreadsheetRowOrder *rowOrder = nil;
+    if (!(cancelled && cancelled())) {
+        NSMutableData *bodyRows = [NSMutableData dataWithLength:count * sizeof(NSInteger)];
+        NSInteger *keptRows = bodyRows.mutableBytes;
+        NSInteger keptCount = 0;
+        for (NSInteger i = 0; i < count; i++) {
+            if (keep[i]) {
+                keptRows[keptCount++] = rows[i];
+            }
+        }
+        [bodyRows setLength:keptCount * sizeof(NSInteger)];
+        rowOrder = [[MMSpreadsheetRowOrder alloc] initWithDataRowCount:self.dataRowCount fixedRowCount:self.fixedRowCount bodyRows:bodyRows];
+    }
+    free(keep);
+    return rowOrder;
+}
+
+#pragma mark - Data Changes
+
+- (instancetype)rowOrderByInsertingDataRows:(NSIndexSet *)rows
+{
+    NSParameterAssert([rows count] == 0 || (NSInteger)[rows firstIndex] >= self.fixedRowCount);
+    NSInteger dataRowCount = self.dataRowCount + [rows count];
+
+    // Where each existing data row ends up after the insertion.
+    NSMutableData *movedRows = [NSMutableData dataWithLength:self.dataRowCount * sizeof(NSInteger)];
+    NSInteger *newRowForRow = movedRows.mutableBytes;
+    NSInteger oldRow = 0;
+    for (NSInteger row = 0; row < dataRowCount; row++) {
+        if (![rows containsIndex:row]) {
+            newRowForRow[oldRow++] = row;
+        }
+    }
+
+    NSInteger bodyRowCount = self.rowCount - self.fixedRowCount;
+    NSMutableData *bodyRows = [NSMutableData dataWithLength:(bodyRowCount + [rows count]) * sizeof(NSInteger)];
+    NSInteger *newBodyRows = bodyRows.mutableBytes;
+    const NSInteger *oldBodyRows = self.bodyRows.bytes;
+    for (NSInteger i = 0; i < bodyRowCount; i++) {
+        newBodyRows[i] = newRowForRow[oldBodyRows[i]];
+    }
+    __block NSInteger index = bodyRowCount;
+    [rows enumerateIndexesUsingBlock:^(NSUInteger row, BOOL *stop) {
+        newBodyRows[index++] = row;
+    }];
+    return [[MMSpreadsheetRowOrder alloc] initWithDataRowCount:dataRowCount fixedRowCount:self.fixedRowCount bodyRows:bodyRows];
+}
+
+- (instancetype)rowOrderByDeletingDataRows:(NSIndexSet *)rows
+{
+    NSParameterAssert([rows count] == 0 || (NSInteger)[rows firstIndex] >= self.fixedRowCount);
+    NSInteger dataRowCount = self.dataRowCount - [rows count];
+
+    // Where each existing data row ends up after the deletion, or -1 if it was deleted.
+    NSMutableData *movedRows = [NSMutableData dataWithLength:self.dataRowCount * sizeof(NSInteger)];
+    NSInteger *newRowForRow = movedRows.mutableBytes;
+    NSInteger newRow = 0;
+    for (NSInteger row = 0; row < self.dataRowCount; row++) {
+        newRowForRow[row] = [rows containsIndex:row] ? -1 : newRow++;
+    }
+
+    NSInteger bodyRowCount = self.rowCount - self.fixedRowCount;
+    NSMutableData *bodyRows = [NSMutableData dataWithLength:bodyRowCount * sizeof(NSInteger)];
+    NSInteger *newBodyRows = bodyRows.mutableBytes;
+    const NSInteger *oldBodyRows = self.bodyRows.bytes;
+    NSInteger keptCount = 0;
+    for (NSInteger i = 0; i < bodyRowCount; i++) {
+        NSInteger row = newRowForRow[oldBodyRows[i]];
+        if (row >= 0) {
+            newBodyRows[keptCount++] = row;
+        }
+    }
+    [bodyRows setLength:keptCount * sizeof(NSInteger)];
+    return [[MMSpreadsheetRowOrder alloc] initWithDataRowCount:dataRowCount fixedRowCount:self.fixedRowCount bodyRows:bodyRows];
+}
+
+@end
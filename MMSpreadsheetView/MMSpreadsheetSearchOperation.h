@@ -0,0 +1,110 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <Foundation/Foundation.h>
+
+@class MMSpreadsheetView;
+@class MMSpreadsheetRowOrder;
+@protocol MMSpreadsheetViewValueDataSource;
+
+/**
+ `MMSpreadsheetSearchOperation` finds the cells whose text contains a string, scanning the grid in parallel chunks without blocking the main thread.
+ 
+ Cell text comes from a value data source, so the search never touches cells. The rows are split into a few chunks per core and scanned with `dispatch_apply`. Matches are recorded as they are found and announced on the main thread a batch of rows at a time, so a spreadsheet view can highlight the visible ones long before the scan ends. Cancelling is checked between small batches of rows, so a search superseded by the next keystroke stops almost at once.
+ 
+ Run the operation on a background queue; `MMSpreadsheetView` does this for you with searchForText:options:progress:completion:.
+ 
+ Matches can be read from any thread while the scan runs.
+ */
+@interface MMSpreadsheetSearchOperation : NSOperation
+
+/**
+ Creates a search of every cell.
+ 
+ @param spreadsheetView The spreadsheet view passed to the value data source. The operation keeps a weak reference.
+ @param valueDataSource Supplies the text of each cell. It is called concurrently on several threads.
+ @param text The text to find.
+ @param options The options used to compare text, such as NSCaseInsensitiveSearch. NSBackwardsSearch and NSAnchoredSearch are honored as they are by `rangeOfString:options:`.
+ @param rowCount The number of display rows.
+ @param columnCount The number of columns.
+ @param rowOrder The order rows are displayed in, or nil for data source order.
+ 
+ @return An operation that has not started.
+ */
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                        valueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+                                   text:(NSString *)text
+                                options:(NSStringCompareOptions)options
+                               rowCount:(NSInteger)rowCount
+                            columnCount:(NSInteger)columnCount
+                               rowOrder:(MMSpreadsheetRowOrder *)rowOrder;
+
+@property (nonatomic, readonly) NSString *text;
+@property (nonatomic, readonly) NSStringCompareOptions options;
+@property (nonatomic, readonly) NSInteger rowCount;
+@property (nonatomic, readonly) NSInteger columnCount;
+
+/**
+ Creates a search of the rows appended since this one was created, for the same text. It adds its matches to this search's, so both see every match found by either. Start it once this search has finished, so that rows are reported in order. Its blocks are not copied from this search.
+ 
+ @param rowCount The number of display rows now, including the appended rows. The rows before the appended ones must not have moved.
+ @param rowOrder The order rows are displayed in now, or nil for data source order.
+ 
+ @return An operation that has not started.
+ */
+- (instancetype)searchByAppendingRowsUpToRowCount:(NSInteger)rowCount rowOrder:(MMSpreadsheetRowOrder *)rowOrder;
+
+/**
+ Returns whether this search and another share their matches, because one was made from the other with searchByAppendingRowsUpToRowCount:rowOrder:.
+ */
+- (BOOL)sharesMatchesWithSearch:(MMSpreadsheetSearchOperation *)search;
+
+/**
+ The number of matches found so far.
+ */
+@property (nonatomic, readonly) NSUInteger matchCount;
+
+/**
+ Returns whether the cell at a display row and column is a match found so far.
+ */
+- (BOOL)containsRow:(NSInteger)row column:(NSInteger)column;
+
+/**
+ Finds the match after or before a cell, in reading order (left to right, then top to bottom), wrapping around at the ends.
+ 
+ @param row On input, the display row to start from, or NSNotFound to start before the first cell (or after the last when searching backwards). On output, the row of the match.
+ @param column On input, the column to start from. On output, the column of the match.
+ @param forward YES to find the next match, NO to find the previous one.
+ 
+ @return NO if nothing has matched yet.
+ */
+- (BOOL)getMatchRow:(NSInteger *)row column:(NSInteger *)column forward:(BOOL)forward;
+
+/**
+ Called on the main thread after a batch of rows holding new matches has been scanned, with those rows.
+ */
+@property (nonatomic, copy) void (^matchesBlock)(NSRange rows);
+
+/**
+ Called once on the main thread when the operation ends, after the last matchesBlock. `finished` is NO if the operation was cancelled.
+ */
+@property (nonatomic, copy) void (^searchCompletionBlock)(BOOL finished);
+
+@end
@@ -0,0 +1,227 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "MMSpreadsheetSearchOperation.h"
+#import "MMSpreadsheetView.h"
+#import "MMSpreadsheetRowOrder.h"
+
+// Small enough that cancelling is noticed quickly and matches show up soon after they are found.
+const static NSInteger MMSpreadsheetSearchCellsPerBatch = 16384;
+
+@interface MMSpreadsheetSearchOperation ()
+
+@property (nonatomic, weak) MMSpreadsheetView *spreadsheetView;
+@property (nonatomic, strong) id<MMSpreadsheetViewValueDataSource> valueDataSource;
+@property (nonatomic, strong) MMSpreadsheetRowOrder *rowOrder;
+@property (nonatomic, copy) NSString *text;
+@property (nonatomic, assign) NSStringCompareOptions options;
+@property (nonatomic, assign) NSInteger rowCount;
+@property (nonatomic, assign) NSInteger columnCount;
+
+// The display rows this operation scans. Searches of appended rows scan only the rows they add.
+@property (nonatomic, assign) NSRange searchedRows;
+
+// Matching cells as row * columnCount + column, which is reading order. Guarded by @synchronized on itself.
+// Shared with the searches of appended rows made from this one.
+@property (nonatomic, strong) NSMutableIndexSet *matches;
+
+@property (nonatomic, assign) BOOL searchFinished;
+
+@end
+
+@implementation MMSpreadsheetSearchOperation
+
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView
+                        valueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+                                   text:(NSString *)text
+                                options:(NSStringCompareOptions)options
+                               rowCount:(NSInteger)rowCount
+                            columnCount:(NSInteger)columnCount
+                               rowOrder:(MMSpreadsheetRowOrder *)rowOrder
+{
+    NSParameterAssert(valueDataSource);
+    NSParameterAssert(text);
+    self = [super init];
+    if (self) {
+        _spreadsheetView = spreadsheetView;
+        _valueDataSource = valueDataSource;
+        _text = [text copy];
+        _options = options;
+        _rowCount = MAX(rowCount, 0);
+        _columnCount = MAX(columnCount, 0);
+        _rowOrder = rowOrder;
+        _searchedRows = NSMakeRange(0, _rowCount);
+        _matches = [NSMutableIndexSet indexSet];
+    }
+    return self;
+}
+
+- (instancetype)searchByAppendingRowsUpToRowCount:(NSInteger)rowCount rowOrder:(MMSpreadsheetRowOrder *)rowOrder
+{
+    NSParameterAssert(rowCount >= self.rowCount);
+    MMSpreadsheetSearchOperation *search = [[[self class] alloc] initWithSpreadsheetView:self.spreadsheetView
+                                                                         valueDataSource:self.valueDataSource
+                                                                                    text:self.text
+                                                                                 options:self.options
+                                                                                rowCount:rowCount
+                                                                             columnCount:self.columnCount
+                                                                                rowOrder:rowOrder];
+    search.searchedRows = NSMakeRange(self.rowCount, search.rowCount - self.rowCount);
+    search.matches = self.matches;
+    return search;
+}
+
+- (BOOL)sharesMatchesWithSearch:(MMSpreadsheetSearchOperation *)search
+{
+    return search != nil && search.matches == self.matches;
+}
+
+- (void)start
+{
+    // A cancelled operation finishes without running main, but its completion block is still owed a call.
+    MMSpreadsheetSearchOperation *strongSelf = self;
+    [super start];
+    [strongSelf reportCompletion];
+}
+
+- (void)main
+{
+    NSInteger rowCount = self.searchedRows.length;
+    if (rowCount == 0 || self.columnCount == 0 || [self.text length] == 0) {
+        self.searchFinished = !self.isCancelled;
+        return;
+    }
+
+    // A few chunks per core evens out rows whose values are slower to produce.
+    NSInteger rowsPerBatch = MAX(MMSpreadsheetSearchCellsPerBatch / self.columnCount, 1);
+    NSInteger batchCount = (rowCount + rowsPerBatch - 1) / rowsPerBatch;
+    size_t chunkCount = MAX(MIN((NSInteger)[[NSProcessInfo processInfo] activeProcessorCount] * 4, batchCount), 1);
+    NSInteger batchesPerChunk = (batchCount + chunkCount - 1) / chunkCount;
+
+    dispatch_apply(chunkCount, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^(size_t chunk) {
+        NSInteger firstRow = self.searchedRows.location + (NSInteger)chunk * batchesPerChunk * rowsPerBatch;
+        NSInteger lastRow = MIN(firstRow + batchesPerChunk * rowsPerBatch, (NSInteger)NSMaxRange(self.searchedRows));
+        for (NSInteger batchStart = firstRow; batchStart < lastRow && !self.isCancelled; batchStart += rowsPerBatch) {
+            NSRange rows = NSMakeRange(batchStart, MIN(batchStart + rowsPerBatch, lastRow) - batchStart);
+            if ([self searchRows:rows]) {
+                [self reportMatchesInRows:rows];
+            }
+        }
+    });
+
+    self.searchFinished = !self.isCancelled;
+}
+
+- (BOOL)searchRows:(NSRange)rows
+{
+    NSMutableIndexSet *batchMatches = [NSMutableIndexSet indexSet];
+    MMSpreadsheetView *spreadsheetView = self.spreadsheetView;
+    @autoreleasepool {
+        for (NSUInteger row = rows.location; row < NSMaxRange(rows); row++) {
+            NSInteger dataRow = self.rowOrder ? [self.rowOrder dataRowForDisplayRow:row] : row;
+            for (NSInteger column = 0; column < self.columnCount; column++) {
+                NSIndexPath *indexPath = [NSIndexPath indexPathForItem:column inSection:dataRow];
+                NSString *text = [self.valueDataSource spreadsheetView:spreadsheetView valueForItemAtIndexPath:indexPath].text;
+                if (text && [text rangeOfString:self.text options:self.options].location != NSNotFound) {
+                    [batchMatches addIndex:row * self.columnCount + column];
+                }
+            }
+        }
+    }
+    if ([batchMatches count] == 0) {
+        return NO;
+    }
+    @synchronized(self.matches) {
+        [self.matches addIndexes:batchMatches];
+    }
+    return YES;
+}
+
+#pragma mark - Matches
+
+- (NSUInteger)matchCount
+{
+    @synchronized(self.matches) {
+        return [self.matches count];
+    }
+}
+
+- (BOOL)containsRow:(NSInteger)row column:(NSInteger)column
+{
+    if (row < 0 || row >= self.rowCount || column < 0 || column >= self.columnCount) {
+        return NO;
+    }
+    @synchronized(self.matches) {
+        return [self.matches containsIndex:row * self.columnCount + column];
+    }
+}
+
+- (BOOL)getMatchRow:(NSInteger *)row column:(NSInteger *)column forward:(BOOL)forward
+{
+    NSParameterAssert(row && column);
+    NSUInteger start = *row == NSNotFound ? NSNotFound : *row * self.columnCount + *column;
+    NSUInteger match = NSNotFound;
+    @synchronized(self.matches) {
+        if (forward) {
+            match = start == NSNotFound ? NSNotFound : [self.matches indexGreaterThanIndex:start];
+            if (match == NSNotFound) {
+                match = [self.matches firstIndex];
+            }
+        }
+        else {
+            match = start == NSNotFound ? NSNotFound : [self.matches indexLessThanIndex:start];
+            if (match == NSNotFound) {
+                match = [self.matches lastIndex];
+            }
+        }
+    }
+    if (match == NSNotFound) {
+        return NO;
+    }
+    *row = match / self.columnCount;
+    *column = match % self.columnCount;
+    return YES;
+}
+
+#pragma mark - Reporting
+
+- (void)reportMatchesInRows:(NSRange)rows
+{
+    void (^matchesBlock)(NSRange) = self.matchesBlock;
+    if (matchesBlock) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            matchesBlock(rows);
+        });
+    }
+}
+
+- (void)reportCompletion
+{
+    // Queued after every matchesBlock, since those are all dispatched before main returns.
+    void (^searchCompletionBlock)(BOOL) = self.searchCompletionBlock;
+    BOOL finished = self.searchFinished;
+    if (searchCompletionBlock) {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            searchCompletionBlock(finished);
+        });
+    }
+}
+
+@end
@@ -0,0 +1,110 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import <Foundation/Foundation.h>
+
+/**
+ `MMSpreadsheetSelection` is a set of selected cells stored as rectangular ranges rather than one entry per cell.
+ 
+ Cells are kept as bands of consecutive rows that share the same selected columns, and each band keeps its columns as sorted, merged spans. Selecting a whole column of a million-row sheet is a single band with a single span. Asking whether a cell is selected is two binary searches, so it is cheap enough to do for every cell as it is configured or drawn.
+ 
+ Whole rows and whole columns are unbounded: they extend to `NSIntegerMax`, so they stay whole as the grid grows. Clip them to the grid when enumerating.
+ 
+ Selections are not thread safe while they are being changed. A copy that is no longer changed can be read from any thread.
+ */
+@interface MMSpreadsheetSelection : NSObject <NSCopying>
+
+/**
+ YES if no cell is selected.
+ */
+@property (nonatomic, readonly, getter = isEmpty) BOOL empty;
+
+/**
+ The number of row bands the selection is stored as. Hit tests take time logarithmic in this count and in the number of column spans per band.
+ */
+@property (nonatomic, readonly) NSUInteger bandCount;
+
+/**
+ Returns whether a cell is selected.
+ */
+- (BOOL)containsRow:(NSInteger)row column:(NSInteger)column;
+
+/**
+ Selects every cell in a rectangle.
+ 
+ @param rows The rows of the rectangle. A length reaching past `NSIntegerMax` means every row from the location on.
+ @param columns The columns of the rectangle, with the same convention.
+ */
+- (void)addCellsInRows:(NSRange)rows columns:(NSRange)columns;
+
+/**
+ Deselects every cell in a rectangle.
+ */
+- (void)removeCellsInRows:(NSRange)rows columns:(NSRange)columns;
+
+/**
+ Selects whole rows, including columns added later.
+ */
+- (void)addRows:(NSRange)rows;
+
+/**
+ Selects whole columns, including rows added later.
+ */
+- (void)addColumns:(NSRange)columns;
+
+/**
+ Adds every cell of another selection.
+ */
+- (void)addSelection:(MMSpreadsheetSelection *)selection;
+
+/**
+ Deselects every cell.
+ */
+- (void)removeAllCells;
+
+/**
+ Follows rows inserted into the grid. Inserted rows are not selected and the rows after them move down. Indexes are relative to the grid after the insertion.
+ */
+- (void)insertRows:(NSIndexSet *)rows;
+
+/**
+ Follows rows deleted from the grid. The rows after them move up. Indexes are relative to the grid before the deletion.
+ */
+- (void)deleteRows:(NSIndexSet *)rows;
+
+/**
+ Follows columns inserted into the grid, like insertRows:.
+ */
+- (void)insertColumns:(NSIndexSet *)columns;
+
+/**
+ Follows columns deleted from the grid, like deleteRows:.
+ */
+- (void)deleteColumns:(NSIndexSet *)columns;
+
+/**
+ Enumerates the selection as disjoint rectangles, in row order then column order.
+ 
+ @param rows Only the parts of the selection in these rows are enumerated.
+ @param columns Only the parts of the selection in these columns are enumerated.
+ @param block Called with the rows and columns of each rectangle, clipped to `rows` and `columns`. Set `stop` to YES to end the enumeration.
+ */
+- (void)enumerateRangesInRows:(NSRange)rows columns:(NSRange)columns usingBlock:(void (^)(NSRange rows, NSRange columns, BOOL *stop))block;
+
+@end
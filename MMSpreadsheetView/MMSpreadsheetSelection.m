@@ -0,0 +1,403 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+#import "MMSpreadsheetSelection.h"
+
+// A half-open run of rows or columns. An end of NSIntegerMax means the run is unbounded.
+typedef struct {
+    NSInteger start;
+    NSInteger end;
+} MMSelectionSpan;
+
+// Consecutive rows that all have the same columns selected. The columns are a slice of the shared span buffer.
+typedef struct {
+    MMSelectionSpan rows;
+    NSInteger firstColumn;
+    NSInteger columnCount;
+} MMSelectionBand;
+
+static MMSelectionSpan MMSelectionSpanFromRange(NSRange range)
+{
+    NSInteger start = (NSInteger)MIN(range.location, (NSUInteger)NSIntegerMax);
+    NSInteger end = range.length >= (NSUInteger)(NSIntegerMax - start) ? NSIntegerMax : start + (NSInteger)range.length;
+    return (MMSelectionSpan){ start, end };
+}
+
+static MMSelectionSpan MMSelectionSpanIntersection(MMSelectionSpan a, MMSelectionSpan b)
+{
+    MMSelectionSpan span = { MAX(a.start, b.start), MIN(a.end, b.end) };
+    span.end = MAX(span.start, span.end);
+    return span;
+}
+
+// Spans are appended in order of their starts, so a span that touches the last one is merged into it.
+static void MMSelectionAppendSpan(NSMutableData *spans, MMSelectionSpan span)
+{
+    if (span.start >= span.end) {
+        return;
+    }
+    NSInteger count = [spans length] / sizeof(MMSelectionSpan);
+    MMSelectionSpan *last = count > 0 ? (MMSelectionSpan *)[spans mutableBytes] + count - 1 : NULL;
+    if (last && last->end >= span.start) {
+        last->end = MAX(last->end, span.end);
+        return;
+    }
+    [spans appendBytes:&span length:sizeof(MMSelectionSpan)];
+}
+
+// Bands are appended in row order, so a band that continues the last one with the same columns is merged into it.
+static void MMSelectionAppendBand(NSMutableData *bands, NSMutableData *columns, MMSelectionSpan rows, const MMSelectionSpan *spans, NSInteger spanCount)
+{
+    if (rows.start >= rows.end || spanCount == 0) {
+        return;
+    }
+    NSInteger bandCount = [bands length] / sizeof(MMSelectionBand);
+    MMSelectionBand *last = bandCount > 0 ? (MMSelectionBand *)[bands mutableBytes] + bandCount - 1 : NULL;
+    if (last && last->rows.end == rows.start && last->columnCount == spanCount) {
+        const MMSelectionSpan *lastSpans = (const MMSelectionSpan *)[columns bytes] + last->firstColumn;
+        if (memcmp(lastSpans, spans, spanCount * sizeof(MMSelectionSpan)) == 0) {
+            last->rows.end = rows.end;
+            return;
+        }
+    }
+    MMSelectionBand band = { rows, [columns length] / sizeof(MMSelectionSpan), spanCount };
+    [bands appendBytes:&band length:sizeof(MMSelectionBand)];
+    [columns appendBytes:spans length:spanCount * sizeof(MMSelectionSpan)];
+}
+
+static void MMSelectionCombineSpans(const MMSelectionSpan *spans, NSInteger count, MMSelectionSpan span, BOOL adding, NSMutableData *result)
+{
+    [result setLength:0];
+    BOOL spanAppended = NO;
+    for (NSInteger i = 0; i < count; i++) {
+        if (adding) {
+            if (!spanAppended && spans[i].start >= span.start) {
+                MMSelectionAppendSpan(result, span);
+                spanAppended = YES;
+            }
+            MMSelectionAppendSpan(result, spans[i]);
+        }
+        else {
+            MMSelectionAppendSpan(result, (MMSelectionSpan){ spans[i].start, MIN(spans[i].end, span.start) });
+            MMSelectionAppendSpan(result, (MMSelectionSpan){ MAX(spans[i].start, span.end), spans[i].end });
+        }
+    }
+    if (adding && !spanAppended) {
+        MMSelectionAppendSpan(result, span);
+    }
+}
+
+static NSInteger MMSelectionIndexAfterDeletion(NSInteger index, NSInteger location, NSInteger length)
+{
+    if (index <= location || index == NSIntegerMax) {
+        return index;
+    }
+    return index <= location + length ? location : index - length;
+}
+
+// Moves the span to follow an insertion or deletion of `length` indexes at `location`. Inserted indexes are never part of the span.
+static void MMSelectionAppendEditedSpan(NSMutableData *result, MMSelectionSpan span, NSInteger location, NSInteger length, BOOL inserting)
+{
+    if (!inserting) {
+        MMSelectionAppendSpan(result, (MMSelectionSpan){ MMSelectionIndexAfterDeletion(span.start, location, length),
+                                                         MMSelectionIndexAfterDeletion(span.end, location, length) });
+        return;
+    }
+    NSInteger shiftedEnd = span.end == NSIntegerMax ? NSIntegerMax : span.end + length;
+    if (span.end <= location) {
+        MMSelectionAppendSpan(result, span);
+    }
+    else if (span.start >= location) {
+        MMSelectionAppendSpan(result, (MMSelectionSpan){ span.start + length, shiftedEnd });
+    }
+    else {
+        MMSelectionAppendSpan(result, (MMSelectionSpan){ span.start, location });
+        MMSelectionAppendSpan(result, (MMSelectionSpan){ location + length, shiftedEnd });
+    }
+}
+
+// The index of the first span that ends after `index`, or `count` if there is none.
+static NSInteger MMSelectionSearchSpans(const void *spans, size_t stride, NSInteger count, NSInteger index)
+{
+    NSInteger low = 0;
+    NSInteger high = count;
+    while (low < high) {
+        NSInteger middle = low + (high - low) / 2;
+        const MMSelectionSpan *span = (const MMSelectionSpan *)((const char *)spans + middle * stride);
+        if (span->end <= index) {
+            low = middle + 1;
+        }
+        else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+@interface MMSpreadsheetSelection ()
+
+// Both buffers are replaced rather than changed, so copies can share them.
+@property (nonatomic, strong) NSData *bands;
+@property (nonatomic, strong) NSData *columns;
+
+@end
+
+@implementation MMSpreadsheetSelection
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        _bands = [NSData data];
+        _columns = [NSData data];
+    }
+    return self;
+}
+
+- (id)copyWithZone:(NSZone *)zone
+{
+    MMSpreadsheetSelection *selection = [[[self class] allocWithZone:zone] init];
+    selection.bands = self.bands;
+    selection.columns = self.columns;
+    return selection;
+}
+
+- (NSString *)description
+{
+    NSMutableString *description = [NSMutableString stringWithFormat:@"<%@: %p", NSStringFromClass([self class]), self];
+    [self enumerateRangesInRows:NSMakeRange(0, NSIntegerMax) columns:NSMakeRange(0, NSIntegerMax) usingBlock:^(NSRange rows, NSRange columns, BOOL *stop) {
+        [description appendFormat:@" rows %@ columns %@;", NSStringFromRange(rows), NSStringFromRange(columns)];
+    }];
+    [description appendString:@">"];
+    return description;
+}
+
+#pragma mark - Querying
+
+- (BOOL)isEmpty
+{
+    return [self.bands length] == 0;
+}
+
+- (NSUInteger)bandCount
+{
+    return [self.bands length] / sizeof(MMSelectionBand);
+}
+
+- (BOOL)containsRow:(NSInteger)row column:(NSInteger)column
+{
+    if (row < 0 || column < 0) {
+        return NO;
+    }
+    const MMSelectionBand *bands = [self.bands bytes];
+    NSInteger bandCount = [self bandCount];
+    NSInteger bandIndex = MMSelectionSearchSpans(bands, sizeof(MMSelectionBand), bandCount, row);
+    if (bandIndex == bandCount || bands[bandIndex].rows.start > row) {
+        return NO;
+    }
+    const MMSelectionBand *band = &bands[bandIndex];
+    const MMSelectionSpan *spans = (const MMSelectionSpan *)[self.columns bytes] + band->firstColumn;
+    NSInteger spanIndex = MMSelectionSearchSpans(spans, sizeof(MMSelectionSpan), band->columnCount, column);
+    return spanIndex < band->columnCount && spans[spanIndex].start <= column;
+}
+
+- (void)enumerateRangesInRows:(NSRange)rows columns:(NSRange)columns usingBlock:(void (^)(NSRange rows, NSRange columns, BOOL *stop))block
+{
+    NSParameterAssert(block);
+    MMSelectionSpan rowSpan = MMSelectionSpanFromRange(rows);
+    MMSelectionSpan columnSpan = MMSelectionSpanFromRange(columns);
+    NSData *bandData = self.bands;
+    NSData *columnData = self.columns;
+    const MMSelectionBand *bands = [bandData bytes];
+    NSInteger bandCount = [bandData length] / sizeof(MMSelectionBand);
+
+    BOOL stop = NO;
+    for (NSInteger i = MMSelectionSearchSpans(bands, sizeof(MMSelectionBand), bandCount, rowSpan.start); i < bandCount && !stop; i++) {
+        MMSelectionSpan bandRows = MMSelectionSpanIntersection(bands[i].rows, rowSpan);
+        if (bandRows.start >= bandRows.end) {
+            break;
+        }
+        const MMSelectionSpan *spans = (const MMSelectionSpan *)[columnData bytes] + bands[i].firstColumn;
+        NSInteger columnCount = bands[i].columnCount;
+        for (NSInteger j = MMSelectionSearchSpans(spans, sizeof(MMSelectionSpan), columnCount, columnSpan.start); j < columnCount && !stop; j++) {
+            MMSelectionSpan bandColumns = MMSelectionSpanIntersection(spans[j], columnSpan);
+            if (bandColumns.start >= bandColumns.end) {
+                break;
+            }
+            block(NSMakeRange(bandRows.start, bandRows.end - bandRows.start), NSMakeRange(bandColumns.start, bandColumns.end - bandColumns.start), &stop);
+        }
+    }
+}
+
+#pragma mark - Changing the Selection
+
+- (void)addCellsInRows:(NSRange)rows columns:(NSRange)columns
+{
+    [self combineRows:MMSelectionSpanFromRange(rows) columns:MMSelectionSpanFromRange(columns) adding:YES];
+}
+
+- (void)removeCellsInRows:(NSRange)rows columns:(NSRange)columns
+{
+    [self combineRows:MMSelectionSpanFromRange(rows) columns:MMSelectionSpanFromRange(columns) adding:NO];
+}
+
+- (void)addRows:(NSRange)rows
+{
+    [self addCellsInRows:rows columns:NSMakeRange(0, NSIntegerMax)];
+}
+
+- (void)addColumns:(NSRange)columns
+{
+    [self addCellsInRows:NSMakeRange(0, NSIntegerMax) columns:columns];
+}
+
+- (void)addSelection:(MMSpreadsheetSelection *)selection
+{
+    [selection enumerateRangesInRows:NSMakeRange(0, NSIntegerMax) columns:NSMakeRange(0, NSIntegerMax) usingBlock:^(NSRange rows, NSRange columns, BOOL *stop) {
+        [self addCellsInRows:rows columns:columns];
+    }];
+}
+
+- (void)removeAllCells
+{
+    self.bands = [NSData data];
+    self.columns = [NSData data];
+}
+
+- (void)combineRows:(MMSelectionSpan)rows columns:(MMSelectionSpan)columns adding:(BOOL)adding
+{
+    if (rows.start >= rows.end || columns.start >= columns.end) {
+        return;
+    }
+    const MMSelectionBand *bands = [self.bands bytes];
+    NSInteger bandCount = [self bandCount];
+    const MMSelectionSpan *spans = [self.columns bytes];
+    NSMutableData *newBands = [NSMutableData dataWithCapacity:[self.bands length] + 2 * sizeof(MMSelectionBand)];
+    NSMutableData *newColumns = [NSMutableData dataWithCapacity:[self.columns length] + 2 * sizeof(MMSelectionSpan)];
+    NSMutableData *combinedColumns = [NSMutableData data];
+
+    // Bands are split where the rectangle starts and ends. Rows of the rectangle that no band covers get a band of their own.
+    NSInteger uncoveredRow = rows.start;
+    for (NSInteger i = 0; i < bandCount; i++) {
+        MMSelectionBand band = bands[i];
+        const MMSelectionSpan *bandColumns = spans + band.firstColumn;
+        if (band.rows.start >= rows.end && adding && uncoveredRow < rows.end) {
+            MMSelectionAppendBand(newBands, newColumns, (MMSelectionSpan){ uncoveredRow, rows.end }, &columns, 1);
+            uncoveredRow = rows.end;
+        }
+        if (band.rows.end <= rows.start || band.rows.start >= rows.end) {
+            MMSelectionAppendBand(newBands, newColumns, band.rows, bandColumns, band.columnCount);
+            continue;
+        }
+
+        MMSelectionSpan overlap = MMSelectionSpanIntersection(band.rows, rows);
+        MMSelectionAppendBand(newBands, newColumns, (MMSelectionSpan){ band.rows.start, overlap.start }, bandColumns, band.columnCount);
+        if (adding && uncoveredRow < overlap.start) {
+            MMSelectionAppendBand(newBands, newColumns, (MMSelectionSpan){ uncoveredRow, overlap.start }, &columns, 1);
+        }
+        MMSelectionCombineSpans(bandColumns, band.columnCount, columns, adding, combinedColumns);
+        MMSelectionAppendBand(newBands, newColumns, overlap, [combinedColumns bytes], [combinedColumns length] / sizeof(MMSelectionSpan));
+        MMSelectionAppendBand(newBands, newColumns, (MMSelectionSpan){ overlap.end, band.rows.end }, bandColumns, band.columnCount);
+        uncoveredRow = overlap.end;
+    }
+    if (adding && uncoveredRow < rows.end) {
+        MMSelectionAppendBand(newBands, newColumns, (MMSelectionSpan){ uncoveredRow, rows.end }, &columns, 1);
+    }
+
+    self.bands = newBands;
+    self.columns = newColumns;
+}
+
+#pragma mark - Following Grid Changes
+
+- (void)insertRows:(NSIndexSet *)rows
+{
+    // Each range is relative to the grid after the ranges before it are inserted.
+    [rows enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        [self editRowsAtLocation:range.location length:range.length inserting:YES];
+    }];
+}
+
+- (void)deleteRows:(NSIndexSet *)rows
+{
+    // Deleting from the end keeps the earlier ranges where they were.
+    [rows enumerateRangesWithOptions:NSEnumerationReverse usingBlock:^(NSRange range, BOOL *stop) {
+        [self editRowsAtLocation:range.location length:range.length inserting:NO];
+    }];
+}
+
+- (void)insertColumns:(NSIndexSet *)columns
+{
+    [columns enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        [self editColumnsAtLocation:range.location length:range.length inserting:YES];
+    }];
+}
+
+- (void)deleteColumns:(NSIndexSet *)columns
+{
+    [columns enumerateRangesWithOptions:NSEnumerationReverse usingBlock:^(NSRange range, BOOL *stop) {
+        [self editColumnsAtLocation:range.location length:range.length inserting:NO];
+    }];
+}
+
+- (void)editRowsAtLocation:(NSInteger)location length:(NSInteger)length inserting:(BOOL)inserting
+{
+    const MMSelectionBand *bands = [self.bands bytes];
+    NSInteger bandCount = [self bandCount];
+    const MMSelectionSpan *spans = [self.columns bytes];
+    NSMutableData *newBands = [NSMutableData dataWithCapacity:[self.bands length] + sizeof(MMSelectionBand)];
+    NSMutableData *newColumns = [NSMutableData dataWithCapacity:[self.columns length]];
+    NSMutableData *editedRows = [NSMutableData data];
+
+    for (NSInteger i = 0; i < bandCount; i++) {
+        // An insertion can split a band in two.
+        [editedRows setLength:0];
+        MMSelectionAppendEditedSpan(editedRows, bands[i].rows, location, length, inserting);
+        const MMSelectionSpan *rowSpans = [editedRows bytes];
+        for (NSInteger j = 0; j < (NSInteger)([editedRows length] / sizeof(MMSelectionSpan)); j++) {
+            MMSelectionAppendBand(newBands, newColumns, rowSpans[j], spans + bands[i].firstColumn, bands[i].columnCount);
+        }
+    }
+
+    self.bands = newBands;
+    self.columns = newColumns;
+}
+
+- (void)editColumnsAtLocation:(NSInteger)location length:(NSInteger)length inserting:(BOOL)inserting
+{
+    const MMSelectionBand *bands = [self.bands bytes];
+    NSInteger bandCount = [self bandCount];
+    const MMSelectionSpan *spans = [self.columns bytes];
+    NSMutableData *newBands = [NSMutableData dataWithCapacity:[self.bands length]];
+    NSMutableData *newColumns = [NSMutableData dataWithCapacity:[self.columns length] + bandCount * sizeof(MMSelectionSpan)];
+    NSMutableData *editedColumns = [NSMutableData data];
+
+    for (NSInteger i = 0; i < bandCount; i++) {
+        [editedColumns setLength:0];
+        for (NSInteger j = 0; j < bands[i].columnCount; j++) {
+            MMSelectionAppendEditedSpan(editedColumns, spans[bands[i].firstColumn + j], location, length, inserting);
+        }
+        MMSelectionAppendBand(newBands, newColumns, bands[i].rows, [editedColumns bytes], [editedColumns length] / sizeof(MMSelectionSpan));
+    }
+
+    self.bands = newBands;
+    self.columns = newColumns;
+}
+
+@end
@@ -0,0 +1,122 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+@class MMSpreadsheetView;
+@class MMSpreadsheetRowOrder;
+@class MMSpreadsheetSelection;
+@class MMSpreadsheetMergedCells;
+@class MMSpreadsheetSearchOperation;
+@protocol MMSpreadsheetViewValueDataSource;
+
+/**
+ `MMSpreadsheetTileView` draws the cells of one spreadsheet pane into fixed-size tiles instead of creating a `UICollectionViewCell` for each of them.
+ 
+ The tile view is added to the pane's collection view and sized to its content, so it scrolls with it. Tiles are rasterized on background threads from the values the value data source returns, cached by tile coordinate and shown as plain layers, so a frame only composites a handful of layers no matter how small the cells are.
+ */
+@interface MMSpreadsheetTileView : UIView
+
+/**
+ Creates a tile view for a pane.
+ 
+ @param spreadsheetView The spreadsheet view passed to the value data source.
+ @param collectionView The pane's collection view. Its layout must be a `MMGridLayout`.
+ 
+ @return A tile view that has not been added to the collection view yet.
+ */
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView collectionView:(UICollectionView *)collectionView;
+
+/**
+ The object that supplies the values drawn in the tiles. It is called on background threads.
+ */
+@property (nonatomic, weak) id<MMSpreadsheetViewValueDataSource> valueDataSource;
+
+/**
+ The data source row and column of the pane's first cell, used to turn pane index paths into data source index paths.
+ */
+@property (nonatomic, assign) NSInteger rowOffset;
+@property (nonatomic, assign) NSInteger columnOffset;
+
+/**
+ The order rows are displayed in when the spreadsheet is sorted or filtered, or nil for data order. Changing it discards every tile.
+ */
+@property (nonatomic, strong) MMSpreadsheetRowOrder *rowOrder;
+
+/**
+ The selected cells, in display rows. Selected cells are drawn with a translucent wash of selectionColor. Changing it discards every tile.
+ */
+@property (nonatomic, copy) MMSpreadsheetSelection *selection;
+
+/**
+ The color washed over selected cells; it is drawn translucent. Default is the system blue.
+ */
+@property (nonatomic, strong) UIColor *selectionColor;
+
+/**
+ The search whose matches are drawn with a wash of searchHighlightColor, or nil. Changing it discards every tile, unless the new search shares its matches; as the search finds more matches, invalidate the tiles that show them.
+ */
+@property (nonatomic, strong) MMSpreadsheetSearchOperation *search;
+
+/**
+ The wash drawn over search matches.
+ */
+@property (nonatomic, strong) UIColor *searchHighlightColor;
+
+/**
+ The merged cells, in data source rows and columns. Each one is drawn once across the cells it covers. Changing it discards every tile.
+ */
+@property (nonatomic, strong) MMSpreadsheetMergedCells *mergedCells;
+
+/**
+ The width and height of a tile in points. Changing it discards every tile. Default is 256.
+ */
+@property (nonatomic, assign) CGFloat tileSize;
+
+/**
+ Shows the tiles under the collection view's bounds and starts rendering any that are not cached. Call this whenever the collection view scrolls or resizes.
+ */
+- (void)updateVisibleTiles;
+
+/**
+ Discards every tile and the copied row and column offsets, for when the data or the layout changed. The tiles are rebuilt in the next layout pass.
+ */
+- (void)invalidateAllTiles;
+
+/**
+ Discards only the tiles that show the given cells.
+ 
+ @param indexPaths Index paths in the pane's collection view (section is the row, item the column).
+ */
+- (void)invalidateTilesForItemsAtIndexPaths:(NSArray *)indexPaths;
+
+/**
+ Discards the copied row and column offsets and the tiles that rows added at the end of the pane can appear in: the tile the old last row ends in and those below it. Tiles above keep their images.
+ 
+ @param row The pane row of the first added row.
+ */
+- (void)invalidateTilesForRowsAppendedAtRow:(NSInteger)row;
+
+/**
+ The pane index path of the cell under a point in the tile view, or nil if the point is not over the grid.
+ */
+- (NSIndexPath *)indexPathForItemAtPoint:(CGPoint)point;
+
+@end
@@ -0,0 +1,581 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "MMSpreadsheetTileView.h"
+#import <QuartzCore/QuartzCore.h>
+#import "MMSpreadsheetView.h"
+#import "MMGridLayout.h"
+#import "MMGridGeometry.h"
+#import "MMSpreadsheetRowOrder.h"
+#import "MMSpreadsheetSelection.h"
+#import "MMSpreadsheetMergedCells.h"
+#import "MMSpreadsheetSearchOperation.h"
+
+const static CGFloat MMSpreadsheetTileViewDefaultTileSize = 256.0f;
+const static CGFloat MMSpreadsheetTileViewTextInset = 4.0f;
+const static CGFloat MMSpreadsheetTileViewSelectionAlpha = 0.25f;
+const static NSUInteger MMSpreadsheetTileViewCacheCostLimit = 64 * 1024 * 1024;
+
+/**
+ The row and column offsets a generation of tiles is drawn from. The offsets are copied out of the layout so background renders never touch it.
+ */
+@interface MMSpreadsheetTileGeometry : NSObject
+{
+@public
+    MMGridAxis _rowAxis;
+    MMGridAxis _columnAxis;
+}
+
+@property (nonatomic, assign) CGFloat cellSpacing;
+@property (nonatomic, assign) CGFloat tileSize;
+@property (nonatomic, assign) CGFloat scale;
+@property (nonatomic, assign) NSInteger rowOffset;
+@property (nonatomic, assign) NSInteger columnOffset;
+@property (nonatomic, strong) MMSpreadsheetRowOrder *rowOrder;
+@property (nonatomic, strong) MMSpreadsheetSelection *selection;
+@property (nonatomic, strong) UIColor *selectionColor;
+@property (nonatomic, strong) MMSpreadsheetSearchOperation *search;
+@property (nonatomic, strong) UIColor *searchHighlightColor;
+@property (nonatomic, strong) MMSpreadsheetMergedCells *mergedCells;
+
+@end
+
+@implementation MMSpreadsheetTileGeometry
+
+- (instancetype)init
+{
+    self = [super init];
+    if (self) {
+        MMGridAxisInit(&_rowAxis);
+        MMGridAxisInit(&_columnAxis);
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    MMGridAxisFree(&_rowAxis);
+    MMGridAxisFree(&_columnAxis);
+}
+
+// Offsets are logical and may be too large for a CGFloat, so frames are made relative to an origin given as doubles.
+- (CGRect)frameForItemAtRow:(NSInteger)row column:(NSInteger)column originX:(double)originX originY:(double)originY
+{
+    return CGRectMake(MMGridAxisOffset(&_columnAxis, column) - originX,
+                      MMGridAxisOffset(&_rowAxis, row) - originY,
+                      MMGridAxisSize(&_columnAxis, column) - self.cellSpacing,
+                      MMGridAxisSize(&_rowAxis, row) - self.cellSpacing);
+}
+
+- (CGRect)frameForMergedCell:(MMGridSpan)span originX:(double)originX originY:(double)originY
+{
+    CGRect firstFrame = [self frameForItemAtRow:span.row column:span.column originX:originX originY:originY];
+    CGRect lastFrame = [self frameForItemAtRow:span.row + span.rowCount - 1 column:span.column + span.columnCount - 1 originX:originX originY:originY];
+    return CGRectUnion(firstFrame, lastFrame);
+}
+
+// Finds the merged cell covering a pane cell, both as given by the data source and clipped to the pane in pane rows and columns.
+- (BOOL)getMergedCell:(MMGridSpan *)mergedCell paneCell:(MMGridSpan *)paneCell forRow:(NSInteger)row column:(NSInteger)column
+{
+    NSInteger displayRow = row + self.rowOffset;
+    if (self.mergedCells == nil || (self.rowOrder && displayRow >= self.rowOrder.fixedRowCount)) {
+        return NO;
+    }
+    MMGridSpan span;
+    if (![self.mergedCells getSpan:&span containingRow:displayRow column:column + self.columnOffset]) {
+        return NO;
+    }
+    // Sorted rows only keep the merged cells within the header rows, which are never moved.
+    if (self.rowOrder && span.row + span.rowCount > self.rowOrder.fixedRowCount) {
+        return NO;
+    }
+    MMGridRange paneRows = { self.rowOffset, _rowAxis.count };
+    MMGridRange paneColumns = { self.columnOffset, _columnAxis.count };
+    if (!MMGridSpanClip(span, paneRows, paneColumns, paneCell)) {
+        return NO;
+    }
+    paneCell->row -= self.rowOffset;
+    paneCell->column -= self.columnOffset;
+    *mergedCell = span;
+    return YES;
+}
+
+- (CGRect)rectForTileAtRow:(NSInteger)tileRow column:(NSInteger)tileColumn originX:(double)originX originY:(double)originY
+{
+    return CGRectMake((double)tileColumn * self.tileSize - originX, (double)tileRow * self.tileSize - originY, self.tileSize, self.tileSize);
+}
+
+@end
+
+@interface MMSpreadsheetTileView ()
+
+@property (nonatomic, weak) MMSpreadsheetView *spreadsheetView;
+@property (nonatomic, weak) UICollectionView *collectionView;
+@property (nonatomic, strong) MMSpreadsheetTileGeometry *geometry;
+@property (nonatomic, strong) NSCache *tileCache;
+@property (nonatomic, strong) NSOperationQueue *renderQueue;
+@property (nonatomic, strong) NSMutableDictionary *renderOperations;
+@property (nonatomic, strong) NSMutableDictionary *visibleLayers;
+@property (nonatomic, strong) NSMutableArray *reusableLayers;
+@property (nonatomic, assign) double layerOriginX;
+@property (nonatomic, assign) double layerOriginY;
+
+@end
+
+@implementation MMSpreadsheetTileView
+
+- (instancetype)initWithSpreadsheetView:(MMSpreadsheetView *)spreadsheetView collectionView:(UICollectionView *)collectionView
+{
+    self = [super initWithFrame:CGRectZero];
+    if (self) {
+        _spreadsheetView = spreadsheetView;
+        _collectionView = collectionView;
+        _tileSize = MMSpreadsheetTileViewDefaultTileSize;
+        // A fixed color rather than tintColor, which iOS 6 does not have.
+        _selectionColor = [UIColor colorWithRed:0.0f green:122.0f / 255.0f blue:1.0f alpha:1.0f];
+        _tileCache = [[NSCache alloc] init];
+        _tileCache.totalCostLimit = MMSpreadsheetTileViewCacheCostLimit;
+        _renderQueue = [[NSOperationQueue alloc] init];
+        _renderQueue.maxConcurrentOperationCount = MAX((NSInteger)[[NSProcessInfo processInfo] activeProcessorCount], 1);
+        _renderOperations = [NSMutableDictionary dictionary];
+        _visibleLayers = [NSMutableDictionary dictionary];
+        _reusableLayers = [NSMutableArray array];
+        self.backgroundColor = [UIColor clearColor];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_renderQueue cancelAllOperations];
+}
+
+- (void)setTileSize:(CGFloat)tileSize
+{
+    NSParameterAssert(tileSize > 0.0f);
+    if (_tileSize != tileSize) {
+        _tileSize = tileSize;
+        [self invalidateAllTiles];
+    }
+}
+
+- (void)setRowOrder:(MMSpreadsheetRowOrder *)rowOrder
+{
+    if (_rowOrder != rowOrder) {
+        _rowOrder = rowOrder;
+        [self invalidateAllTiles];
+    }
+}
+
+- (void)setMergedCells:(MMSpreadsheetMergedCells *)mergedCells
+{
+    if (_mergedCells != mergedCells) {
+        _mergedCells = mergedCells;
+        [self invalidateAllTiles];
+    }
+}
+
+- (void)setSearch:(MMSpreadsheetSearchOperation *)search
+{
+    if (_search != search) {
+        // A search of appended rows keeps the matches already drawn.
+        BOOL sharesMatches = [search sharesMatchesWithSearch:_search];
+        _search = search;
+        if (!sharesMatches) {
+            [self invalidateAllTiles];
+        }
+    }
+}
+
+- (void)setSearchHighlightColor:(UIColor *)searchHighlightColor
+{
+    _searchHighlightColor = searchHighlightColor;
+    if (self.search) {
+        [self invalidateAllTiles];
+    }
+}
+
+- (void)setSelection:(MMSpreadsheetSelection *)selection
+{
+    if (_selection != selection) {
+        _selection = [selection copy];
+        [self invalidateAllTiles];
+    }
+}
+
+- (void)setSelectionColor:(UIColor *)selectionColor
+{
+    _selectionColor = selectionColor;
+    if (self.selection && ![self.selection isEmpty]) {
+        [self invalidateAllTiles];
+    }
+}
+
+#pragma mark - Invalidation
+
+- (void)invalidateAllTiles
+{
+    // Renders that are already running finish, but their images are thrown away.
+    self.geometry = nil;
+    [self.renderQueue cancelAllOperations];
+    [self.renderOperations removeAllObjects];
+    [self.tileCache removeAllObjects];
+    // Wait for the next layout pass, so a collection view in the middle of an update has its new counts.
+    [self setNeedsLayout];
+}
+
+- (void)invalidateTilesForItemsAtIndexPaths:(NSArray *)indexPaths
+{
+    MMSpreadsheetTileGeometry *geometry = self.geometry;
+    if (geometry == nil) {
+        return;
+    }
+    for (NSIndexPath *indexPath in indexPaths) {
+        if (indexPath.section >= geometry->_rowAxis.count || indexPath.item >= geometry->_columnAxis.count) {
+            continue;
+        }
+        // A merged cell is drawn across every tile it covers.
+        MMGridSpan cells = { indexPath.section, indexPath.item, 1, 1 };
+        MMGridSpan mergedCell;
+        [geometry getMergedCell:&mergedCell paneCell:&cells forRow:indexPath.section column:indexPath.item];
+        NSInteger firstTileRow = floor(MMGridAxisOffset(&geometry->_rowAxis, cells.row) / geometry.tileSize);
+        NSInteger lastTileRow = floor(MMGridAxisOffset(&geometry->_rowAxis, cells.row + cells.rowCount) / geometry.tileSize);
+        NSInteger firstTileColumn = floor(MMGridAxisOffset(&geometry->_columnAxis, cells.column) / geometry.tileSize);
+        NSInteger lastTileColumn = floor(MMGridAxisOffset(&geometry->_columnAxis, cells.column + cells.columnCount) / geometry.tileSize);
+        for (NSInteger tileRow = firstTileRow; tileRow <= lastTileRow; tileRow++) {
+            for (NSInteger tileColumn = firstTileColumn; tileColumn <= lastTileColumn; tileColumn++) {
+                NSIndexPath *key = [NSIndexPath indexPathForItem:tileColumn inSection:tileRow];
+                [self.tileCache removeObjectForKey:key];
+                [self.renderOperations[key] cancel];
+                [self.renderOperations removeObjectForKey:key];
+            }
+        }
+    }
+    [self updateVisibleTiles];
+}
+
+- (void)invalidateTilesForRowsAppendedAtRow:(NSInteger)row
+{
+    MMSpreadsheetTileGeometry *geometry = self.geometry;
+    if (geometry == nil) {
+        // Nothing has been drawn since every tile was last discarded.
+        return;
+    }
+    // Tiles are only drawn over the content, so none lie below the tile the old last row ends in.
+    NSInteger firstTileRow = floor(MMGridAxisOffset(&geometry->_rowAxis, MIN(MAX(row, 0), geometry->_rowAxis.count)) / geometry.tileSize);
+    NSInteger lastTileRow = floor(MMGridAxisLength(&geometry->_rowAxis) / geometry.tileSize);
+    NSInteger lastTileColumn = floor(MMGridAxisLength(&geometry->_columnAxis) / geometry.tileSize);
+    self.geometry = nil;
+    for (NSInteger tileRow = firstTileRow; tileRow <= lastTileRow; tileRow++) {
+        for (NSInteger tileColumn = 0; tileColumn <= lastTileColumn; tileColumn++) {
+            NSIndexPath *key = [NSIndexPath indexPathForItem:tileColumn inSection:tileRow];
+            [self.tileCache removeObjectForKey:key];
+            [self.renderOperations[key] cancel];
+            [self.renderOperations removeObjectForKey:key];
+        }
+    }
+    // Wait for the next layout pass, so a collection view in the middle of an update has its new counts.
+    [self setNeedsLayout];
+}
+
+#pragma mark - Visible Tiles
+
+- (void)layoutSubviews
+{
+    [super layoutSubviews];
+    [self updateVisibleTiles];
+}
+
+- (MMSpreadsheetTileGeometry *)currentGeometry
+{
+    if (self.geometry == nil) {
+        MMGridLayout *layout = (MMGridLayout *)self.collectionView.collectionViewLayout;
+        MMSpreadsheetTileGeometry *geometry = [[MMSpreadsheetTileGeometry alloc] init];
+        if (![layout copyRowAxis:&geometry->_rowAxis columnAxis:&geometry->_columnAxis]) {
+            return nil;
+        }
+        geometry.cellSpacing = layout.cellSpacing;
+        geometry.tileSize = self.tileSize;
+        geometry.scale = [UIScreen mainScreen].scale;
+        geometry.rowOffset = self.rowOffset;
+        geometry.columnOffset = self.columnOffset;
+        geometry.rowOrder = self.rowOrder;
+        geometry.selection = [self.selection isEmpty] ? nil : self.selection;
+        geometry.selectionColor = [self.selectionColor colorWithAlphaComponent:MMSpreadsheetTileViewSelectionAlpha];
+        geometry.search = self.search;
+        geometry.searchHighlightColor = self.searchHighlightColor;
+        geometry.mergedCells = [self.mergedCells count] > 0 ? self.mergedCells : nil;
+        self.geometry = geometry;
+    }
+    return self.geometry;
+}
+
+- (void)updateVisibleTiles
+{
+    MMSpreadsheetTileGeometry *geometry = [self currentGeometry];
+    if (geometry == nil || self.collectionView == nil) {
+        return;
+    }
+
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+
+    // Tiles are keyed by their logical position, so moving a virtual window only moves the layers.
+    MMGridLayout *layout = (MMGridLayout *)self.collectionView.collectionViewLayout;
+    double originX = layout.columnOrigin;
+    double originY = layout.rowOrigin;
+    BOOL originChanged = originX != self.layerOriginX || originY != self.layerOriginY;
+    self.layerOriginX = originX;
+    self.layerOriginY = originY;
+
+    CGRect frame = (CGRect){CGPointZero, layout.collectionViewContentSize};
+    if (!CGRectEqualToRect(self.frame, frame)) {
+        self.frame = frame;
+    }
+
+    // Keep half a tile around the visible rect so tiles are ready just before they scroll in.
+    CGFloat margin = geometry.tileSize / 2.0f;
+    CGRect wantedRect = CGRectIntersection(CGRectInset(self.collectionView.bounds, -margin, -margin), self.bounds);
+    NSMutableSet *wantedKeys = [NSMutableSet set];
+    if (!CGRectIsNull(wantedRect) && !CGRectIsEmpty(wantedRect)) {
+        NSInteger firstTileRow = floor((originY + CGRectGetMinY(wantedRect)) / geometry.tileSize);
+        NSInteger lastTileRow = ceil((originY + CGRectGetMaxY(wantedRect)) / geometry.tileSize) - 1;
+        NSInteger firstTileColumn = floor((originX + CGRectGetMinX(wantedRect)) / geometry.tileSize);
+        NSInteger lastTileColumn = ceil((originX + CGRectGetMaxX(wantedRect)) / geometry.tileSize) - 1;
+        for (NSInteger tileRow = firstTileRow; tileRow <= lastTileRow; tileRow++) {
+            for (NSInteger tileColumn = firstTileColumn; tileColumn <= lastTileColumn; tileColumn++) {
+                [wantedKeys addObject:[NSIndexPath indexPathForItem:tileColumn inSection:tileRow]];
+            }
+        }
+    }
+
+    for (NSIndexPath *key in [self.visibleLayers allKeys]) {
+        if (![wantedKeys containsObject:key]) {
+            CALayer *layer = self.visibleLayers[key];
+            [layer removeFromSuperlayer];
+            layer.contents = nil;
+            [self.reusableLayers addObject:layer];
+            [self.visibleLayers removeObjectForKey:key];
+        }
+    }
+    for (NSIndexPath *key in [self.renderOperations allKeys]) {
+        if (![wantedKeys containsObject:key]) {
+            [self.renderOperations[key] cancel];
+            [self.renderOperations removeObjectForKey:key];
+        }
+    }
+
+    if (originChanged) {
+        [self.visibleLayers enumerateKeysAndObjectsUsingBlock:^(NSIndexPath *key, CALayer *layer, BOOL *stop) {
+            layer.frame = [geometry rectForTileAtRow:key.section column:key.item originX:originX originY:originY];
+        }];
+    }
+
+    for (NSIndexPath *key in wantedKeys) {
+        CALayer *layer = self.visibleLayers[key];
+        if (layer == nil) {
+            layer = [self.reusableLayers lastObject];
+            if (layer) {
+                [self.reusableLayers removeLastObject];
+            }
+            else {
+                layer = [CALayer layer];
+                layer.contentsScale = geometry.scale;
+            }
+            layer.frame = [geometry rectForTileAtRow:key.section column:key.item originX:originX originY:originY];
+            [self.layer addSublayer:layer];
+            self.visibleLayers[key] = layer;
+        }
+
+        // A stale image stays up until its replacement is ready, which looks better than a blank tile.
+        UIImage *image = [self.tileCache objectForKey:key];
+        if (image) {
+            layer.contents = (__bridge id)image.CGImage;
+        }
+        else if (self.renderOperations[key] == nil) {
+            [self renderTileForKey:key geometry:geometry];
+        }
+    }
+
+    [CATransaction commit];
+}
+
+#pragma mark - Rendering
+
+- (void)renderTileForKey:(NSIndexPath *)key geometry:(MMSpreadsheetTileGeometry *)geometry
+{
+    id<MMSpreadsheetViewValueDataSource> valueDataSource = self.valueDataSource;
+    MMSpreadsheetView *spreadsheetView = self.spreadsheetView;
+    if (valueDataSource == nil) {
+        return;
+    }
+
+    __weak MMSpreadsheetTileView *weakSelf = self;
+    NSBlockOperation *operation = [[NSBlockOperation alloc] init];
+    __weak NSBlockOperation *weakOperation = operation;
+    [operation addExecutionBlock:^{
+        UIImage *image = [MMSpreadsheetTileView imageForTileAtRow:key.section
+                                                           column:key.item
+                                                         geometry:geometry
+                                                  spreadsheetView:spreadsheetView
+                                                  valueDataSource:valueDataSource
+                                                        operation:weakOperation];
+        NSOperation *finishedOperation = weakOperation;
+        if (image && finishedOperation) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [weakSelf tileDidRender:image forKey:key operation:finishedOperation];
+            });
+        }
+    }];
+    self.renderOperations[key] = operation;
+    [self.renderQueue addOperation:operation];
+}
+
+- (void)tileDidRender:(UIImage *)image forKey:(NSIndexPath *)key operation:(NSOperation *)operation
+{
+    // Only the latest render of a tile counts. Earlier ones were cancelled by an invalidation.
+    if (self.renderOperations[key] != operation) {
+        return;
+    }
+    [self.renderOperations removeObjectForKey:key];
+    CGImageRef imageRef = image.CGImage;
+    [self.tileCache setObject:image forKey:key cost:CGImageGetBytesPerRow(imageRef) * CGImageGetHeight(imageRef)];
+
+    CALayer *layer = self.visibleLayers[key];
+    if (layer) {
+        [CATransaction begin];
+        [CATransaction setDisableActions:YES];
+        layer.contents = (__bridge id)imageRef;
+        [CATransaction commit];
+    }
+}
+
++ (UIImage *)imageForTileAtRow:(NSInteger)tileRow
+                        column:(NSInteger)tileColumn
+                      geometry:(MMSpreadsheetTileGeometry *)geometry
+               spreadsheetView:(MMSpreadsheetView *)spreadsheetView
+               valueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+                     operation:(NSOperation *)operation
+{
+    // Drawing is done relative to the tile so logical offsets never pass through a CGFloat.
+    double tileMinX = (double)tileColumn * geometry.tileSize;
+    double tileMinY = (double)tileRow * geometry.tileSize;
+    CGRect tileRect = CGRectMake(0.0f, 0.0f, geometry.tileSize, geometry.tileSize);
+    MMGridRange rows = MMGridAxisRangeForSpan(&geometry->_rowAxis, tileMinY, tileMinY + geometry.tileSize);
+    MMGridRange columns = MMGridAxisRangeForSpan(&geometry->_columnAxis, tileMinX, tileMinX + geometry.tileSize);
+
+    UIGraphicsBeginImageContextWithOptions(tileRect.size, NO, geometry.scale);
+
+    BOOL cancelled = NO;
+    for (NSInteger row = rows.location; row < rows.location + rows.length && !cancelled; row++) {
+        cancelled = operation.isCancelled;
+        for (NSInteger column = columns.location; column < columns.location + columns.length && !cancelled; column++) {
+            CGRect frame = [geometry frameForItemAtRow:row column:column originX:tileMinX originY:tileMinY];
+            NSInteger displayRow = row + geometry.rowOffset;
+            NSInteger dataColumn = column + geometry.columnOffset;
+            MMGridSpan mergedCell;
+            MMGridSpan paneCell;
+            if ([geometry getMergedCell:&mergedCell paneCell:&paneCell forRow:row column:column]) {
+                // Drawn whole from the first of its cells in the tile, and clipped by the tile, so its text lines up across tiles.
+                if (row != MAX(paneCell.row, rows.location) || column != MAX(paneCell.column, columns.location)) {
+                    continue;
+                }
+                frame = [geometry frameForMergedCell:paneCell originX:tileMinX originY:tileMinY];
+                displayRow = mergedCell.row;
+                dataColumn = mergedCell.column;
+            }
+            if (!CGRectIntersectsRect(frame, tileRect)) {
+                continue;
+            }
+            NSInteger dataRow = geometry.rowOrder ? [geometry.rowOrder dataRowForDisplayRow:displayRow] : displayRow;
+            NSIndexPath *indexPath = [NSIndexPath indexPathForItem:dataColumn inSection:dataRow];
+            MMSpreadsheetCellValue *value = [valueDataSource spreadsheetView:spreadsheetView valueForItemAtIndexPath:indexPath];
+            [self drawValue:value inRect:frame];
+            // Matches found after the geometry was made are read too, since the search is safe to read while it runs.
+            if (geometry.searchHighlightColor && [geometry.search containsRow:displayRow column:dataColumn]) {
+                [geometry.searchHighlightColor setFill];
+                UIRectFillUsingBlendMode(frame, kCGBlendModeNormal);
+            }
+            if (geometry.selectionColor && [geometry.selection containsRow:displayRow column:dataColumn]) {
+                [geometry.selectionColor setFill];
+                UIRectFillUsingBlendMode(frame, kCGBlendModeNormal);
+            }
+        }
+    }
+
+    UIImage *image = cancelled ? nil : UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    return image;
+}
+
++ (void)drawValue:(MMSpreadsheetCellValue *)value inRect:(CGRect)rect
+{
+    if (value == nil) {
+        return;
+    }
+    if (value.backgroundColor) {
+        [value.backgroundColor setFill];
+        UIRectFill(rect);
+    }
+    if ([value.text length] == 0) {
+        return;
+    }
+
+    NSMutableParagraphStyle *paragraphStyle = [[NSMutableParagraphStyle alloc] init];
+    paragraphStyle.alignment = value.textAlignment;
+    paragraphStyle.lineBreakMode = NSLineBreakByTruncatingTail;
+    NSMutableDictionary *attributes = [NSMutableDictionary dictionary];
+    attributes[NSParagraphStyleAttributeName] = paragraphStyle;
+    if (value.font) {
+        attributes[NSFontAttributeName] = value.font;
+    }
+    if (value.textColor) {
+        attributes[NSForegroundColorAttributeName] = value.textColor;
+    }
+
+    CGFloat lineHeight = value.font ? value.font.lineHeight : 0.0f;
+    CGRect textRect = CGRectInset(rect, MMSpreadsheetTileViewTextInset, 0.0f);
+    textRect.origin.y = CGRectGetMidY(rect) - lineHeight / 2.0f;
+    textRect.size.height = lineHeight;
+
+    CGContextRef context = UIGraphicsGetCurrentContext();
+    CGContextSaveGState(context);
+    CGContextClipToRect(context, rect);
+    [[[NSAttributedString alloc] initWithString:value.text attributes:attributes] drawInRect:textRect];
+    CGContextRestoreGState(context);
+}
+
+#pragma mark - Hit Testing
+
+- (NSIndexPath *)indexPathForItemAtPoint:(CGPoint)point
+{
+    MMSpreadsheetTileGeometry *geometry = [self currentGeometry];
+    if (geometry == nil || !CGRectContainsPoint(self.bounds, point)) {
+        return nil;
+    }
+    long row = MMGridAxisIndexForOffset(&geometry->_rowAxis, self.layerOriginY + point.y);
+    long column = MMGridAxisIndexForOffset(&geometry->_columnAxis, self.layerOriginX + point.x);
+    if (row < 0 || column < 0) {
+        return nil;
+    }
+    return [NSIndexPath indexPathForItem:column inSection:row];
+}
+
+@end
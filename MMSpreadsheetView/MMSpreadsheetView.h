@@ -19,6 +19,14 @@
 // THE SOFTWARE.
 
 #import <UIKit/UIKit.h>
+#import "MMSpreadsheetViewMetrics.h"
+#import "MMGridGeometry.h"
+#import "MMSpreadsheetCellValue.h"
+#import "MMSpreadsheetSelection.h"
+#import "MMSpreadsheetExportOperation.h"
+#import "MMSpreadsheetColumnSummary.h"
+#import "MMSpreadsheetSearchOperation.h"
+#import "MMSpreadsheetColumnFitOperation.h"
 
 @class MMSpreadsheetView;
 
@@ -39,7 +47,9 @@
 ///---------------------------------------
 
 /**
- The cell size for all cells in a collection view. Header cells can have a different size than non-header cells, but all cells within a single collection view (or spreadsheet view section) will be the same size.
+ The cell size for a cell in the spreadsheet view. Each row may have its own height and each column its own width. The height of a row is taken from the cell in column 0 of that row, and the width of a column from the cell in row 0 of that column, so all cells in a row share a height and all cells in a column share a width.
+ 
+ Sizes and counts are read once into a snapshot that all panes share. They are read again only when the spreadsheet view is told the data changed, through reloadData or the insert, delete and reload methods.
  
  @param spreadsheetView The spreadsheet view object that is requesting the size information.
  @param indexPath The index path of the cell.
@@ -48,6 +58,53 @@
  */
 - (CGSize)spreadsheetView:(MMSpreadsheetView *)spreadsheetView sizeForItemAtIndexPath:(NSIndexPath *)indexPath;
 
+/**
+ The height shared by every row of the spreadsheet view, header rows included.
+ 
+ Implement this when all rows are the same height. Row heights are then not read from spreadsheetView:sizeForItemAtIndexPath:, and neither the snapshot nor the layouts keep a table of them, so a sheet with millions of rows costs no memory per row. Column widths are still read per column.
+ 
+ @param spreadsheetView The spreadsheet view object that is requesting the information.
+ 
+ @return The height of every row, or 0 to have each row's height read from spreadsheetView:sizeForItemAtIndexPath:.
+ */
+- (CGFloat)uniformRowHeightInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView;
+
+/**
+ The number of merged cells in the spreadsheet view. A merged cell shows a block of cells as one cell, and may cross the header rows and columns.
+ 
+ Merged cells are read into the snapshot along with the sizes, and are indexed so only the ones on screen are looked at while scrolling. They are read again by reloadData; inserting and deleting rows or columns moves them instead, growing or shrinking a merged cell that the change falls inside.
+ 
+ @param spreadsheetView The spreadsheet view object that is requesting the information.
+ 
+ @return The number of merged cells.
+ */
+- (NSInteger)numberOfMergedCellsInSpreadsheetView:(MMSpreadsheetView *)spreadsheetView;
+
+/**
+ A merged cell of the spreadsheet view. Merged cells must not overlap, and are clipped to the grid.
+ 
+ The data source is asked for the cell at the top-left index path of a merged cell, and the cell is stretched over the whole block. Where a merged cell crosses the edge of the header rows or columns, each pane shows its own part of it, configured from the same index path.
+ 
+ While rows are sorted or filtered, only merged cells that lie within the header rows are shown.
+ 
+ @param spreadsheetView The spreadsheet view object that is requesting the information.
+ @param index The index of the merged cell, from 0 to numberOfMergedCellsInSpreadsheetView: - 1.
+ 
+ @return The block of data source rows and columns the cell covers.
+ */
+- (MMGridSpan)spreadsheetView:(MMSpreadsheetView *)spreadsheetView mergedCellAtIndex:(NSInteger)index;
+
+/**
+ Updates a cell that is already on screen with the current value of its item, for changes reported through -`itemValueDidChangeAtRow:column:`.
+ 
+ The cell is the one the data source returned from -`spreadsheetView:cellForItemAtIndexPath:` for this index path, so only the views that show the value need to change. Live updates never reload a cell, so without this method changes to cells on screen are not shown until the cells are configured again, and they are counted as dropped.
+ 
+ @param spreadsheetView The spreadsheet view object that is updating the cell.
+ @param cell The cell to update.
+ @param indexPath The index path of the cell.
+ */
+- (void)spreadsheetView:(MMSpreadsheetView *)spreadsheetView configureCell:(UICollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath;
+
 @required
 
 /**
@@ -84,6 +141,120 @@
 
 
 
+/**
+ An object that adopts the `MMSpreadsheetViewDataSourcePrefetching` protocol is told which cells are about to come on screen, so it can start loading their data before the spreadsheet view asks for the cells.
+ 
+ When the user flings the spreadsheet view, the spreadsheet view uses the offset the scroll will come to rest at, plus a lookahead in the direction of travel, to work out the rows and columns that will be visible when the scroll ends. Use this to begin fetching or formatting cell contents on a background queue so `spreadsheetView:cellForItemAtIndexPath:` does not have to block on them.
+ 
+ When configuring the spreadsheet view object, assign your prefetching object to its prefetchDataSource property.
+ @warning Ranges use data source rows and columns, the same as *indexPath.mmSpreadsheetRow* and *indexPath.mmSpreadsheetColumn*.
+ */
+@protocol MMSpreadsheetViewDataSourcePrefetching <NSObject>
+
+@required
+
+///---------------------------------------
+/// @name Prefetching Data
+///---------------------------------------
+
+/**
+ Tells the prefetching object to begin preparing data for the cells in the given rows and columns.
+ 
+ @param spreadsheetView The spreadsheet view object that is making the request.
+ @param rows The range of rows that is about to become visible.
+ @param columns The range of columns that is about to become visible.
+ @discussion This is called from scrollViewWillEndDragging:withVelocity:targetContentOffset: when the user lifts their finger with some velocity. Header rows and columns are always visible, so they are not included.
+ */
+- (void)spreadsheetView:(MMSpreadsheetView *)spreadsheetView prefetchItemsInRows:(NSRange)rows columns:(NSRange)columns;
+
+@optional
+
+/**
+ Tells the prefetching object that a previous prefetch is no longer needed.
+ 
+ @param spreadsheetView The spreadsheet view object that is making the request.
+ @param rows The range of rows passed to the earlier prefetch.
+ @param columns The range of columns passed to the earlier prefetch.
+ @discussion This is called when the user touches the spreadsheet view again before the scroll came to rest, or when a new fling replaces the previous target. Cells that did scroll on screen are not cancelled.
+ */
+- (void)spreadsheetView:(MMSpreadsheetView *)spreadsheetView cancelPrefetchingForItemsInRows:(NSRange)rows columns:(NSRange)columns;
+
+@end
+
+
+
+
+
+/**
+ An object that adopts the `MMSpreadsheetViewValueDataSource` protocol supplies plain cell values, so the spreadsheet view can draw its content cells into tiles instead of creating a `UICollectionViewCell` for each one.
+ 
+ This suits dense sheets of small cells, where a view per cell makes scrolling slow. The content pane (the cells below the header rows and right of the header columns, or every cell other than the frozen headers when usesSingleScrollView is YES) is drawn as fixed-size tiles. Tiles are rasterized on background threads and cached, so scrolling only moves a few layers. Header cells still come from `spreadsheetView:cellForItemAtIndexPath:`.
+ 
+ When configuring the spreadsheet view object, assign your value data source to its valueDataSource property.
+ @warning `spreadsheetView:valueForItemAtIndexPath:` is called on background threads, several at a time. It must be safe to call concurrently and must not touch UIKit views.
+ */
+@protocol MMSpreadsheetViewValueDataSource <NSObject>
+
+@required
+
+///---------------------------------------
+/// @name Providing Cell Values
+///---------------------------------------
+
+/**
+ The value to draw for a content cell.
+ 
+ @param spreadsheetView The spreadsheet view object that is requesting the value.
+ @param indexPath The index path of the cell, using *indexPath.mmSpreadsheetRow* and *indexPath.mmSpreadsheetColumn*.
+ 
+ @return The value to draw, or nil to leave the cell empty.
+ */
+- (MMSpreadsheetCellValue *)spreadsheetView:(MMSpreadsheetView *)spreadsheetView valueForItemAtIndexPath:(NSIndexPath *)indexPath;
+
+@end
+
+
+
+
+
+/**
+ An object that adopts the `MMSpreadsheetViewSummaryDataSource` protocol supplies the numbers behind the summary footer, a frozen row below the content that shows a sum, average, minimum, maximum or count for each column.
+ 
+ Each column's numbers are handed over once as a buffer of doubles, one per data source row. The spreadsheet view summarizes the rows below the header rows in blocks, and after an edit only the blocks holding the changed values are summarized again. Tell it about edits with summaryValuesDidChangeInRows:column:.
+ 
+ When configuring the spreadsheet view object, assign your summary data source to its summaryDataSource property and set showsSummaryFooter to YES.
+ */
+@protocol MMSpreadsheetViewSummaryDataSource <NSObject>
+
+@required
+
+///---------------------------------------
+/// @name Providing Column Values
+///---------------------------------------
+
+/**
+ The numbers of a column.
+ 
+ @param spreadsheetView The spreadsheet view object that is requesting the values.
+ @param column The data source column.
+ 
+ @return A buffer of doubles, one per data source row, or nil to leave the column without a summary. Use NaN for blank cells. The buffer is kept and read again after each change, so it may be mutable data you edit in place, but it must not be shorter than the row count.
+ */
+- (NSData *)spreadsheetView:(MMSpreadsheetView *)spreadsheetView summaryValuesForColumn:(NSInteger)column;
+
+@optional
+
+/**
+ The summary to show below a column. Defaults to MMSpreadsheetSummaryFunctionSum.
+ */
+- (MMSpreadsheetSummaryFunction)spreadsheetView:(MMSpreadsheetView *)spreadsheetView summaryFunctionForColumn:(NSInteger)column;
+
+@end
+
+
+
+
+
 /**
  
  The `MMSpreadsheetViewDelegate` protocol defines methods that allow you to manage the selection and highlighting of items in a spreadsheet view and to perform actions on those items. The methods of this protocol are all optional.
@@ -193,7 +364,7 @@
  @discussion **Note**: Set the background color of the spreadsheet view to change the separator line color. **However**, you will also see this color when the scroll goes into a bounce.
  
  @warning An NSIndexPath category is provided so that *indexPath.mmSpreadsheetRow* represents a row and *indexPath.mmSpreadsheetColumn* represents a column.
- @warning as the number of cells shown increases, scrolling performance declines. A large grid (1000x1000) takes a long time to initialize, but if the cell sizes are large enough (150x150), scrolling performance is not affected. However, a small grid (50x50) of (20x20) cells basically doesn't scroll.
+ @warning as the number of cells shown increases, scrolling performance declines. A large grid (1000x1000) takes a long time to initialize, but if the cell sizes are large enough (150x150), scrolling performance is not affected. However, a small grid (50x50) of (20x20) cells basically doesn't scroll. For dense grids of small cells, set a valueDataSource so the content cells are drawn as tiles instead.
  */
 @interface MMSpreadsheetView : UIView
 
@@ -217,6 +388,27 @@
  */
 @property (nonatomic, weak) id<MMSpreadsheetViewDataSource> dataSource;
 
+/**
+ The object that acts as the prefetching data source for the spreadsheet view.
+ 
+ @discussion The object must adopt the `MMSpreadsheetViewDataSourcePrefetching` protocol. The spreadsheet view maintains a weak reference to this object. The default value is nil, which turns prefetching off.
+ */
+@property (nonatomic, weak) id<MMSpreadsheetViewDataSourcePrefetching> prefetchDataSource;
+
+/**
+ The object that supplies cell values for tiled rendering of the content pane.
+ 
+ @discussion The object must adopt the `MMSpreadsheetViewValueDataSource` protocol. The spreadsheet view maintains a weak reference to this object. When it is set, content cells are drawn into tiles on background threads instead of being dequeued from the data source, and taps on them are still reported through spreadsheetView:didSelectItemAtIndexPath:. The default value is nil, which uses cells for everything.
+ */
+@property (nonatomic, weak) id<MMSpreadsheetViewValueDataSource> valueDataSource;
+
+/**
+ The object that supplies the numbers for the summary footer.
+ 
+ @discussion The object must adopt the `MMSpreadsheetViewSummaryDataSource` protocol. The spreadsheet view maintains a weak reference to this object. Setting it discards any computed summaries.
+ */
+@property (nonatomic, weak) id<MMSpreadsheetViewSummaryDataSource> summaryDataSource;
+
 /**
  The identifier that determines whether the view supports state restoration.
  
@@ -226,6 +418,39 @@
 @property (nonatomic, copy) NSString *restorationIdentifier;
 
 
+/**
+ A Boolean value that determines whether the spreadsheet view uses one scroll view with frozen header cells instead of up to four synchronized collection views.
+ 
+ @discussion By default, header rows and columns live in their own collection views, and scrolling one pane moves the others to match. When this property is YES, the whole sheet is laid out in a single collection view and the header rows and columns are pinned in place by the layout, which avoids the extra layout passes and offset syncing between panes while scrolling. The rest of the spreadsheet view API behaves the same in either mode.
+ 
+ Changing this value rebuilds the spreadsheet view's subviews. Registered cell classes, the data source and the scroll view properties carry over. The default value is NO.
+ */
+@property (nonatomic, assign) BOOL usesSingleScrollView;
+
+/**
+ A Boolean value that determines whether the spreadsheet view scrolls over a bounded window of its content instead of the full content size.
+ 
+ @discussion Turn this on for sheets that are millions of points tall or wide. At that size float coordinates can no longer place rows exactly, and scroll views misbehave. In this mode each pane's `MMGridLayout` lays out long axes relative to a movable origin, and the spreadsheet view recenters that window on the visible cells as they approach its edges. The logical scroll position is kept as a double. Every pane and both scroll indicators follow the logical position, so a recenter is not visible. Sheets that fit in the window scroll exactly as they do without this mode. The default value is NO.
+ */
+@property (nonatomic, assign) BOOL usesVirtualCoordinates;
+
+/**
+ The horizontal scroll position of the content pane in logical coordinates, measured from its first column. This is exact even when usesVirtualCoordinates is set and the collection view's content offset is relative to a window.
+ */
+@property (nonatomic, readonly) double virtualContentOffsetX;
+
+/**
+ The vertical scroll position of the content pane in logical coordinates, measured from its first row. See virtualContentOffsetX.
+ */
+@property (nonatomic, readonly) double virtualContentOffsetY;
+
+/**
+ The object that collects scroll performance metrics for the spreadsheet view.
+ 
+ @discussion When set, the spreadsheet view times layout passes for each pane and each call into the data source, counts cells dequeued per frame and counts the content offset syncs between panes during each scroll event. See `MMSpreadsheetViewMetrics`. The default value is nil, which turns metrics off.
+ */
+@property (nonatomic, strong) MMSpreadsheetViewMetrics *metrics;
+
 ///---------------------------------------
 /// @name Initializing & Setup
 ///---------------------------------------
@@ -274,6 +499,17 @@
  */
 - (UICollectionViewCell *)dequeueReusableCellWithReuseIdentifier:(NSString *)identifier forIndexPath:(NSIndexPath *)indexPath;
 
+/**
+ Creates the cells each pane needs for its current bounds, plus one more screenful in each direction it scrolls, before they are first displayed.
+ 
+ @param spread YES to warm one pane per run loop turn, in the default run loop mode, so the work waits while the user is scrolling. NO to warm every pane now.
+ @param completion Called on the main thread once every pane has been warmed, with a report in the format described under `MMSpreadsheetViewMetricsPrewarmKey`. It is not called if the data source or the scroll mode changes first. This parameter may be nil.
+ @discussion Each pane is its own collection view with its own reuse queue, so cells cannot be shared between panes, and the first scroll after setDataSource: creates cells in all of them at once. Warming lays each pane out over the larger area, which asks the data source for those cells, then shrinks it back so the cells that are not on screen wait in the pane's reuse queue. The number of cells each pane needs is worked out from the cell sizes first, and the cells the data source dequeued are counted by reuse identifier.
+ 
+ Call this after setting the data source and giving the view its frame, for example in viewWillAppear:. The report is also recorded in metrics, if set.
+ */
+- (void)prewarmCellsSpreadOverRunLoopTurns:(BOOL)spread completion:(void (^)(NSDictionary *report))completion;
+
 ///---------------------------------------
 /// @name Managing the Selection
 ///---------------------------------------
@@ -290,6 +526,60 @@
  */
 - (void)deselectItemAtIndexPath:(NSIndexPath *)indexPath animated:(BOOL)animated;
 
+/**
+ The cells selected as ranges, in display rows.
+ 
+ @discussion Range selection sits alongside the single item a tap selects, so apps can build shift-extend and add-range gestures on top of it without keeping a cell per selected index path. Cells in the selection are shown selected in every pane, including ranges that cross the header rows or columns, and content tiles are drawn with a tinted wash. Rows are display rows (see dataSourceRowForDisplayRow:), so a range is the rectangle the user sees even when rows are sorted or filtered. Setting this property copies the selection and forgets the anchor used by extendSelectionToIndexPath:.
+ 
+ The selection follows inserted and deleted rows and columns, and is cleared by reloadData and when the row order changes. Changing it does not cause any selection-related delegate methods to be called.
+ */
+@property (nonatomic, copy) MMSpreadsheetSelection *selection;
+
+/**
+ Selects the rectangle of cells between two cells, and makes the first cell the anchor for extendSelectionToIndexPath:.
+ 
+ @param fromIndexPath The data source index path of the anchor cell.
+ @param toIndexPath The data source index path of the opposite corner.
+ @param adding YES to add the rectangle to the current selection, NO to replace it.
+ */
+- (void)selectCellsFromIndexPath:(NSIndexPath *)fromIndexPath toIndexPath:(NSIndexPath *)toIndexPath addingToSelection:(BOOL)adding;
+
+/**
+ Selects whole rows, from the display row of one data source row to the display row of another.
+ 
+ @param fromRow The data source row of the anchor row.
+ @param toRow The data source row of the last row.
+ @param adding YES to add the rows to the current selection, NO to replace it.
+ */
+- (void)selectRowsFromRow:(NSInteger)fromRow toRow:(NSInteger)toRow addingToSelection:(BOOL)adding;
+
+/**
+ Selects whole columns, from one column to another.
+ 
+ @param fromColumn The anchor column.
+ @param toColumn The last column.
+ @param adding YES to add the columns to the current selection, NO to replace it.
+ */
+- (void)selectColumnsFromColumn:(NSInteger)fromColumn toColumn:(NSInteger)toColumn addingToSelection:(BOOL)adding;
+
+/**
+ Moves the far corner of the most recently selected range to a cell, keeping its anchor, as a shift-click does.
+ 
+ @param indexPath The data source index path of the new far corner.
+ @discussion Ranges selected before the most recent one are kept. A range of whole rows or columns stays whole and extends to the row or column of the cell. If there is no anchor, the cell alone is selected and becomes the anchor.
+ */
+- (void)extendSelectionToIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ Deselects every range and forgets the anchor.
+ */
+- (void)clearSelection;
+
+/**
+ Returns whether the cell at a data source index path is in the range selection.
+ */
+- (BOOL)isItemSelectedAtIndexPath:(NSIndexPath *)indexPath;
+
 ///---------------------------------------
 /// @name Reloading Content
 ///---------------------------------------
@@ -299,9 +589,316 @@
  
  @discussion Call this method to reload all of the items in the spreadsheet view. This causes the spreadsheet view to discard any currently visible items and redisplay them. For efficiency, the spreadsheet view only displays those cells that are visible. If the spreadsheet data shrinks as a result of the reload, the spreadsheet view adjusts its scrolling offsets accordingly.
  
+ Row and column counts and cell sizes are cached between reloads. Calling this method discards the cache and reads them from the data source again.
+ 
+ The values rows were sorted or filtered by may have changed, so the rows are shown in data source order at once, and the sorts and filters that made the current order are run again over the new data on a background queue. The order they give replaces data source order like a new sort does. Completion blocks are not called again.
  */
 - (void)reloadData;
 
+/**
+ Reloads just the items at the specified index paths.
+ 
+ @param indexPaths An array of `NSIndexPath` objects identifying the items you want to update, using *indexPath.mmSpreadsheetRow* and *indexPath.mmSpreadsheetColumn*.
+ @discussion The index paths are split up by the pane (header or content collection view) they belong to, and only those panes are asked to reload the affected items. Other visible cells are left alone.
+ */
+- (void)reloadItemsAtIndexPaths:(NSArray *)indexPaths;
+
+///---------------------------------------
+/// @name Live Updates
+///---------------------------------------
+
+/**
+ Reports that the value of a cell changed, for data that changes faster than the screen can show, such as a price feed.
+ 
+ @param row The data source row of the cell.
+ @param column The data source column of the cell.
+ @discussion This method may be called from any thread and does not wait on the main thread. Changes are queued without locks and applied once per display frame, with any number of changes to the same cell in a frame applied once. Only cells on screen are updated, in place through -`spreadsheetView:configureCell:forItemAtIndexPath:`, which the data source must implement for the updates to show; off screen cells are configured from the data source when they scroll into view anyway. Tiles are drawn again whether or not it does. The queue is made by the first call, so a spreadsheet view that never gets one does not allocate it. Unlike `reloadItemsAtIndexPaths:`, cell sizes are not read again.
+ 
+ If more changes arrive within a frame than the queue holds, every visible cell is updated instead. The counts are recorded under `MMSpreadsheetViewMetricsLiveUpdatesKey` when metrics are on.
+ */
+- (void)itemValueDidChangeAtRow:(NSInteger)row column:(NSInteger)column;
+
+///---------------------------------------
+/// @name Inserting, Moving, and Deleting Rows and Columns
+///---------------------------------------
+
+/**
+ Inserts new rows at the specified indexes.
+ 
+ @param rows An index set containing the indexes at which to insert the new rows. The indexes are relative to the data after the insertion.
+ @discussion Update your data source before calling this method. Rows below the header rows are inserted as sections of the lower panes so existing cells stay in place. Inserting inside the header rows reloads the header rows and pushes the displaced rows into the lower panes, since the number of header rows does not change.
+ 
+ While rows are sorted or filtered, inserted rows are shown after the other rows, unsorted, and deleted rows are removed from the display order. Inserting or deleting a header row resets the row order.
+ */
+- (void)insertRows:(NSIndexSet *)rows;
+
+/**
+ Deletes the rows at the specified indexes.
+ 
+ @param rows An index set containing the indexes of the rows to delete. The indexes are relative to the data before the deletion.
+ @discussion Update your data source before calling this method. See `insertRows:` for how changes inside the header rows are handled.
+ */
+- (void)deleteRows:(NSIndexSet *)rows;
+
+/**
+ Inserts new columns at the specified indexes.
+ 
+ @param columns An index set containing the indexes at which to insert the new columns. The indexes are relative to the data after the insertion.
+ @discussion Update your data source before calling this method. Because a column has an item in every row, the change is not applied row by row. The header column panes reload their visible items and the content column panes reload their sections, which only makes the cells on screen again. Outside of `performBatchUpdates:completion:` the change is a batch of its own. Inside one, do not delete rows in the same batch, since their sections are reloaded. Only the column offsets are measured again; row heights are kept.
+ */
+- (void)insertColumns:(NSIndexSet *)columns;
+
+/**
+ Deletes the columns at the specified indexes.
+ 
+ @param columns An index set containing the indexes of the columns to delete. The indexes are relative to the data before the deletion.
+ @discussion Update your data source before calling this method. See `insertColumns:` for how column changes are applied.
+ */
+- (void)deleteColumns:(NSIndexSet *)columns;
+
+/**
+ Animates multiple insert, delete and reload operations as a group.
+ 
+ @param updates The block that performs the relevant insert, delete and reload operations.
+ @param completion A completion handler block to execute when all of the operations are finished. The finished parameter is YES only if every pane finished its animations. This parameter may be nil.
+ @discussion The updates block is run once while every pane is inside its own batch, so changes that span the header split animate together.
+ */
+- (void)performBatchUpdates:(void (^)(void))updates completion:(void (^)(BOOL finished))completion;
+
+///---------------------------------------
+/// @name Exporting Cells
+///---------------------------------------
+
+/**
+ Writes a rectangle of cells to a file handle as CSV or TSV on a background queue.
+ 
+ @param rows The display rows to export. The range is clipped to the grid, so NSMakeRange(0, NSIntegerMax) exports every row.
+ @param columns The columns to export, clipped the same way.
+ @param format The text format to write.
+ @param fileHandle An open file handle. It is written from a background thread, and is not closed.
+ @param progress Called on the main thread with the fraction of rows written. This parameter may be nil.
+ @param completion Called on the main thread when the export ends, with NO if it was cancelled or a write failed. This parameter may be nil.
+ 
+ @return The export, which can be cancelled.
+ @discussion Cell text comes from `spreadsheetView:valueForItemAtIndexPath:`. It is requested from the valueDataSource, or from the dataSource if there is no value data source and the data source adopts `MMSpreadsheetViewValueDataSource`. The rows are exported in the order they are displayed when the export starts, with any sort or filter applied.
+ */
+- (MMSpreadsheetExportOperation *)exportRows:(NSRange)rows
+                                     columns:(NSRange)columns
+                                      format:(MMSpreadsheetExportFormat)format
+                                toFileHandle:(NSFileHandle *)fileHandle
+                                    progress:(void (^)(double fractionCompleted))progress
+                                  completion:(void (^)(BOOL finished, NSError *error))completion;
+
+/**
+ Copies a rectangle of cells to a pasteboard as CSV or TSV, built on a background queue.
+ 
+ @param pasteboard The pasteboard to copy to. It gets the text both as plain text and as the format's own type, once the whole rectangle has been read.
+ @discussion The text is collected in memory because a pasteboard can only be set whole. See exportRows:columns:format:toFileHandle:progress:completion: for the other parameters.
+ */
+- (MMSpreadsheetExportOperation *)copyRows:(NSRange)rows
+                                   columns:(NSRange)columns
+                                    format:(MMSpreadsheetExportFormat)format
+                              toPasteboard:(UIPasteboard *)pasteboard
+                                  progress:(void (^)(double fractionCompleted))progress
+                                completion:(void (^)(BOOL finished, NSError *error))completion;
+
+///---------------------------------------
+/// @name Sorting and Filtering Rows
+///---------------------------------------
+
+/**
+ Sorts the rows below the header rows on a background queue, then shows them in the new order.
+ 
+ @param key Returns the sort key of a data source row. It is called once for each displayed row, concurrently on background threads.
+ @param comparator Compares two keys, or nil to use `compare:`. nil keys sort after all others.
+ @param completion Called on the main thread with YES once the new order is shown, or with NO if the sort was superseded by another sort, filter or data change. This parameter may be nil.
+ @discussion The data source is never asked to move data. The spreadsheet view keeps a display row to data source row mapping and applies it to every index path it passes to the data source and delegate, and to those passed to dequeueReusableCellWithReuseIdentifier:forIndexPath:, so data source code keeps working in data source rows.
+ 
+ The sort is stable and starts from the rows as currently displayed, so sorting by a secondary key and then a primary key gives a two-key sort, and sorting a filtered sheet keeps the filter. Header rows never move. The new order replaces the old one in a single step, and only the visible cells are reloaded, with animation.
+ */
+- (void)sortRowsUsingKey:(id (^)(NSInteger row))key comparator:(NSComparator)comparator completion:(void (^)(BOOL finished))completion;
+
+/**
+ Hides the rows below the header rows that do not pass a test. The test runs on a background queue.
+ 
+ @param predicate Returns YES to keep a data source row. It is called once for each displayed row, concurrently on background threads.
+ @param completion See sortRowsUsingKey:comparator:completion:.
+ @discussion Filtering starts from the rows as currently displayed, so filters narrow each other and keep the current sort. Call resetRowOrder to show every row again.
+ */
+- (void)filterRowsUsingPredicate:(BOOL (^)(NSInteger row))predicate completion:(void (^)(BOOL finished))completion;
+
+/**
+ Shows every row in data source order, and cancels any sort or filter that is still running.
+ */
+- (void)resetRowOrder;
+
+/**
+ The data source row shown at a display row. Display rows number the rows as they appear on screen, header rows included.
+ */
+- (NSInteger)dataSourceRowForDisplayRow:(NSInteger)row;
+
+/**
+ The display row of a data source row, or NSNotFound if the row is filtered out.
+ */
+- (NSInteger)displayRowForDataSourceRow:(NSInteger)row;
+
+///---------------------------------------
+/// @name Summarizing Columns
+///---------------------------------------
+
+/**
+ A Boolean value that determines whether a frozen summary row is shown below the content.
+ 
+ @discussion The footer lines up with the content columns and scrolls horizontally with them. It stays on screen while the rows scroll. Header columns have no summary; in the default pane layout the footer starts where the content columns start. Column summaries are computed as their footer cells come on screen. The default value is NO.
+ */
+@property (nonatomic, assign) BOOL showsSummaryFooter;
+
+/**
+ The height of the summary footer. The default value is 30.
+ */
+@property (nonatomic, assign) CGFloat summaryFooterHeight;
+
+/**
+ Formats the numbers in the summary footer. The default formatter uses the decimal style with up to two fraction digits.
+ */
+@property (nonatomic, strong) NSNumberFormatter *summaryNumberFormatter;
+
+/**
+ The summary of a column, computed on first use.
+ 
+ @param column The data source column.
+ 
+ @return The summary, or nil if the column has no values or there is no summary data source.
+ */
+- (MMSpreadsheetColumnSummary *)summaryForColumn:(NSInteger)column;
+
+/**
+ Updates a column's summary after values in its buffer changed in place, and redraws its footer cell.
+ 
+ @param rows The data source rows whose values changed.
+ @param column The data source column.
+ @discussion Only the blocks of rows that hold the changed values are summarized again, so this is cheap enough to call on every edit.
+ */
+- (void)summaryValuesDidChangeInRows:(NSRange)rows column:(NSInteger)column;
+
+/**
+ Discards every column summary and asks the summary data source for the values again as footer cells come on screen.
+ 
+ @discussion Summaries are also discarded by reloadData and by inserting or deleting rows or columns, except for rows appended after the last row while the rows are in data source order. Those summarize only the appended values.
+ */
+- (void)reloadSummaries;
+
+///---------------------------------------
+/// @name Searching Cells
+///---------------------------------------
+
+/**
+ Finds the cells whose text contains a string, scanning the grid in parallel on background threads.
+ 
+ @param text The text to find. An empty string finds nothing.
+ @param options The options used to compare text, such as NSCaseInsensitiveSearch | NSDiacriticInsensitiveSearch.
+ @param progress Called on the main thread with the number of matches found so far, each time more are found. This parameter may be nil.
+ @param completion Called on the main thread when the scan ends, with NO if it was cancelled or superseded. It is called again each time rows appended later have been searched. This parameter may be nil.
+ 
+ @return The search, which holds the matches.
+ @discussion Cell text comes from `spreadsheetView:valueForItemAtIndexPath:`, requested the same way as for exportRows:columns:format:toFileHandle:progress:completion:. Every cell is searched, header cells included, in the order the rows are displayed when the search starts.
+ 
+ Starting a search cancels the one before it and clears its matches, so it is fine to search again on every keystroke. Matches are shown as they are found, but only cells on screen are redrawn: content tiles get a wash of searchHighlightColor, and visible cells are reloaded so the data source can style them using isSearchMatchAtIndexPath:. Rows inserted at the end are searched once the rows before them have been, keeping the matches found so far, so a sheet that is still loading can be searched. Inserting or deleting columns starts the search again over the new columns. The matches are cleared by reloadData, by deleting rows or inserting them anywhere but the end, and when the row order changes.
+ */
+- (MMSpreadsheetSearchOperation *)searchForText:(NSString *)text
+                                        options:(NSStringCompareOptions)options
+                                       progress:(void (^)(NSUInteger matchCount))progress
+                                     completion:(void (^)(BOOL finished, NSUInteger matchCount))completion;
+
+/**
+ Cancels the current search and clears its matches.
+ */
+- (void)cancelSearch;
+
+/**
+ The number of matches found so far by the current search.
+ */
+@property (nonatomic, readonly) NSUInteger searchMatchCount;
+
+/**
+ Returns whether the cell at a data source index path is a match of the current search.
+ */
+- (BOOL)isSearchMatchAtIndexPath:(NSIndexPath *)indexPath;
+
+/**
+ The data source index path of the match last scrolled to, or nil.
+ */
+@property (nonatomic, readonly) NSIndexPath *currentSearchMatchIndexPath;
+
+/**
+ Scrolls to the match after the current one, in reading order, wrapping around at the end.
+ 
+ @param animated YES to animate the scroll.
+ 
+ @return The data source index path of the match, or nil if nothing has matched yet.
+ @discussion Every pane moves in the same step, along with the scroll indicators. The grid scrolls as little as needed to bring the cell on screen clear of the frozen headers. A scroll that moves the virtual window (see usesVirtualCoordinates) is not animated.
+ */
+- (NSIndexPath *)scrollToNextSearchMatchAnimated:(BOOL)animated;
+
+/**
+ Scrolls to the match before the current one, wrapping around at the start. See scrollToNextSearchMatchAnimated:.
+ */
+- (NSIndexPath *)scrollToPreviousSearchMatchAnimated:(BOOL)animated;
+
+/**
+ The wash drawn over matching content tiles. The default value is translucent yellow.
+ */
+@property (nonatomic, strong) UIColor *searchHighlightColor;
+
+///---------------------------------------
+/// @name Fitting Column Widths
+///---------------------------------------
+
+/**
+ Measures the text of columns on background threads and sizes the columns to fit it.
+ 
+ @param columns The data source columns to fit.
+ @param completion Called on the main thread once the new widths are in place. finished is NO if the fit was cancelled or superseded by a data change. This parameter may be nil.
+ 
+ @return The operation measuring the columns.
+ @discussion Text and fonts come from the value data source (see valueDataSource). The header rows and the rows on screen are measured exactly and up to columnFitSampleLimit of the other rows are sampled, so a column costs about the same to fit on a million-row sheet as on a thousand-row one. A column's fitted width is its widest measured text plus columnFitPadding, kept between minimumFittedColumnWidth and maximumFittedColumnWidth, and replaces the width from the data source until resetWidthsOfColumns:.
+ 
+ Fitted columns stay fitted as the data changes. Inserted rows and reloaded items are measured as they arrive and can only widen a column; reloadData and deleting rows fit the columns again, since they can make them narrower. Changes reported through itemValueDidChangeAtRow:column: are not measured.
+ */
+- (MMSpreadsheetColumnFitOperation *)fitWidthsOfColumns:(NSIndexSet *)columns completion:(void (^)(BOOL finished))completion;
+
+/**
+ Goes back to the data source's widths for columns, cancelling any fit of them that is still running.
+ 
+ @param columns The data source columns to reset.
+ */
+- (void)resetWidthsOfColumns:(NSIndexSet *)columns;
+
+/**
+ The data source columns whose width was fitted to their content.
+ */
+@property (nonatomic, readonly) NSIndexSet *fittedColumns;
+
+/**
+ The most rows measured per column beyond the header rows and the rows on screen. Rows are sampled evenly across the sheet when there are more. Default is 1000.
+ */
+@property (nonatomic, assign) NSUInteger columnFitSampleLimit;
+
+/**
+ The space added to the widest text of a fitted column, for the cell's insets. Default is 8, which suits tiles.
+ */
+@property (nonatomic, assign) CGFloat columnFitPadding;
+
+/**
+ The narrowest width a fitted column gets. Default is 30.
+ */
+@property (nonatomic, assign) CGFloat minimumFittedColumnWidth;
+
+/**
+ The widest width a fitted column gets, so one long value cannot push the other columns off screen. Default is 400.
+ */
+@property (nonatomic, assign) CGFloat maximumFittedColumnWidth;
+
 ///---------------------------------------
 /// @name Managing the Scroll Indicator
 ///---------------------------------------
@@ -334,6 +931,15 @@
  */
 - (void)flashScrollIndicators;
 
+/**
+ Scrolls the content pane to a logical position without animation, moving the virtual window if needed.
+ 
+ @param x The horizontal offset, measured from the content pane's first column.
+ @param y The vertical offset, measured from the content pane's first row.
+ @discussion The header panes follow, as they do for any scroll. This works whether or not usesVirtualCoordinates is set.
+ */
+- (void)setVirtualContentOffsetX:(double)x y:(double)y;
+
 ///---------------------------------------
 /// @name Scroll View Properties
 ///---------------------------------------
@@ -345,4 +951,21 @@
  */
 @property (nonatomic, assign) BOOL bounces;
 
+/**
+ A Boolean value that determines whether the content pane shows placeholder cells instead of asking the data source for cells while it scrolls too fast to read.
+ 
+ @discussion While the content scrolls faster than flingPlaceholderVelocity, cells coming on screen in the lower right pane (or below and right of the frozen cells when usesSingleScrollView is YES) are plain stripes of flingPlaceholderColor, and spreadsheetView:cellForItemAtIndexPath: is not called for them. Once the scroll slows below the threshold or stops, only the placeholders still on screen are replaced with real cells. Content drawn as tiles (see valueDataSource) is unaffected, since tiles are already drawn off the main thread. The default value is NO.
+ */
+@property (nonatomic, assign) BOOL showsPlaceholdersWhileFlinging;
+
+/**
+ The scroll speed, in points per second, above which placeholder cells are shown. The default value is 3000.
+ */
+@property (nonatomic, assign) CGFloat flingPlaceholderVelocity;
+
+/**
+ The color of placeholder cells. The default value is light gray.
+ */
+@property (nonatomic, strong) UIColor *flingPlaceholderColor;
+
 @end
@@ -21,14 +21,23 @@
 #import "MMSpreadsheetView.h"
 #import <QuartzCore/QuartzCore.h>
 #import "MMGridLayout.h"
+#import "MMGridGeometry.h"
+#import "MMGridUpdateQueue.h"
+#import "MMSpreadsheetDataSnapshot.h"
+#import "MMSpreadsheetMergedCells.h"
+#import "MMSpreadsheetRowOrder.h"
+#import "MMSpreadsheetTileView.h"
 #import "NSIndexPath+MMSpreadsheetView.h"
 
 typedef NS_ENUM(NSUInteger, MMSpreadsheetViewCollection)
 {
-    MMSpreadsheetViewCollectionUpperLeft = 1,
-    MMSpreadsheetViewCollectionUpperRight,
-    MMSpreadsheetViewCollectionLowerLeft,
-    MMSpreadsheetViewCollectionLowerRight,
+    MMSpreadsheetViewCollectionUpperLeft = MMGridPaneUpperLeft,
+    MMSpreadsheetViewCollectionUpperRight = MMGridPaneUpperRight,
+    MMSpreadsheetViewCollectionLowerLeft = MMGridPaneLowerLeft,
+    MMSpreadsheetViewCollectionLowerRight = MMGridPaneLowerRight,
+    MMSpreadsheetViewCollectionSingle = MMGridPaneSingle,
+    // Not a grid pane. It shows the content pane's columns in a single summary row.
+    MMSpreadsheetViewCollectionFooter,
 };
 
 typedef NS_ENUM(NSUInteger, MMSpreadsheetHeaderConfiguration)
@@ -45,8 +54,87 @@ const static CGFloat MMSpreadsheetViewScrollIndicatorSpace = 3.0f;
 const static CGFloat MMSpreadsheetViewScrollIndicatorMinimum = 25.0f;
 const static CGFloat MMScrollIndicatorDefaultInsetSpace = 2.0f;
 const static NSUInteger MMScrollIndicatorTag = 12345;
+const static CGFloat MMSpreadsheetViewPrefetchLookahead = 250.0f;
+const static CGFloat MMSpreadsheetViewDefaultSummaryFooterHeight = 30.0f;
+const static CGFloat MMSpreadsheetViewSummaryTextInset = 4.0f;
+const static NSTimeInterval MMSpreadsheetViewSearchScrollDuration = 0.3;
+static NSString *const MMSpreadsheetViewSummaryCellIdentifier = @"MMSpreadsheetViewSummaryCell";
+static NSString *const MMSpreadsheetViewPlaceholderCellIdentifier = @"MMSpreadsheetViewPlaceholderCell";
+const static CGFloat MMSpreadsheetViewDefaultFlingPlaceholderVelocity = 3000.0f;
+// Scroll callbacks closer together than this, such as the syncs within one frame, are not used to measure speed.
+const static CFTimeInterval MMSpreadsheetViewMinimumVelocityInterval = 0.008;
+// Changes a frame can hold before every visible cell is updated instead, several times the cells a screen shows.
+const static long MMSpreadsheetViewLiveUpdateCapacity = 16384;
+const static NSUInteger MMSpreadsheetViewDefaultColumnFitSampleLimit = 1000;
+const static CGFloat MMSpreadsheetViewDefaultColumnFitPadding = 8.0f;
+const static CGFloat MMSpreadsheetViewDefaultMinimumFittedColumnWidth = 30.0f;
+const static CGFloat MMSpreadsheetViewDefaultMaximumFittedColumnWidth = 400.0f;
+
+typedef NS_ENUM(NSUInteger, MMSpreadsheetSelectionAnchorKind)
+{
+    MMSpreadsheetSelectionAnchorKindCells = 0,
+    MMSpreadsheetSelectionAnchorKindRows,
+    MMSpreadsheetSelectionAnchorKindColumns,
+};
+
+static NSRange MMSpreadsheetRangeBetweenIndexes(NSInteger firstIndex, NSInteger secondIndex)
+{
+    return NSMakeRange(MIN(firstIndex, secondIndex), ABS(firstIndex - secondIndex) + 1);
+}
+
+// The smallest change to a scroll offset along one axis that shows [minimum, maximum] clear of the frozen cells covering
+// the leading `inset` points of the viewport. A span longer than the viewport is shown from its start.
+static double MMSpreadsheetOffsetShowingSpan(double offset, double viewportLength, double inset, double minimum, double maximum, double contentLength)
+{
+    if (minimum < offset + inset || maximum - minimum > viewportLength - inset) {
+        offset = minimum - inset;
+    }
+    else if (maximum > offset + viewportLength) {
+        offset = maximum - viewportLength;
+    }
+    return MAX(MIN(offset, contentLength - viewportLength), 0.0);
+}
+
+/**
+ The footer cell that shows a column summary.
+ */
+@interface MMSpreadsheetSummaryCell : UICollectionViewCell
+
+@property (nonatomic, strong) UILabel *textLabel;
+
+@end
+
+@implementation MMSpreadsheetSummaryCell
+
+- (instancetype)initWithFrame:(CGRect)frame
+{
+    self = [super initWithFrame:frame];
+    if (self) {
+        self.backgroundColor = [UIColor whiteColor];
+        _textLabel = [[UILabel alloc] initWithFrame:CGRectInset(self.contentView.bounds, MMSpreadsheetViewSummaryTextInset, 0.0f)];
+        _textLabel.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
+        _textLabel.backgroundColor = [UIColor clearColor];
+        _textLabel.font = [UIFont boldSystemFontOfSize:14.0f];
+        _textLabel.textAlignment = NSTextAlignmentRight;
+        [self.contentView addSubview:_textLabel];
+    }
+    return self;
+}
+
+@end
+
+/**
+ Stands in for a content cell while the content scrolls too fast to read.
+ */
+@interface MMSpreadsheetPlaceholderCell : UICollectionViewCell
+
+@end
 
-@interface MMSpreadsheetView () <UICollectionViewDataSource, UICollectionViewDelegate, UICollectionViewDelegateFlowLayout>
+@implementation MMSpreadsheetPlaceholderCell
+
+@end
+
+@interface MMSpreadsheetView () <UICollectionViewDataSource, UICollectionViewDelegate, MMGridLayoutDelegate>
 
 @property (nonatomic, assign) NSUInteger headerRowCount;
 @property (nonatomic, assign) NSUInteger headerColumnCount;
@@ -63,6 +151,11 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 @property (nonatomic, strong) UICollectionView *lowerLeftCollectionView;
 @property (nonatomic, strong) UICollectionView *lowerRightCollectionView;
 
+@property (nonatomic, strong) UIView *footerContainerView;
+@property (nonatomic, strong) UICollectionView *footerCollectionView;
+// Data source column to MMSpreadsheetColumnSummary, or NSNull for a column without values.
+@property (nonatomic, strong) NSMutableDictionary *columnSummaries;
+
 @property (nonatomic, assign, getter = isUpperRightBouncing) BOOL upperRightBouncing;
 @property (nonatomic, assign, getter = isLowerLeftBouncing) BOOL lowerLeftBouncing;
 @property (nonatomic, assign, getter = isLowerRightBouncing) BOOL lowerRightBouncing;
@@ -73,10 +166,76 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 @property (nonatomic, strong) UICollectionView *selectedItemCollectionView;
 @property (nonatomic, strong) NSIndexPath *selectedItemIndexPath;
 
+@property (nonatomic, strong) NSMutableDictionary *registeredCellClasses;
+@property (nonatomic, assign) NSUInteger batchUpdateDepth;
+@property (nonatomic, strong) MMSpreadsheetDataSnapshot *dataSnapshot;
+@property (nonatomic, strong) NSOperationQueue *exportQueue;
+
+@property (nonatomic, strong) MMSpreadsheetTileView *tileView;
+
+// The pane cell being asked of the data source, so a dequeue for a merged cell lands in the pane that asked for it.
+@property (nonatomic, weak) UICollectionView *cellRequestCollectionView;
+@property (nonatomic, strong) NSIndexPath *cellRequestIndexPath;
+@property (nonatomic, strong) NSIndexPath *cellRequestDataSourceIndexPath;
+
+@property (nonatomic, assign) NSRange prefetchedRows;
+@property (nonatomic, assign) NSRange prefetchedColumns;
+
+@property (nonatomic, assign, getter = isMovingVirtualWindow) BOOL movingVirtualWindow;
+
+@property (nonatomic, strong) MMSpreadsheetRowOrder *rowOrder;
+
+// The selection as it was before the most recent range, which extendSelectionToIndexPath: adds the anchored range to.
+// nil when there is no anchor.
+@property (nonatomic, strong) MMSpreadsheetSelection *selectionBeforeAnchor;
+@property (nonatomic, assign) MMSpreadsheetSelectionAnchorKind selectionAnchorKind;
+@property (nonatomic, assign) NSInteger selectionAnchorRow;
+@property (nonatomic, assign) NSInteger selectionAnchorColumn;
+// Read by sorts and filters running in the background to find out they have been superseded.
+@property (atomic, assign) NSUInteger rowOrderGeneration;
+// The sorts and filters the row order was made by, in order, so reloadData can make it again from the new data.
+@property (nonatomic, copy) NSArray *rowOrderSteps;
+
+@property (nonatomic, strong) NSOperationQueue *searchQueue;
+@property (nonatomic, strong) MMSpreadsheetSearchOperation *searchOperation;
+// Bumped whenever the matches are discarded, so the blocks of an older search know to stop reporting.
+@property (nonatomic, assign) NSUInteger searchGeneration;
+@property (nonatomic, copy) void (^searchProgressBlock)(NSUInteger matchCount);
+@property (nonatomic, copy) void (^searchCompletionBlock)(BOOL finished, NSUInteger matchCount);
+@property (nonatomic, assign) NSInteger currentSearchMatchRow;
+@property (nonatomic, assign) NSInteger currentSearchMatchColumn;
+
+@property (nonatomic, strong) NSMutableArray *prewarmCollectionViews;
+@property (nonatomic, strong) NSMutableDictionary *prewarmReport;
+@property (nonatomic, copy) void (^prewarmCompletion)(NSDictionary *report);
+@property (nonatomic, assign) BOOL prewarmSpread;
+// Counts dequeues by reuse identifier while a pane is being warmed.
+@property (nonatomic, strong) NSMutableDictionary *prewarmDequeuedCells;
+
+@property (nonatomic, assign, getter = isShowingFlingPlaceholders) BOOL showingFlingPlaceholders;
+@property (nonatomic, assign) CFTimeInterval velocitySampleTime;
+@property (nonatomic, assign) double velocitySampleX;
+@property (nonatomic, assign) double velocitySampleY;
+
+@property (nonatomic, strong) CADisplayLink *liveUpdateDisplayLink;
+
+// Serial, so a fit that only widens columns is applied after the fit it follows.
+@property (nonatomic, strong) NSOperationQueue *columnFitQueue;
+
 @end
 
 
 @implementation MMSpreadsheetView
+{
+    MMGridUpdateQueue _liveUpdateQueue;
+    // Scratch space for one frame of changes, and whether each distinct change reached the screen.
+    MMGridCellIndex *_liveUpdateCells;
+    BOOL *_liveUpdateCellsShown;
+    // Set by the first change after a frame, so only that change has to wake the display link.
+    atomic_bool _liveUpdateScheduled;
+    // The queue and buffers are made by the first change, so views without live updates do not carry them.
+    dispatch_once_t _liveUpdatePreparation;
+}
 
 - (instancetype)init
 {
@@ -97,8 +256,25 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
         _scrollIndicatorInsets = UIEdgeInsetsZero;
         _showsVerticalScrollIndicator = YES;
         _showsHorizontalScrollIndicator = YES;
+        _bounces = YES;
+        _registeredCellClasses = [NSMutableDictionary dictionary];
         _headerRowCount = headerRowCount;
         _headerColumnCount = headerColumnCount;
+        _selection = [[MMSpreadsheetSelection alloc] init];
+        _columnSummaries = [NSMutableDictionary dictionary];
+        _summaryFooterHeight = MMSpreadsheetViewDefaultSummaryFooterHeight;
+        _summaryNumberFormatter = [[NSNumberFormatter alloc] init];
+        _summaryNumberFormatter.numberStyle = NSNumberFormatterDecimalStyle;
+        _summaryNumberFormatter.maximumFractionDigits = 2;
+        _searchHighlightColor = [[UIColor yellowColor] colorWithAlphaComponent:0.4f];
+        _currentSearchMatchRow = NSNotFound;
+        _flingPlaceholderVelocity = MMSpreadsheetViewDefaultFlingPlaceholderVelocity;
+        _flingPlaceholderColor = [UIColor colorWithWhite:0.9f alpha:1.0f];
+        _columnFitSampleLimit = MMSpreadsheetViewDefaultColumnFitSampleLimit;
+        _columnFitPadding = MMSpreadsheetViewDefaultColumnFitPadding;
+        _minimumFittedColumnWidth = MMSpreadsheetViewDefaultMinimumFittedColumnWidth;
+        _maximumFittedColumnWidth = MMSpreadsheetViewDefaultMaximumFittedColumnWidth;
+        atomic_init(&_liveUpdateScheduled, false);
         
         if (headerColumnCount == 0 && headerRowCount == 0) {
             _spreadsheetHeaderConfiguration = MMSpreadsheetHeaderConfigurationNone;
@@ -119,20 +295,67 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     return self;
 }
 
+- (void)dealloc
+{
+    MMGridUpdateQueueFree(&_liveUpdateQueue);
+    free(_liveUpdateCells);
+    free(_liveUpdateCellsShown);
+}
+
 #pragma mark - Public Functions
 
 - (UICollectionViewCell *)dequeueReusableCellWithReuseIdentifier:identifier forIndexPath:(NSIndexPath *)indexPath
 {
-    NSIndexPath *collectionViewIndexPath = [self collectionViewIndexPathFromDataSourceIndexPath:indexPath];
-    UICollectionView *collectionView = [self collectionViewForDataSourceIndexPath:indexPath];
+    // A merged cell is asked for at its top-left index path, which may be in another pane than the part being shown.
+    NSIndexPath *collectionViewIndexPath = nil;
+    UICollectionView *collectionView = nil;
+    if (self.cellRequestCollectionView && [indexPath isEqual:self.cellRequestDataSourceIndexPath]) {
+        collectionViewIndexPath = self.cellRequestIndexPath;
+        collectionView = self.cellRequestCollectionView;
+    }
+    else {
+        collectionViewIndexPath = [self collectionViewIndexPathFromDataSourceIndexPath:indexPath];
+        collectionView = [self collectionViewForDataSourceIndexPath:indexPath];
+    }
     NSAssert(collectionView, @"No collectionView Returned!");
+    NSAssert(collectionViewIndexPath, @"Dequeued a cell for a row that is filtered out.");
     
     UICollectionViewCell *cell = [collectionView dequeueReusableCellWithReuseIdentifier:identifier forIndexPath:collectionViewIndexPath];
+    [self.metrics recordDequeuedCell];
+    if (self.prewarmDequeuedCells) {
+        self.prewarmDequeuedCells[identifier] = @([self.prewarmDequeuedCells[identifier] unsignedIntegerValue] + 1);
+    }
     return cell;
 }
 
+- (void)prewarmCellsSpreadOverRunLoopTurns:(BOOL)spread completion:(void (^)(NSDictionary *report))completion
+{
+    [self cancelPrewarming];
+    // The panes need their frames to know how many cells they show.
+    [self layoutIfNeeded];
+    self.prewarmCollectionViews = [[self collectionViews] mutableCopy];
+    self.prewarmReport = [NSMutableDictionary dictionary];
+    self.prewarmCompletion = completion;
+    self.prewarmSpread = spread;
+    if (spread) {
+        [self schedulePrewarmOfNextPane];
+    }
+    else {
+        while (self.prewarmCollectionViews) {
+            [self prewarmNextPane];
+        }
+    }
+}
+
 - (void)registerCellClass:(Class)cellClass forCellWithReuseIdentifier:(NSString *)identifier
 {
+    // Remembered so the panes can be rebuilt when switching scroll modes.
+    if (cellClass) {
+        self.registeredCellClasses[identifier] = cellClass;
+    }
+    else {
+        [self.registeredCellClasses removeObjectForKey:identifier];
+    }
     [self.upperLeftCollectionView registerClass:cellClass forCellWithReuseIdentifier:identifier];
     [self.upperRightCollectionView registerClass:cellClass forCellWithReuseIdentifier:identifier];
     [self.lowerLeftCollectionView registerClass:cellClass forCellWithReuseIdentifier:identifier];
@@ -144,15 +367,113 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     NSIndexPath *collectionViewIndexPath = [self collectionViewIndexPathFromDataSourceIndexPath:indexPath];
     UICollectionView *collectionView = [self collectionViewForDataSourceIndexPath:indexPath];
     NSAssert(collectionView, @"No collectionView Returned!");
-    [collectionView deselectItemAtIndexPath:collectionViewIndexPath animated:animated];
+    if (collectionViewIndexPath) {
+        [collectionView deselectItemAtIndexPath:collectionViewIndexPath animated:animated];
+    }
 }
 
 - (void)reloadData
 {
+    [self clearSelection];
+    [self discardSearch];
+    // Fitted widths are carried over so the columns keep their size while they are fitted again.
+    NSDictionary *fittedWidths = [self fittedColumnWidths];
+    NSIndexSet *refitColumns = [self columnsBeingFitted];
+    self.dataSnapshot = nil;
+    [self restoreFittedColumnWidths:fittedWidths];
+    // The values the rows were sorted and filtered by may have changed, so the old order is not shown with the new data.
+    if (self.rowOrder) {
+        [self recomputeRowOrder];
+    }
+    self.tileView.mergedCells = self.snapshot.mergedCells;
+    [self.tileView invalidateAllTiles];
+    [self reloadSummaries];
     [self.upperLeftCollectionView reloadData];
     [self.upperRightCollectionView reloadData];
     [self.lowerLeftCollectionView reloadData];
     [self.lowerRightCollectionView reloadData];
+    [self refitColumns:refitColumns];
+}
+
+- (void)reloadItemsAtIndexPaths:(NSArray *)indexPaths
+{
+    [self.dataSnapshot reloadSizesForItemsAtIndexPaths:indexPaths];
+    [self widenFittedColumnsForItemsAtIndexPaths:indexPaths];
+
+    NSMutableDictionary *collectionViewIndexPaths = [NSMutableDictionary dictionary];
+    BOOL sizesChanged = NO;
+    for (NSIndexPath *indexPath in indexPaths) {
+        sizesChanged = sizesChanged || indexPath.mmSpreadsheetRow == 0 || indexPath.mmSpreadsheetColumn == 0;
+        NSIndexPath *collectionViewIndexPath = [self collectionViewIndexPathFromDataSourceIndexPath:indexPath];
+        if (collectionViewIndexPath == nil) {
+            // Filtered out, so there is nothing on screen to reload.
+            continue;
+        }
+        UICollectionView *collectionView = [self collectionViewForDataSourceIndexPath:indexPath];
+        NSAssert(collectionView, @"No collectionView Returned!");
+        NSNumber *key = @(collectionView.tag);
+        NSMutableArray *paneIndexPaths = collectionViewIndexPaths[key];
+        if (paneIndexPaths == nil) {
+            paneIndexPaths = [NSMutableArray array];
+            collectionViewIndexPaths[key] = paneIndexPaths;
+        }
+        [paneIndexPaths addObject:collectionViewIndexPath];
+    }
+
+    // Row heights and column widths come from row 0 and column 0, so reloading those can move every tile.
+    if (sizesChanged) {
+        [self.tileView invalidateAllTiles];
+    }
+    else {
+        [self.tileView invalidateTilesForItemsAtIndexPaths:collectionViewIndexPaths[@(self.lowerRightCollectionView.tag)]];
+    }
+
+    [self performBatchUpdates:^{
+        for (UICollectionView *collectionView in [self collectionViews]) {
+            NSArray *paneIndexPaths = collectionViewIndexPaths[@(collectionView.tag)];
+            if (paneIndexPaths) {
+                [collectionView reloadItemsAtIndexPaths:paneIndexPaths];
+            }
+        }
+    } completion:nil];
+}
+
+- (void)insertRows:(NSIndexSet *)rows
+{
+    [self updateRows:rows inserting:YES];
+}
+
+- (void)deleteRows:(NSIndexSet *)rows
+{
+    [self updateRows:rows inserting:NO];
+}
+
+- (void)insertColumns:(NSIndexSet *)columns
+{
+    [self updateColumns:columns inserting:YES];
+}
+
+- (void)deleteColumns:(NSIndexSet *)columns
+{
+    [self updateColumns:columns inserting:NO];
+}
+
+- (void)performBatchUpdates:(void (^)(void))updates completion:(void (^)(BOOL finished))completion
+{
+    NSArray *collectionViews = [self collectionViews];
+    dispatch_group_t group = dispatch_group_create();
+    __block BOOL allFinished = YES;
+    self.batchUpdateDepth++;
+    [self performBatchUpdates:updates onCollectionViews:collectionViews group:group paneCompletion:^(BOOL finished) {
+        allFinished = allFinished && finished;
+    }];
+    self.batchUpdateDepth--;
+
+    dispatch_group_notify(group, dispatch_get_main_queue(), ^{
+        if (completion) {
+            completion(allFinished);
+        }
+    });
 }
 
 - (void)flashScrollIndicators
@@ -161,13 +482,105 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     [self performSelector:@selector(hideScrollIndicators) withObject:nil afterDelay:1];
 }
 
+#pragma mark - Pre-warming cells
+
+- (void)schedulePrewarmOfNextPane
+{
+    // The default mode only, so a pane is not warmed in the middle of a scroll.
+    [[NSRunLoop mainRunLoop] performSelector:@selector(prewarmNextPane) target:self argument:nil order:0 modes:@[NSDefaultRunLoopMode]];
+}
+
+- (void)cancelPrewarming
+{
+    [[NSRunLoop mainRunLoop] cancelPerformSelector:@selector(prewarmNextPane) target:self argument:nil];
+    self.prewarmCollectionViews = nil;
+    self.prewarmReport = nil;
+    self.prewarmCompletion = nil;
+}
+
+- (void)prewarmNextPane
+{
+    UICollectionView *collectionView = [self.prewarmCollectionViews firstObject];
+    if (collectionView) {
+        [self.prewarmCollectionViews removeObjectAtIndex:0];
+        [self prewarmCollectionView:collectionView];
+    }
+    if ([self.prewarmCollectionViews count] > 0) {
+        if (self.prewarmSpread) {
+            [self schedulePrewarmOfNextPane];
+        }
+        return;
+    }
+
+    void (^completion)(NSDictionary *) = self.prewarmCompletion;
+    NSDictionary *report = [self.prewarmReport copy];
+    [self cancelPrewarming];
+    if (completion) {
+        completion(report);
+    }
+}
+
+- (void)prewarmCollectionView:(UICollectionView *)collectionView
+{
+    // One more screenful in each direction the pane scrolls, which is what the first scroll brings on screen.
+    CGRect bounds = collectionView.bounds;
+    CGRect warmBounds = bounds;
+    if (collectionView.tag != MMSpreadsheetViewCollectionUpperLeft && collectionView.tag != MMSpreadsheetViewCollectionLowerLeft) {
+        warmBounds.size.width *= 2.0f;
+    }
+    if (collectionView.tag != MMSpreadsheetViewCollectionUpperLeft && collectionView.tag != MMSpreadsheetViewCollectionUpperRight) {
+        warmBounds.size.height *= 2.0f;
+    }
+
+    MMGridLayout *layout = (MMGridLayout *)collectionView.collectionViewLayout;
+    NSUInteger neededCells = 0;
+    if (!CGRectIsEmpty(bounds)) {
+        NSUInteger rowCount = [layout rowRangeForRect:warmBounds].length;
+        NSUInteger columnCount = [layout columnRangeForRect:warmBounds].length;
+        neededCells = rowCount * columnCount;
+        if (layout.omitsCells) {
+            // Only the frozen cells are real cells when the content is drawn as tiles.
+            NSUInteger frozenRowCount = MIN(layout.frozenRowCount, rowCount);
+            NSUInteger frozenColumnCount = MIN(layout.frozenColumnCount, columnCount);
+            neededCells = frozenRowCount * columnCount + frozenColumnCount * rowCount - frozenRowCount * frozenColumnCount;
+        }
+    }
+
+    // Laying the pane out over the larger area creates the cells, and shrinking it back puts the ones off screen in the
+    // reuse queue. Both happen before the next frame is drawn, so nothing visibly changes.
+    self.prewarmDequeuedCells = [NSMutableDictionary dictionary];
+    CFTimeInterval startTime = CACurrentMediaTime();
+    if (!CGRectIsEmpty(bounds)) {
+        collectionView.bounds = warmBounds;
+        [collectionView layoutIfNeeded];
+        collectionView.bounds = bounds;
+        [collectionView layoutIfNeeded];
+    }
+    CFTimeInterval duration = CACurrentMediaTime() - startTime;
+
+    NSDictionary *report = @{@"neededCells": @(neededCells),
+                             @"cells": [self.prewarmDequeuedCells copy],
+                             @"duration": @(duration)};
+    self.prewarmDequeuedCells = nil;
+    NSString *name = [MMSpreadsheetViewMetrics nameForPane:collectionView.tag];
+    if (name) {
+        self.prewarmReport[name] = report;
+    }
+    [self.metrics recordPrewarm:report forPane:collectionView.tag];
+}
+
 #pragma mark - View Setup functions
 
 - (void)setupSubviews
 {
-    switch (self.spreadsheetHeaderConfiguration) {
+    switch ([self paneConfiguration]) {
         case MMSpreadsheetHeaderConfigurationNone:
-            [self setupLowerRightView];
+            if (self.usesSingleScrollView) {
+                [self setupSingleView];
+            }
+            else {
+                [self setupLowerRightView];
+            }
             break;
             
         case MMSpreadsheetHeaderConfigurationColumnOnly:
@@ -191,10 +604,89 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
             NSAssert(NO, @"What have you done?");
             break;
     }
+    if (self.showsSummaryFooter) {
+        [self setupFooterView];
+    }
     self.verticalScrollIndicator = [self setupScrollIndicator];
     self.horizontalScrollIndicator = [self setupScrollIndicator];
 }
 
+- (void)rebuildSubviews
+{
+    [self cancelPrewarming];
+    [self.upperLeftContainerView removeFromSuperview];
+    [self.upperRightContainerView removeFromSuperview];
+    [self.lowerLeftContainerView removeFromSuperview];
+    [self.lowerRightContainerView removeFromSuperview];
+    [self.footerContainerView removeFromSuperview];
+    [self.tileView removeFromSuperview];
+    [self.verticalScrollIndicator removeFromSuperview];
+    [self.horizontalScrollIndicator removeFromSuperview];
+
+    self.upperLeftContainerView = nil;
+    self.upperRightContainerView = nil;
+    self.lowerLeftContainerView = nil;
+    self.lowerRightContainerView = nil;
+    self.upperLeftCollectionView = nil;
+    self.upperRightCollectionView = nil;
+    self.lowerLeftCollectionView = nil;
+    self.lowerRightCollectionView = nil;
+    self.footerContainerView = nil;
+    self.footerCollectionView = nil;
+    self.tileView = nil;
+    self.controllingScrollView = nil;
+    self.selectedItemCollectionView = nil;
+    self.selectedItemIndexPath = nil;
+
+    [self setupSubviews];
+    NSDictionary *registeredCellClasses = [self.registeredCellClasses copy];
+    [registeredCellClasses enumerateKeysAndObjectsUsingBlock:^(NSString *identifier, Class cellClass, BOOL *stop) {
+        [self registerCellClass:cellClass forCellWithReuseIdentifier:identifier];
+    }];
+    self.bounces = _bounces;
+    self.restorationIdentifier = _restorationIdentifier;
+    self.valueDataSource = _valueDataSource;
+    if (self.dataSource) {
+        self.dataSource = self.dataSource;
+    }
+    [self setNeedsLayout];
+}
+
+- (void)setupTileView
+{
+    [self.tileView removeFromSuperview];
+    self.tileView = nil;
+
+    UICollectionView *collectionView = self.lowerRightCollectionView;
+    MMGridLayout *layout = (MMGridLayout *)collectionView.collectionViewLayout;
+    layout.omitsCells = self.valueDataSource != nil;
+    if (self.valueDataSource) {
+        MMSpreadsheetTileView *tileView = [[MMSpreadsheetTileView alloc] initWithSpreadsheetView:self collectionView:collectionView];
+        tileView.valueDataSource = self.valueDataSource;
+        tileView.rowOffset = [self dataSourceRowOffsetForCollectionView:collectionView];
+        tileView.columnOffset = [self dataSourceColumnOffsetForCollectionView:collectionView];
+        tileView.rowOrder = self.rowOrder;
+        tileView.selection = _selection;
+        tileView.mergedCells = self.snapshot.mergedCells;
+        tileView.search = self.searchOperation;
+        tileView.searchHighlightColor = self.searchHighlightColor;
+        [tileView addGestureRecognizer:[[UITapGestureRecognizer alloc] initWithTarget:self action:@selector(handleTileTapGesture:)]];
+        // Below any frozen cells, which are still real cells.
+        [collectionView insertSubview:tileView atIndex:0];
+        self.tileView = tileView;
+    }
+    [collectionView reloadData];
+}
+
+- (MMSpreadsheetHeaderConfiguration)paneConfiguration
+{
+    // With a single scroll view the headers are frozen cells in the one pane.
+    if (self.usesSingleScrollView) {
+        return MMSpreadsheetHeaderConfigurationNone;
+    }
+    return self.spreadsheetHeaderConfiguration;
+}
+
 - (void)setupContainerSubview:(UIView *)container collectionView:(UICollectionView *)collectionView tag:(NSInteger)tag
 {
     container.autoresizingMask = UIViewAutoresizingFlexibleWidth | UIViewAutoresizingFlexibleHeight;
@@ -213,6 +705,8 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 - (UICollectionView *)setupCollectionViewWithGridLayout
 {
     MMGridLayout *layout = [[MMGridLayout alloc] init];
+    layout.metrics = self.metrics;
+    layout.usesVirtualCoordinates = self.usesVirtualCoordinates;
     UICollectionView *collectionView = [[UICollectionView alloc] initWithFrame:CGRectZero collectionViewLayout:layout];
     return collectionView;
 }
@@ -258,13 +752,73 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     [self setupContainerSubview:self.lowerRightContainerView
                  collectionView:self.lowerRightCollectionView
                             tag:MMSpreadsheetViewCollectionLowerRight];
+    [self.lowerRightCollectionView registerClass:[MMSpreadsheetPlaceholderCell class] forCellWithReuseIdentifier:MMSpreadsheetViewPlaceholderCellIdentifier];
+}
+
+- (void)setupSingleView
+{
+    self.lowerRightContainerView = [[UIView alloc] initWithFrame:CGRectZero];
+    self.lowerRightCollectionView = [self setupCollectionViewWithGridLayout];
+    MMGridLayout *layout = (MMGridLayout *)self.lowerRightCollectionView.collectionViewLayout;
+    layout.frozenRowCount = self.headerRowCount;
+    layout.frozenColumnCount = self.headerColumnCount;
+    [self setupContainerSubview:self.lowerRightContainerView
+                 collectionView:self.lowerRightCollectionView
+                            tag:MMSpreadsheetViewCollectionSingle];
+    [self.lowerRightCollectionView registerClass:[MMSpreadsheetPlaceholderCell class] forCellWithReuseIdentifier:MMSpreadsheetViewPlaceholderCellIdentifier];
+}
+
+- (void)setupFooterView
+{
+    self.footerContainerView = [[UIView alloc] initWithFrame:CGRectZero];
+    self.footerCollectionView = [self setupCollectionViewWithGridLayout];
+    [self.footerCollectionView registerClass:[MMSpreadsheetSummaryCell class] forCellWithReuseIdentifier:MMSpreadsheetViewSummaryCellIdentifier];
+    [self setupContainerSubview:self.footerContainerView
+                 collectionView:self.footerCollectionView
+                            tag:MMSpreadsheetViewCollectionFooter];
+    // The footer only follows the content pane, like the header panes do.
+    self.footerCollectionView.scrollEnabled = NO;
+    self.footerCollectionView.allowsSelection = NO;
+    if (self.usesSingleScrollView) {
+        MMGridLayout *layout = (MMGridLayout *)self.footerCollectionView.collectionViewLayout;
+        layout.frozenColumnCount = self.headerColumnCount;
+    }
+    // Below the scroll indicators, which may already be up when the footer is turned on.
+    [self sendSubviewToBack:self.footerContainerView];
+}
+
+- (void)layoutFooterView
+{
+    // The footer takes its height from the bottom of the lower panes, and lines up with the content pane.
+    CGFloat footerSpace = self.summaryFooterHeight + MMSpreadsheetViewGridSpace;
+    CGRect lowerRightFrame = self.lowerRightContainerView.frame;
+    lowerRightFrame.size.height = MAX(lowerRightFrame.size.height - footerSpace, 0.0f);
+    self.lowerRightContainerView.frame = lowerRightFrame;
+    if (self.lowerLeftContainerView) {
+        CGRect lowerLeftFrame = self.lowerLeftContainerView.frame;
+        lowerLeftFrame.size.height = MAX(lowerLeftFrame.size.height - footerSpace, 0.0f);
+        self.lowerLeftContainerView.frame = lowerLeftFrame;
+    }
+    self.footerContainerView.frame = CGRectMake(CGRectGetMinX(lowerRightFrame),
+                                                CGRectGetMaxY(lowerRightFrame) + MMSpreadsheetViewGridSpace,
+                                                CGRectGetWidth(lowerRightFrame),
+                                                self.summaryFooterHeight);
+    [self syncFooterContentOffset];
+}
+
+- (void)syncFooterContentOffset
+{
+    if (self.footerCollectionView) {
+        [self.footerCollectionView setContentOffset:CGPointMake(self.lowerRightCollectionView.contentOffset.x, 0.0f) animated:NO];
+        [self.metrics recordContentOffsetSync];
+    }
 }
 
 - (void)layoutSubviews
 {
     [super layoutSubviews];
     NSIndexPath *indexPathZero = [NSIndexPath indexPathForItem:0 inSection:0];
-    switch (self.spreadsheetHeaderConfiguration) {
+    switch ([self paneConfiguration]) {
         case MMSpreadsheetHeaderConfigurationNone:
             self.lowerRightContainerView.frame = self.bounds;
             break;
@@ -346,6 +900,9 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
             NSAssert(NO, @"What have you done?");
             break;
     }
+    if (self.footerContainerView) {
+        [self layoutFooterView];
+    }
     
     // Resize the indicators.
     self.verticalScrollIndicator.frame = CGRectMake(self.frame.size.width - MMSpreadsheetViewScrollIndicatorWidth - self.scrollIndicatorInsets.right - MMScrollIndicatorDefaultInsetSpace,
@@ -359,6 +916,7 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
                                                       self.frame.size.width - 4*MMSpreadsheetViewScrollIndicatorSpace,
                                                       MMSpreadsheetViewScrollIndicatorWidth);
     [self updateHorizontalScrollIndicator];
+    [self.tileView updateVisibleTiles];
 }
 
 #pragma mark - UIPanGestureRecognizer callbacks
@@ -405,6 +963,44 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     }
 }
 
+- (void)willMoveToWindow:(UIWindow *)newWindow
+{
+    [super willMoveToWindow:newWindow];
+    if (newWindow == nil) {
+        // The display link counting frames keeps the metrics alive, so stop it when the view goes away.
+        [self.metrics endScrollEvent];
+        // Likewise the one applying live updates keeps the view alive. Queued changes wait for the next window.
+        [self.liveUpdateDisplayLink invalidate];
+        self.liveUpdateDisplayLink = nil;
+    }
+}
+
+- (void)didMoveToWindow
+{
+    [super didMoveToWindow];
+    if (self.window) {
+        [self resumeLiveUpdates];
+    }
+}
+
+- (void)handleTileTapGesture:(UITapGestureRecognizer *)recognizer
+{
+    NSIndexPath *indexPath = [self.tileView indexPathForItemAtPoint:[recognizer locationInView:self.tileView]];
+    if (indexPath == nil) {
+        return;
+    }
+
+    // Tiles have no selected state to keep, so just drop any selection in the header panes.
+    [self.selectedItemCollectionView deselectItemAtIndexPath:self.selectedItemIndexPath animated:NO];
+    self.selectedItemCollectionView = nil;
+    self.selectedItemIndexPath = nil;
+
+    NSIndexPath *dataSourceIndexPath = [self dataSourceIndexPathFromCollectionView:self.lowerRightCollectionView indexPath:indexPath];
+    if ([self.delegate respondsToSelector:@selector(spreadsheetView:didSelectItemAtIndexPath:)]) {
+        [self.delegate spreadsheetView:self didSelectItemAtIndexPath:dataSourceIndexPath];
+    }
+}
+
 #pragma mark - property setters
 
 - (void)setRestorationIdentifier:(NSString *)restorationIdentifier
@@ -415,6 +1011,80 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     self.lowerRightCollectionView.restorationIdentifier = [NSString stringWithFormat:@"%@-lowerRightCollectionView", restorationIdentifier];
 }
 
+- (void)setUsesSingleScrollView:(BOOL)usesSingleScrollView
+{
+    if (_usesSingleScrollView != usesSingleScrollView) {
+        _usesSingleScrollView = usesSingleScrollView;
+        [self rebuildSubviews];
+    }
+}
+
+- (void)setUsesVirtualCoordinates:(BOOL)usesVirtualCoordinates
+{
+    if (_usesVirtualCoordinates != usesVirtualCoordinates) {
+        double x = self.virtualContentOffsetX;
+        double y = self.virtualContentOffsetY;
+        _usesVirtualCoordinates = usesVirtualCoordinates;
+        for (UICollectionView *collectionView in [self collectionViews]) {
+            ((MMGridLayout *)collectionView.collectionViewLayout).usesVirtualCoordinates = usesVirtualCoordinates;
+        }
+        ((MMGridLayout *)self.footerCollectionView.collectionViewLayout).usesVirtualCoordinates = usesVirtualCoordinates;
+        [self setVirtualContentOffsetX:x y:y];
+    }
+}
+
+- (void)setShowsSummaryFooter:(BOOL)showsSummaryFooter
+{
+    if (_showsSummaryFooter == showsSummaryFooter) {
+        return;
+    }
+    _showsSummaryFooter = showsSummaryFooter;
+    if (showsSummaryFooter) {
+        [self setupFooterView];
+        [self.footerCollectionView reloadData];
+    }
+    else {
+        [self.footerContainerView removeFromSuperview];
+        self.footerContainerView = nil;
+        self.footerCollectionView = nil;
+    }
+    [self setNeedsLayout];
+}
+
+- (void)setSummaryFooterHeight:(CGFloat)summaryFooterHeight
+{
+    _summaryFooterHeight = summaryFooterHeight;
+    [self.footerCollectionView.collectionViewLayout invalidateLayout];
+    [self setNeedsLayout];
+}
+
+- (void)setSummaryNumberFormatter:(NSNumberFormatter *)summaryNumberFormatter
+{
+    _summaryNumberFormatter = summaryNumberFormatter;
+    [self.footerCollectionView reloadData];
+}
+
+- (void)setSummaryDataSource:(id<MMSpreadsheetViewSummaryDataSource>)summaryDataSource
+{
+    _summaryDataSource = summaryDataSource;
+    [self reloadSummaries];
+}
+
+- (void)setValueDataSource:(id<MMSpreadsheetViewValueDataSource>)valueDataSource
+{
+    _valueDataSource = valueDataSource;
+    [self setupTileView];
+}
+
+- (void)setMetrics:(MMSpreadsheetViewMetrics *)metrics
+{
+    [_metrics endScrollEvent];
+    _metrics = metrics;
+    for (UICollectionView *collectionView in [self collectionViews]) {
+        ((MMGridLayout *)collectionView.collectionViewLayout).metrics = metrics;
+    }
+}
+
 - (void)setBounces:(BOOL)bounces
 {
     _bounces = bounces;
@@ -427,6 +1097,14 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 - (void)setDataSource:(id<MMSpreadsheetViewDataSource>)dataSource
 {
     _dataSource = dataSource;
+    [self cancelPrewarming];
+    [self.columnFitQueue cancelAllOperations];
+    self.dataSnapshot = nil;
+    [self discardRowOrder];
+    [self discardSearch];
+    self.tileView.mergedCells = self.snapshot.mergedCells;
+    [self.tileView invalidateAllTiles];
+    [self reloadSummaries];
     if (self.upperLeftCollectionView) {
         [self initializeCollectionViewLayoutItemSize:self.upperLeftCollectionView];
     }
@@ -441,8 +1119,8 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     }
 
     // Validate dataSource & header configuration
-    NSInteger maxRows = [_dataSource numberOfRowsInSpreadsheetView:self];
-    NSInteger maxCols = [_dataSource numberOfColumnsInSpreadsheetView:self];
+    NSInteger maxRows = self.snapshot.rowCount;
+    NSInteger maxCols = self.snapshot.columnCount;
     
     NSAssert(self.headerColumnCount < maxCols, @"Invalid configuration: number of header columns must be less than (dataSource) numberOfColumnsInSpreadsheetView");
     NSAssert(self.headerRowCount < maxRows, @"Invalid configuration: number of header rows must be less than (dataSource) numberOfRowsInSpreadsheetView");
@@ -458,6 +1136,18 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     layout.itemSize = size;
 }
 
+- (MMSpreadsheetDataSnapshot *)snapshot
+{
+    // Captured lazily so every pane reads the same counts and sizes until the next reload.
+    if (self.dataSnapshot == nil && self.dataSource != nil) {
+        self.dataSnapshot = [[MMSpreadsheetDataSnapshot alloc] initWithSpreadsheetView:self
+                                                                            dataSource:self.dataSource
+                                                                        headerRowCount:self.headerRowCount
+                                                                     headerColumnCount:self.headerColumnCount];
+    }
+    return self.dataSnapshot;
+}
+
 #pragma mark - Scroll Indicator
 
 - (UIView *)setupScrollIndicator
@@ -503,26 +1193,20 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
         UIView *scrollIndicator = self.verticalScrollIndicator;
         UIView *indicatorView = [scrollIndicator viewWithTag:MMScrollIndicatorTag];
         UICollectionView *collectionView = self.lowerRightCollectionView;
-        CGSize contentSize = collectionView.collectionViewLayout.collectionViewContentSize;
-        CGRect collectionViewFrame = collectionView.frame;
-        
-        if (collectionViewFrame.size.height > contentSize.height) {
+        MMGridLayout *layout = (MMGridLayout *)collectionView.collectionViewLayout;
+        MMGridScrollIndicator indicator = MMGridScrollIndicatorMake(layout.virtualContentHeight,
+                                                                    collectionView.frame.size.height,
+                                                                    layout.rowOrigin + collectionView.contentOffset.y,
+                                                                    scrollIndicator.frame.size.height,
+                                                                    MMSpreadsheetViewScrollIndicatorMinimum);
+        if (indicator.length == 0.0) {
             indicatorView.frame = CGRectZero;
         }
         else {
-            CGFloat indicatorHeight = collectionViewFrame.size.height / contentSize.height * scrollIndicator.frame.size.height;
-            if (indicatorHeight < MMSpreadsheetViewScrollIndicatorMinimum) {
-                indicatorHeight = MMSpreadsheetViewScrollIndicatorMinimum;
-            }
-            CGFloat divideByZeroOffset = 0.0f;
-            if (contentSize.height == collectionViewFrame.size.height) {
-                divideByZeroOffset = 1.0f;
-            }
-            CGFloat indicatorOffsetY = collectionView.contentOffset.y / (contentSize.height - collectionViewFrame.size.height + divideByZeroOffset) * (scrollIndicator.frame.size.height - indicatorHeight);
             indicatorView.frame = CGRectMake(0.0f,
-                                             indicatorOffsetY,
+                                             indicator.offset,
                                              MMSpreadsheetViewScrollIndicatorWidth,
-                                             indicatorHeight);
+                                             indicator.length);
         }
     }
 }
@@ -533,145 +1217,1685 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
         UIView *scrollIndicator = self.horizontalScrollIndicator;
         UIView *indicatorView = [scrollIndicator viewWithTag:MMScrollIndicatorTag];
         UICollectionView *collectionView = self.lowerRightCollectionView;
-        CGSize contentSize = collectionView.collectionViewLayout.collectionViewContentSize;
-        CGRect collectionViewFrame = collectionView.frame;
-
-        if (collectionView.frame.size.width > contentSize.width) {
+        MMGridLayout *layout = (MMGridLayout *)collectionView.collectionViewLayout;
+        MMGridScrollIndicator indicator = MMGridScrollIndicatorMake(layout.virtualContentWidth,
+                                                                    collectionView.frame.size.width,
+                                                                    layout.columnOrigin + collectionView.contentOffset.x,
+                                                                    scrollIndicator.frame.size.width,
+                                                                    MMSpreadsheetViewScrollIndicatorMinimum);
+        if (indicator.length == 0.0) {
             indicatorView.frame = CGRectZero;
         }
         else {
-            CGFloat indicatorWidth = collectionViewFrame.size.width/contentSize.width * scrollIndicator.frame.size.width;
-            if (indicatorWidth < MMSpreadsheetViewScrollIndicatorMinimum) {
-                indicatorWidth = MMSpreadsheetViewScrollIndicatorMinimum;
-            }
-            CGFloat divideByZeroOffset = 0.0f;
-            if (contentSize.width == collectionViewFrame.size.width) {
-                divideByZeroOffset = 1.0f;
-            }
-            CGFloat indicatorOffsetX = collectionView.contentOffset.x / (contentSize.width - collectionViewFrame.size.width + divideByZeroOffset) * (scrollIndicator.frame.size.width-indicatorWidth);
-            indicatorView.frame = CGRectMake(indicatorOffsetX,
+            indicatorView.frame = CGRectMake(indicator.offset,
                                              0.0f,
-                                             indicatorWidth,
+                                             indicator.length,
                                              MMSpreadsheetViewScrollIndicatorWidth);
         }
     }
 }
 
-#pragma mark - Custom functions that don't go anywhere else
+#pragma mark - Virtual coordinates
 
-- (UICollectionView *)collectionViewForDataSourceIndexPath:(NSIndexPath *)indexPath
+- (MMGridLayout *)contentLayout
 {
-    UICollectionView *collectionView = nil;
-    switch (self.spreadsheetHeaderConfiguration) {
-        case MMSpreadsheetHeaderConfigurationNone:
-            collectionView = self.lowerRightCollectionView;
-            break;
-            
-        case MMSpreadsheetHeaderConfigurationColumnOnly:
-            if (indexPath.mmSpreadsheetColumn >= self.headerColumnCount) {
-                collectionView = self.lowerRightCollectionView;
-            }
-            else {
-                collectionView = self.lowerLeftCollectionView;
-            }
-            break;
-            
-        case MMSpreadsheetHeaderConfigurationRowOnly:
-            if (indexPath.mmSpreadsheetRow >= self.headerRowCount) {
-                collectionView = self.lowerRightCollectionView;
-            }
-            else {
-                collectionView = self.upperRightCollectionView;
-            }
-            break;
-            
-        case MMSpreadsheetHeaderConfigurationBoth:
-            if (indexPath.mmSpreadsheetRow >= self.headerRowCount) {
-                if (indexPath.mmSpreadsheetColumn >= self.headerColumnCount) {
-                    collectionView = self.lowerRightCollectionView;
-                }
-                else {
-                    collectionView = self.lowerLeftCollectionView;
-                }
-            }
-            else {
-                if (indexPath.mmSpreadsheetColumn >= self.headerColumnCount) {
-                    collectionView = self.upperRightCollectionView;
-                }
-                else {
-                    collectionView = self.upperLeftCollectionView;
-                }
-            }
-            break;
-            
-        default:
-            NSAssert(NO, @"What have you done?");
-            break;
-    }
-    return collectionView;
+    return (MMGridLayout *)self.lowerRightCollectionView.collectionViewLayout;
 }
 
-- (NSIndexPath *)dataSourceIndexPathFromCollectionView:(UICollectionView *)collectionView indexPath:(NSIndexPath *)indexPath
+- (double)virtualContentOffsetX
 {
-    NSInteger mmSpreadsheetRow = indexPath.mmSpreadsheetRow;
-    NSInteger mmSpreadsheetColumn = indexPath.mmSpreadsheetColumn;
+    return [self contentLayout].columnOrigin + self.lowerRightCollectionView.contentOffset.x;
+}
 
-    if (collectionView != nil) {
-        switch (collectionView.tag) {
-            case MMSpreadsheetViewCollectionUpperLeft:
-                break;
-                
-            case MMSpreadsheetViewCollectionUpperRight:
-                mmSpreadsheetColumn += self.headerColumnCount;
-                break;
-                
-            case MMSpreadsheetViewCollectionLowerLeft:
-                mmSpreadsheetRow += self.headerRowCount;
-                break;
-                
-            case MMSpreadsheetViewCollectionLowerRight:
-                mmSpreadsheetRow += self.headerRowCount;
-                mmSpreadsheetColumn += self.headerColumnCount;
-                break;
-                
-            default:
-                NSAssert(NO, @"What have you done?");
+- (double)virtualContentOffsetY
+{
+    return [self contentLayout].rowOrigin + self.lowerRightCollectionView.contentOffset.y;
+}
+
+- (void)setVirtualContentOffsetX:(double)x y:(double)y
+{
+    MMGridLayout *layout = [self contentLayout];
+    CGSize viewportSize = self.lowerRightCollectionView.bounds.size;
+    double rowOrigin = MMGridVirtualWindowOrigin(layout.virtualContentHeight, MMGridVirtualWindowLength, viewportSize.height, y, layout.rowOrigin);
+    double columnOrigin = MMGridVirtualWindowOrigin(layout.virtualContentWidth, MMGridVirtualWindowLength, viewportSize.width, x, layout.columnOrigin);
+
+    // The lower left pane shares the content rows and the upper right pane shares the content columns.
+    // Their layouts clamp the origin the same way, so every pane ends up on the same window.
+    self.movingVirtualWindow = YES;
+    [layout setRowOrigin:rowOrigin columnOrigin:columnOrigin];
+    [(MMGridLayout *)self.lowerLeftCollectionView.collectionViewLayout setRowOrigin:rowOrigin columnOrigin:0.0];
+    [(MMGridLayout *)self.upperRightCollectionView.collectionViewLayout setRowOrigin:0.0 columnOrigin:columnOrigin];
+    [(MMGridLayout *)self.footerCollectionView.collectionViewLayout setRowOrigin:0.0 columnOrigin:columnOrigin];
+
+    CGPoint offset = CGPointMake(x - layout.columnOrigin, y - layout.rowOrigin);
+    [self.lowerRightCollectionView setContentOffset:offset animated:NO];
+    [self.lowerLeftCollectionView setContentOffset:CGPointMake(self.lowerLeftCollectionView.contentOffset.x, offset.y) animated:NO];
+    [self.upperRightCollectionView setContentOffset:CGPointMake(offset.x, self.upperRightCollectionView.contentOffset.y) animated:NO];
+    [self syncFooterContentOffset];
+    self.movingVirtualWindow = NO;
+
+    [self updateVerticalScrollIndicator];
+    [self updateHorizontalScrollIndicator];
+}
+
+- (void)recenterVirtualWindowForScrollView:(UIScrollView *)scrollView
+{
+    // The scrolling pane is ahead of the others until it syncs them, so take each axis from it when it has one.
+    MMGridLayout *layout = [self contentLayout];
+    BOOL scrollsRows = scrollView.tag != MMSpreadsheetViewCollectionUpperRight;
+    BOOL scrollsColumns = scrollView.tag != MMSpreadsheetViewCollectionLowerLeft;
+    double x = layout.columnOrigin + (scrollsColumns ? scrollView : self.lowerRightCollectionView).contentOffset.x;
+    double y = layout.rowOrigin + (scrollsRows ? scrollView : self.lowerRightCollectionView).contentOffset.y;
+
+    CGSize viewportSize = self.lowerRightCollectionView.bounds.size;
+    double rowOrigin = MMGridVirtualWindowOrigin(layout.virtualContentHeight, MMGridVirtualWindowLength, viewportSize.height, y, layout.rowOrigin);
+    double columnOrigin = MMGridVirtualWindowOrigin(layout.virtualContentWidth, MMGridVirtualWindowLength, viewportSize.width, x, layout.columnOrigin);
+    if (rowOrigin != layout.rowOrigin || columnOrigin != layout.columnOrigin) {
+        [self setVirtualContentOffsetX:x y:y];
+    }
+}
+
+- (BOOL)isVirtualWindowAtLastRow
+{
+    MMGridLayout *layout = [self contentLayout];
+    return layout.rowOrigin + layout.collectionViewContentSize.height >= layout.virtualContentHeight;
+}
+
+- (BOOL)isVirtualWindowAtLastColumn
+{
+    MMGridLayout *layout = [self contentLayout];
+    return layout.columnOrigin + layout.collectionViewContentSize.width >= layout.virtualContentWidth;
+}
+
+#pragma mark - Exporting
+
+// Where exports and searches read cell text from.
+- (id<MMSpreadsheetViewValueDataSource>)textValueDataSource
+{
+    id<MMSpreadsheetViewValueDataSource> valueDataSource = self.valueDataSource;
+    if (valueDataSource == nil && [self.dataSource conformsToProtocol:@protocol(MMSpreadsheetViewValueDataSource)]) {
+        valueDataSource = (id<MMSpreadsheetViewValueDataSource>)self.dataSource;
+    }
+    return valueDataSource;
+}
+
+- (NSOperationQueue *)exportQueue
+{
+    if (_exportQueue == nil) {
+        _exportQueue = [[NSOperationQueue alloc] init];
+    }
+    return _exportQueue;
+}
+
+- (MMSpreadsheetExportOperation *)exportRows:(NSRange)rows
+                                     columns:(NSRange)columns
+                                      format:(MMSpreadsheetExportFormat)format
+                                toFileHandle:(NSFileHandle *)fileHandle
+                                    progress:(void (^)(double fractionCompleted))progress
+                                  completion:(void (^)(BOOL finished, NSError *error))completion
+{
+    NSParameterAssert(fileHandle);
+    MMSpreadsheetExportWriter writer = ^BOOL(NSData *chunk, NSError **error) {
+        // NSFileHandle reports failed writes by raising.
+        @try {
+            [fileHandle writeData:chunk];
+        }
+        @catch (NSException *exception) {
+            if (error) {
+                NSString *description = [exception reason] ?: @"The export could not be written.";
+                *error = [NSError errorWithDomain:MMSpreadsheetExportErrorDomain code:MMSpreadsheetExportErrorWriteFailed userInfo:@{NSLocalizedDescriptionKey: description}];
+            }
+            return NO;
+        }
+        return YES;
+    };
+    return [self exportRows:rows columns:columns format:format writer:writer progress:progress completion:completion];
+}
+
+- (MMSpreadsheetExportOperation *)copyRows:(NSRange)rows
+                                   columns:(NSRange)columns
+                                    format:(MMSpreadsheetExportFormat)format
+                              toPasteboard:(UIPasteboard *)pasteboard
+                                  progress:(void (^)(double fractionCompleted))progress
+                                completion:(void (^)(BOOL finished, NSError *error))completion
+{
+    NSParameterAssert(pasteboard);
+    NSMutableData *text = [NSMutableData data];
+    MMSpreadsheetExportWriter writer = ^BOOL(NSData *chunk, NSError **error) {
+        [text appendData:chunk];
+        return YES;
+    };
+    NSString *formatType = format == MMSpreadsheetExportFormatCSV ? @"public.comma-separated-values-text" : @"public.tab-separated-values-text";
+    return [self exportRows:rows columns:columns format:format writer:writer progress:progress completion:^(BOOL finished, NSError *error) {
+        if (finished) {
+            NSString *string = [[NSString alloc] initWithData:text encoding:NSUTF8StringEncoding] ?: @"";
+            pasteboard.items = @[@{@"public.utf8-plain-text": string, formatType: text}];
+        }
+        if (completion) {
+            completion(finished, error);
+        }
+    }];
+}
+
+- (MMSpreadsheetExportOperation *)exportRows:(NSRange)rows
+                                     columns:(NSRange)columns
+                                      format:(MMSpreadsheetExportFormat)format
+                                      writer:(MMSpreadsheetExportWriter)writer
+                                    progress:(void (^)(double fractionCompleted))progress
+                                  completion:(void (^)(BOOL finished, NSError *error))completion
+{
+    id<MMSpreadsheetViewValueDataSource> valueDataSource = [self textValueDataSource];
+    NSAssert(valueDataSource, @"Exporting needs a data source that adopts MMSpreadsheetViewValueDataSource.");
+
+    NSInteger rowCount = self.rowOrder ? self.rowOrder.rowCount : self.snapshot.rowCount;
+    NSRange exportedRows = NSIntersectionRange(rows, NSMakeRange(0, rowCount));
+    NSRange exportedColumns = NSIntersectionRange(columns, NSMakeRange(0, self.snapshot.columnCount));
+    MMSpreadsheetExportOperation *operation = [[MMSpreadsheetExportOperation alloc] initWithSpreadsheetView:self
+                                                                                            valueDataSource:valueDataSource
+                                                                                                       rows:exportedRows
+                                                                                                    columns:exportedColumns
+                                                                                                   rowOrder:self.rowOrder
+                                                                                                     format:format
+                                                                                                     writer:writer];
+    operation.progressBlock = progress;
+    operation.exportCompletionBlock = completion;
+    [self.exportQueue addOperation:operation];
+    return operation;
+}
+
+#pragma mark - Sorting and filtering
+
+- (void)setRowOrder:(MMSpreadsheetRowOrder *)rowOrder
+{
+    _rowOrder = rowOrder;
+    self.tileView.rowOrder = rowOrder;
+}
+
+- (NSInteger)dataSourceRowForDisplayRow:(NSInteger)row
+{
+    return self.rowOrder ? [self.rowOrder dataRowForDisplayRow:row] : row;
+}
+
+- (NSInteger)displayRowForDataSourceRow:(NSInteger)row
+{
+    return self.rowOrder ? [self.rowOrder displayRowForDataRow:row] : row;
+}
+
+- (void)sortRowsUsingKey:(id (^)(NSInteger row))key comparator:(NSComparator)comparator completion:(void (^)(BOOL finished))completion
+{
+    NSParameterAssert(key);
+    [self computeRowOrder:^MMSpreadsheetRowOrder *(MMSpreadsheetRowOrder *rowOrder, BOOL (^cancelled)(void)) {
+        return [rowOrder rowOrderSortedByKey:key comparator:comparator cancelled:cancelled];
+    } completion:completion];
+}
+
+- (void)filterRowsUsingPredicate:(BOOL (^)(NSInteger row))predicate completion:(void (^)(BOOL finished))completion
+{
+    NSParameterAssert(predicate);
+    [self computeRowOrder:^MMSpreadsheetRowOrder *(MMSpreadsheetRowOrder *rowOrder, BOOL (^cancelled)(void)) {
+        return [rowOrder rowOrderFilteredByPredicate:predicate cancelled:cancelled];
+    } completion:completion];
+}
+
+- (void)resetRowOrder
+{
+    self.rowOrderGeneration++;
+    self.rowOrderSteps = nil;
+    if (self.rowOrder) {
+        [self showRowOrder:nil];
+    }
+}
+
+- (void)discardRowOrder
+{
+    self.rowOrderGeneration++;
+    self.rowOrder = nil;
+    self.rowOrderSteps = nil;
+}
+
+// Goes back to data source order, and runs the sorts and filters that made the row order again in the background.
+- (void)recomputeRowOrder
+{
+    NSArray *steps = self.rowOrderSteps;
+    [self discardRowOrder];
+    if ([steps count] == 0) {
+        return;
+    }
+    [self computeRowOrder:^MMSpreadsheetRowOrder *(MMSpreadsheetRowOrder *rowOrder, BOOL (^cancelled)(void)) {
+        for (MMSpreadsheetRowOrder *(^step)(MMSpreadsheetRowOrder *, BOOL (^)(void)) in steps) {
+            rowOrder = step(rowOrder, cancelled);
+            if (rowOrder == nil) {
                 break;
+            }
+        }
+        return rowOrder;
+    } completion:nil];
+}
+
+- (void)computeRowOrder:(MMSpreadsheetRowOrder *(^)(MMSpreadsheetRowOrder *rowOrder, BOOL (^cancelled)(void)))compute
+             completion:(void (^)(BOOL finished))completion
+{
+    // Starting a new sort or filter supersedes the one before it.
+    NSUInteger generation = ++self.rowOrderGeneration;
+    __weak MMSpreadsheetView *weakSelf = self;
+    BOOL (^cancelled)(void) = ^BOOL {
+        MMSpreadsheetView *strongSelf = weakSelf;
+        return strongSelf == nil || strongSelf.rowOrderGeneration != generation;
+    };
+
+    MMSpreadsheetRowOrder *currentRowOrder = self.rowOrder;
+    // Copied, since a block literal passed in may still be on the stack.
+    NSArray *steps = [(currentRowOrder ? self.rowOrderSteps : @[]) arrayByAddingObject:[compute copy]];
+    NSInteger dataRowCount = self.snapshot.rowCount;
+    NSInteger fixedRowCount = self.headerRowCount;
+    dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^{
+        MMSpreadsheetRowOrder *startingRowOrder = currentRowOrder ?: [[MMSpreadsheetRowOrder alloc] initWithDataRowCount:dataRowCount fixedRowCount:fixedRowCount];
+        MMSpreadsheetRowOrder *rowOrder = cancelled() ? nil : compute(startingRowOrder, cancelled);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            MMSpreadsheetView *strongSelf = weakSelf;
+            BOOL finished = rowOrder != nil && !cancelled() && rowOrder.dataRowCount == strongSelf.snapshot.rowCount;
+            if (finished) {
+                [strongSelf showRowOrder:rowOrder];
+                strongSelf.rowOrderSteps = steps;
+            }
+            if (completion) {
+                completion(finished);
+            }
+        });
+    });
+}
+
+- (void)showRowOrder:(MMSpreadsheetRowOrder *)rowOrder
+{
+    NSInteger previousRowCount = self.rowOrder ? self.rowOrder.rowCount : self.snapshot.rowCount;
+    NSInteger rowCount = rowOrder ? rowOrder.rowCount : self.snapshot.rowCount;
+    [self cancelPrefetching];
+
+    // Selections are held by display row, which now points at a different data source row.
+    [self.selectedItemCollectionView deselectItemAtIndexPath:self.selectedItemIndexPath animated:NO];
+    self.selectedItemCollectionView = nil;
+    self.selectedItemIndexPath = nil;
+    [self clearSelection];
+    [self discardSearch];
+    self.rowOrder = rowOrder;
+
+    // Only the lower panes hold rows that move. Their row heights move with the rows, so the offsets are rebuilt,
+    // then the visible cells are reloaded and any rows gained or lost are added or removed at the end.
+    NSUInteger headerRowCount = self.usesSingleScrollView ? 0 : self.headerRowCount;
+    NSInteger previousSectionCount = previousRowCount - headerRowCount;
+    NSInteger sectionCount = rowCount - headerRowCount;
+    NSMutableArray *collectionViews = [NSMutableArray array];
+    if (self.lowerLeftCollectionView) {
+        [collectionViews addObject:self.lowerLeftCollectionView];
+    }
+    if (self.lowerRightCollectionView) {
+        [collectionViews addObject:self.lowerRightCollectionView];
+    }
+    for (UICollectionView *collectionView in collectionViews) {
+        [collectionView.collectionViewLayout invalidateLayout];
+    }
+
+    [self performBatchUpdates:^{
+        for (UICollectionView *collectionView in collectionViews) {
+            NSMutableArray *visibleIndexPaths = [NSMutableArray array];
+            for (NSIndexPath *indexPath in [collectionView indexPathsForVisibleItems]) {
+                if (indexPath.section < MIN(sectionCount, previousSectionCount)) {
+                    [visibleIndexPaths addObject:indexPath];
+                }
+            }
+            [collectionView reloadItemsAtIndexPaths:visibleIndexPaths];
+            if (sectionCount < previousSectionCount) {
+                [collectionView deleteSections:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(sectionCount, previousSectionCount - sectionCount)]];
+            }
+            else if (sectionCount > previousSectionCount) {
+                [collectionView insertSections:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(previousSectionCount, sectionCount - previousSectionCount)]];
+            }
+        }
+    } completion:nil];
+}
+
+#pragma mark - Searching
+
+- (NSOperationQueue *)searchQueue
+{
+    if (_searchQueue == nil) {
+        _searchQueue = [[NSOperationQueue alloc] init];
+    }
+    return _searchQueue;
+}
+
+- (MMSpreadsheetSearchOperation *)searchForText:(NSString *)text
+                                        options:(NSStringCompareOptions)options
+                                       progress:(void (^)(NSUInteger matchCount))progress
+                                     completion:(void (^)(BOOL finished, NSUInteger matchCount))completion
+{
+    NSParameterAssert(text);
+    id<MMSpreadsheetViewValueDataSource> valueDataSource = [self textValueDataSource];
+    NSAssert(valueDataSource, @"Searching needs a data source that adopts MMSpreadsheetViewValueDataSource.");
+    [self cancelSearch];
+
+    NSInteger rowCount = self.rowOrder ? self.rowOrder.rowCount : self.snapshot.rowCount;
+    MMSpreadsheetSearchOperation *search = [[MMSpreadsheetSearchOperation alloc] initWithSpreadsheetView:self
+                                                                                          valueDataSource:valueDataSource
+                                                                                                     text:text
+                                                                                                  options:options
+                                                                                                 rowCount:rowCount
+                                                                                              columnCount:self.snapshot.columnCount
+                                                                                                 rowOrder:self.rowOrder];
+    self.searchProgressBlock = progress;
+    self.searchCompletionBlock = completion;
+    [self startSearch:search];
+    return search;
+}
+
+// Only one search of a generation runs at a time: a search of appended rows starts once the one before it has finished.
+- (void)startSearch:(MMSpreadsheetSearchOperation *)search
+{
+    void (^progress)(NSUInteger) = self.searchProgressBlock;
+    void (^completion)(BOOL, NSUInteger) = self.searchCompletionBlock;
+    NSUInteger generation = self.searchGeneration;
+
+    // A superseded search may still report a batch it had already queued, which is ignored.
+    __weak MMSpreadsheetView *weakSelf = self;
+    __weak MMSpreadsheetSearchOperation *weakSearch = search;
+    search.matchesBlock = ^(NSRange rows) {
+        MMSpreadsheetView *strongSelf = weakSelf;
+        if (strongSelf == nil || strongSelf.searchGeneration != generation) {
+            return;
+        }
+        [strongSelf reloadVisibleMatchesOfSearch:strongSelf.searchOperation inRows:rows];
+        if (progress) {
+            progress(strongSelf.searchOperation.matchCount);
+        }
+    };
+    search.searchCompletionBlock = ^(BOOL finished) {
+        MMSpreadsheetView *strongSelf = weakSelf;
+        MMSpreadsheetSearchOperation *strongSearch = weakSearch;
+        BOOL current = strongSelf != nil && strongSelf.searchGeneration == generation;
+        if (current && strongSelf.searchOperation != strongSearch) {
+            // Rows were appended after this search finished, and the search of them will report.
+            return;
+        }
+        if (current && finished && [strongSelf displayRowCount] > strongSearch.rowCount) {
+            [strongSelf searchAppendedRows];
+            return;
+        }
+        if (completion) {
+            completion(finished && current, current ? strongSearch.matchCount : 0);
+        }
+    };
+
+    self.searchOperation = search;
+    self.tileView.search = search;
+    [self.searchQueue addOperation:search];
+}
+
+// Searches the rows appended since the current search was made, keeping its matches.
+- (void)searchAppendedRows
+{
+    MMSpreadsheetSearchOperation *search = self.searchOperation;
+    NSInteger rowCount = [self displayRowCount];
+    if (search == nil || rowCount <= search.rowCount) {
+        return;
+    }
+    // A running search picks up the appended rows when it finishes.
+    if (search.isFinished) {
+        [self startSearch:[search searchByAppendingRowsUpToRowCount:rowCount rowOrder:self.rowOrder]];
+    }
+}
+
+- (NSInteger)displayRowCount
+{
+    return self.rowOrder ? self.rowOrder.rowCount : self.snapshot.rowCount;
+}
+
+- (void)cancelSearch
+{
+    MMSpreadsheetSearchOperation *search = self.searchOperation;
+    if (search == nil) {
+        return;
+    }
+    [self discardSearch];
+    // The cells that showed a match are configured again without it.
+    [self reloadVisibleMatchesOfSearch:search inRows:NSMakeRange(0, NSIntegerMax)];
+}
+
+// For data changes, which configure the affected cells again themselves.
+- (void)discardSearch
+{
+    [self.searchOperation cancel];
+    self.searchOperation = nil;
+    self.searchGeneration++;
+    self.searchProgressBlock = nil;
+    self.searchCompletionBlock = nil;
+    self.currentSearchMatchRow = NSNotFound;
+    self.tileView.search = nil;
+}
+
+// Matches are recorded by column, so column changes search again from the start without clearing the search.
+- (void)restartSearch
+{
+    MMSpreadsheetSearchOperation *search = self.searchOperation;
+    if (search == nil) {
+        return;
+    }
+    void (^progress)(NSUInteger) = self.searchProgressBlock;
+    void (^completion)(BOOL, NSUInteger) = self.searchCompletionBlock;
+    [self discardSearch];
+    [self searchForText:search.text options:search.options progress:progress completion:completion];
+}
+
+- (NSUInteger)searchMatchCount
+{
+    return self.searchOperation.matchCount;
+}
+
+- (BOOL)isSearchMatchAtIndexPath:(NSIndexPath *)indexPath
+{
+    if (self.searchOperation == nil || indexPath.mmSpreadsheetRow >= self.snapshot.rowCount) {
+        return NO;
+    }
+    NSInteger row = [self displayRowForDataSourceRow:indexPath.mmSpreadsheetRow];
+    return row != NSNotFound && [self.searchOperation containsRow:row column:indexPath.mmSpreadsheetColumn];
+}
+
+- (NSIndexPath *)currentSearchMatchIndexPath
+{
+    if (self.searchOperation == nil || self.currentSearchMatchRow == NSNotFound) {
+        return nil;
+    }
+    return [NSIndexPath indexPathForItem:self.currentSearchMatchColumn inSection:[self dataSourceRowForDisplayRow:self.currentSearchMatchRow]];
+}
+
+- (NSIndexPath *)scrollToNextSearchMatchAnimated:(BOOL)animated
+{
+    return [self scrollToSearchMatchForward:YES animated:animated];
+}
+
+- (NSIndexPath *)scrollToPreviousSearchMatchAnimated:(BOOL)animated
+{
+    return [self scrollToSearchMatchForward:NO animated:animated];
+}
+
+- (NSIndexPath *)scrollToSearchMatchForward:(BOOL)forward animated:(BOOL)animated
+{
+    NSInteger row = self.currentSearchMatchRow;
+    NSInteger column = self.currentSearchMatchColumn;
+    if (![self.searchOperation getMatchRow:&row column:&column forward:forward]) {
+        return nil;
+    }
+    self.currentSearchMatchRow = row;
+    self.currentSearchMatchColumn = column;
+    [self scrollToDisplayRow:row column:column animated:animated];
+    return self.currentSearchMatchIndexPath;
+}
+
+- (void)setSearchHighlightColor:(UIColor *)searchHighlightColor
+{
+    _searchHighlightColor = searchHighlightColor;
+    self.tileView.searchHighlightColor = searchHighlightColor;
+}
+
+- (void)scrollToDisplayRow:(NSInteger)row column:(NSInteger)column animated:(BOOL)animated
+{
+    UICollectionView *collectionView = self.lowerRightCollectionView;
+    MMGridLayout *layout = [self contentLayout];
+    MMGridSplit split = [self gridSplit];
+    MMGridSpan cell = { row, column, 1, 1 };
+    MMGridSpan mergedCell;
+    if ([self getMergedCell:&mergedCell containingDisplayRow:row column:column]) {
+        cell = mergedCell;
+    }
+    NSInteger paneRow = cell.row - MMGridSplitRowOffset(split, (MMGridPane)collectionView.tag);
+    NSInteger paneColumn = cell.column - MMGridSplitColumnOffset(split, (MMGridPane)collectionView.tag);
+    NSInteger frozenRowCount = layout.frozenRowCount;
+    NSInteger frozenColumnCount = layout.frozenColumnCount;
+
+    // Cells in the header panes, or frozen in the single pane, are on screen along that axis wherever the grid is scrolled.
+    CGSize viewportSize = collectionView.bounds.size;
+    double x = [self virtualContentOffsetX];
+    double y = [self virtualContentOffsetY];
+    if (paneRow >= frozenRowCount) {
+        y = MMSpreadsheetOffsetShowingSpan(y, viewportSize.height, [layout offsetForRow:frozenRowCount],
+                                           [layout offsetForRow:paneRow], [layout offsetForRow:paneRow + cell.rowCount],
+                                           layout.virtualContentHeight);
+    }
+    if (paneColumn >= frozenColumnCount) {
+        x = MMSpreadsheetOffsetShowingSpan(x, viewportSize.width, [layout offsetForColumn:frozenColumnCount],
+                                           [layout offsetForColumn:paneColumn], [layout offsetForColumn:paneColumn + cell.columnCount],
+                                           layout.virtualContentWidth);
+    }
+
+    // Every pane and both indicators are moved together, so the headers never lag the content.
+    if (animated && !self.usesVirtualCoordinates) {
+        [UIView animateWithDuration:MMSpreadsheetViewSearchScrollDuration animations:^{
+            [self setVirtualContentOffsetX:x y:y];
+        }];
+    }
+    else {
+        [self setVirtualContentOffsetX:x y:y];
+    }
+    [self flashScrollIndicators];
+}
+
+// Configures the visible cells in the given display rows that are matches of a search again, and redraws their tiles.
+- (void)reloadVisibleMatchesOfSearch:(MMSpreadsheetSearchOperation *)search inRows:(NSRange)rows
+{
+    for (UICollectionView *collectionView in [self collectionViews]) {
+        NSMutableArray *indexPaths = [NSMutableArray array];
+        for (NSIndexPath *indexPath in [collectionView indexPathsForVisibleItems]) {
+            if ([self isMatchOfSearch:search atIndexPath:indexPath collectionView:collectionView inRows:rows]) {
+                [indexPaths addObject:indexPath];
+            }
+        }
+        if ([indexPaths count] > 0) {
+            [collectionView reloadItemsAtIndexPaths:indexPaths];
+        }
+    }
+
+    // Tiles have no visible items, so the cells under the content pane's bounds are looked up instead.
+    if (self.tileView) {
+        UICollectionView *collectionView = self.lowerRightCollectionView;
+        MMGridLayout *layout = [self contentLayout];
+        NSRange visibleRows = [layout rowRangeForRect:collectionView.bounds];
+        NSRange visibleColumns = [layout columnRangeForRect:collectionView.bounds];
+        NSMutableArray *indexPaths = [NSMutableArray array];
+        for (NSUInteger row = visibleRows.location; row < NSMaxRange(visibleRows); row++) {
+            for (NSUInteger column = visibleColumns.location; column < NSMaxRange(visibleColumns); column++) {
+                NSIndexPath *indexPath = [NSIndexPath indexPathForItem:column inSection:row];
+                if ([self isMatchOfSearch:search atIndexPath:indexPath collectionView:collectionView inRows:rows]) {
+                    [indexPaths addObject:indexPath];
+                }
+            }
+        }
+        [self.tileView invalidateTilesForItemsAtIndexPaths:indexPaths];
+    }
+}
+
+- (BOOL)isMatchOfSearch:(MMSpreadsheetSearchOperation *)search atIndexPath:(NSIndexPath *)indexPath collectionView:(UICollectionView *)collectionView inRows:(NSRange)rows
+{
+    MMGridCellIndex paneIndex = { indexPath.section, indexPath.item };
+    MMGridCellIndex cell = MMGridSplitCellFromPaneIndex([self gridSplit], (MMGridPane)collectionView.tag, paneIndex);
+    // Every part of a merged cell shows its top-left cell, which is the one that was searched.
+    MMGridSpan mergedCell;
+    if ([self getMergedCell:&mergedCell containingDisplayRow:cell.row column:cell.column]) {
+        cell.row = mergedCell.row;
+        cell.column = mergedCell.column;
+    }
+    return NSLocationInRange(cell.row, rows) && [search containsRow:cell.row column:cell.column];
+}
+
+#pragma mark - Fitting column widths
+
+- (NSOperationQueue *)columnFitQueue
+{
+    if (_columnFitQueue == nil) {
+        _columnFitQueue = [[NSOperationQueue alloc] init];
+        _columnFitQueue.maxConcurrentOperationCount = 1;
+    }
+    return _columnFitQueue;
+}
+
+- (MMSpreadsheetColumnFitOperation *)fitWidthsOfColumns:(NSIndexSet *)columns completion:(void (^)(BOOL finished))completion
+{
+    NSParameterAssert(columns);
+    NSAssert([self textValueDataSource], @"Fitting columns needs a data source that adopts MMSpreadsheetViewValueDataSource.");
+    return [self fitColumns:columns exactRows:[self headerAndVisibleDataSourceRows] sampleLimit:self.columnFitSampleLimit replacingWidths:YES completion:completion];
+}
+
+- (void)resetWidthsOfColumns:(NSIndexSet *)columns
+{
+    for (MMSpreadsheetColumnFitOperation *fit in self.columnFitQueue.operations) {
+        if ([fit.columns intersectsIndexSet:columns]) {
+            [fit cancel];
+        }
+    }
+    MMSpreadsheetDataSnapshot *snapshot = self.snapshot;
+    NSIndexSet *fittedColumns = snapshot.fittedColumns;
+    if (![fittedColumns intersectsIndexSet:columns]) {
+        return;
+    }
+    [columns enumerateIndexesUsingBlock:^(NSUInteger column, BOOL *stop) {
+        [snapshot removeFittedWidthForColumn:column];
+    }];
+    [self columnWidthsDidChange];
+}
+
+- (NSIndexSet *)fittedColumns
+{
+    return self.snapshot.fittedColumns ?: [NSIndexSet indexSet];
+}
+
+- (MMSpreadsheetColumnFitOperation *)fitColumns:(NSIndexSet *)columns
+                                      exactRows:(NSIndexSet *)exactRows
+                                    sampleLimit:(NSUInteger)sampleLimit
+                                replacingWidths:(BOOL)replacingWidths
+                                     completion:(void (^)(BOOL finished))completion
+{
+    MMSpreadsheetDataSnapshot *snapshot = self.snapshot;
+    NSMutableIndexSet *validColumns = [columns mutableCopy];
+    [validColumns removeIndexesInRange:NSMakeRange(MAX(snapshot.columnCount, 0), NSNotFound - MAX(snapshot.columnCount, 0))];
+    id<MMSpreadsheetViewValueDataSource> valueDataSource = [self textValueDataSource];
+    if ([validColumns count] == 0 || valueDataSource == nil) {
+        if (completion) {
+            dispatch_async(dispatch_get_main_queue(), ^{
+                completion(NO);
+            });
+        }
+        return nil;
+    }
+
+    NSRange sampledRows = sampleLimit > 0 ? NSMakeRange(0, snapshot.rowCount) : NSMakeRange(0, 0);
+    MMSpreadsheetColumnFitOperation *fit = [[MMSpreadsheetColumnFitOperation alloc] initWithSpreadsheetView:self
+                                                                                             valueDataSource:valueDataSource
+                                                                                                     columns:validColumns
+                                                                                                   exactRows:exactRows
+                                                                                                 sampledRows:sampledRows
+                                                                                                 sampleLimit:sampleLimit
+                                                                                                 mergedCells:snapshot.mergedCells];
+    __weak MMSpreadsheetView *weakSelf = self;
+    __weak MMSpreadsheetColumnFitOperation *weakFit = fit;
+    fit.fitCompletionBlock = ^(BOOL finished) {
+        MMSpreadsheetView *strongSelf = weakSelf;
+        MMSpreadsheetColumnFitOperation *strongFit = weakFit;
+        // Fits are cancelled on the main thread, so one superseded after it finished measuring is still caught here.
+        BOOL current = finished && strongSelf != nil && strongFit != nil && !strongFit.isCancelled;
+        if (current) {
+            [strongSelf applyColumnFit:strongFit replacingWidths:replacingWidths];
+        }
+        if (completion) {
+            completion(current);
+        }
+    };
+    [self.columnFitQueue addOperation:fit];
+    return fit;
+}
+
+// Fits columns again from scratch, superseding every fit still running.
+- (void)refitColumns:(NSIndexSet *)columns
+{
+    [self.columnFitQueue cancelAllOperations];
+    if ([columns count] > 0) {
+        [self fitColumns:columns exactRows:[self headerAndVisibleDataSourceRows] sampleLimit:self.columnFitSampleLimit replacingWidths:YES completion:nil];
+    }
+}
+
+- (void)widenFittedColumnsForItemsAtIndexPaths:(NSArray *)indexPaths
+{
+    NSIndexSet *fittedColumns = self.snapshot.fittedColumns;
+    if ([fittedColumns count] == 0) {
+        return;
+    }
+    NSMutableIndexSet *rows = [NSMutableIndexSet indexSet];
+    NSMutableIndexSet *columns = [NSMutableIndexSet indexSet];
+    for (NSIndexPath *indexPath in indexPaths) {
+        if ([fittedColumns containsIndex:indexPath.mmSpreadsheetColumn]) {
+            [rows addIndex:indexPath.mmSpreadsheetRow];
+            [columns addIndex:indexPath.mmSpreadsheetColumn];
+        }
+    }
+    if ([columns count] > 0) {
+        [self fitColumns:columns exactRows:rows sampleLimit:0 replacingWidths:NO completion:nil];
+    }
+}
+
+// The fitted columns and the columns of fits that have not finished, so a refit does not lose a fit it supersedes.
+- (NSIndexSet *)columnsBeingFitted
+{
+    NSMutableIndexSet *columns = [self.dataSnapshot.fittedColumns mutableCopy] ?: [NSMutableIndexSet indexSet];
+    for (MMSpreadsheetColumnFitOperation *fit in self.columnFitQueue.operations) {
+        if (!fit.isCancelled) {
+            [columns addIndexes:fit.columns];
+        }
+    }
+    return columns;
+}
+
+- (NSDictionary *)fittedColumnWidths
+{
+    MMSpreadsheetDataSnapshot *snapshot = self.dataSnapshot;
+    NSMutableDictionary *widths = [NSMutableDictionary dictionary];
+    [snapshot.fittedColumns enumerateIndexesUsingBlock:^(NSUInteger column, BOOL *stop) {
+        widths[@(column)] = @([snapshot widthForColumn:column]);
+    }];
+    return widths;
+}
+
+- (void)restoreFittedColumnWidths:(NSDictionary *)widths
+{
+    MMSpreadsheetDataSnapshot *snapshot = self.snapshot;
+    [widths enumerateKeysAndObjectsUsingBlock:^(NSNumber *column, NSNumber *width, BOOL *stop) {
+        if ([column integerValue] < snapshot.columnCount) {
+            [snapshot setFittedWidth:[width doubleValue] forColumn:[column integerValue]];
+        }
+    }];
+}
+
+// Data source rows the user sees first: the header rows and the rows under the content pane.
+- (NSIndexSet *)headerAndVisibleDataSourceRows
+{
+    NSInteger rowCount = self.rowOrder ? self.rowOrder.rowCount : self.snapshot.rowCount;
+    NSMutableIndexSet *rows = [NSMutableIndexSet indexSetWithIndexesInRange:NSMakeRange(0, MIN((NSInteger)self.headerRowCount, rowCount))];
+    UICollectionView *collectionView = self.lowerRightCollectionView;
+    NSRange visibleRows = [[self contentLayout] rowRangeForRect:collectionView.bounds];
+    NSInteger rowOffset = [self dataSourceRowOffsetForCollectionView:collectionView];
+    for (NSUInteger row = visibleRows.location; row < NSMaxRange(visibleRows); row++) {
+        if ((NSInteger)row + rowOffset < rowCount) {
+            [rows addIndex:[self dataSourceRowForDisplayRow:row + rowOffset]];
+        }
+    }
+    return rows;
+}
+
+- (void)applyColumnFit:(MMSpreadsheetColumnFitOperation *)fit replacingWidths:(BOOL)replacingWidths
+{
+    MMSpreadsheetDataSnapshot *snapshot = self.snapshot;
+    NSIndexSet *fittedColumns = snapshot.fittedColumns;
+    __block BOOL changed = NO;
+    [fit.columns enumerateIndexesUsingBlock:^(NSUInteger column, BOOL *stop) {
+        if ((NSInteger)column >= snapshot.columnCount) {
+            *stop = YES;
+            return;
+        }
+        BOOL fitted = [fittedColumns containsIndex:column];
+        // A column reset while it was being widened stays reset.
+        if (!replacingWidths && !fitted) {
+            return;
+        }
+        CGFloat width = MIN(MAX([fit measuredWidthForColumn:column] + self.columnFitPadding, self.minimumFittedColumnWidth), self.maximumFittedColumnWidth);
+        if (!replacingWidths) {
+            width = MAX(width, [snapshot widthForColumn:column]);
+        }
+        if (!fitted || width != [snapshot widthForColumn:column]) {
+            [snapshot setFittedWidth:width forColumn:column];
+            changed = YES;
+        }
+    }];
+    if (changed) {
+        [self columnWidthsDidChange];
+    }
+}
+
+// Column widths feed every pane's offsets, the width of the header column panes and the tiles.
+- (void)columnWidthsDidChange
+{
+    for (UICollectionView *collectionView in [self collectionViews]) {
+        [collectionView.collectionViewLayout invalidateLayout];
+    }
+    [self.footerCollectionView.collectionViewLayout invalidateLayout];
+    [self.tileView invalidateAllTiles];
+    [self setNeedsLayout];
+}
+
+#pragma mark - Range selection
+
+// Both accessors are written here, so the ivar is not synthesized on its own.
+@synthesize selection = _selection;
+
+- (MMSpreadsheetSelection *)selection
+{
+    return [_selection copy];
+}
+
+- (void)setSelection:(MMSpreadsheetSelection *)selection
+{
+    _selection = selection ? [selection copy] : [[MMSpreadsheetSelection alloc] init];
+    self.selectionBeforeAnchor = nil;
+    [self selectionDidChange];
+}
+
+- (void)selectCellsFromIndexPath:(NSIndexPath *)fromIndexPath toIndexPath:(NSIndexPath *)toIndexPath addingToSelection:(BOOL)adding
+{
+    NSInteger fromRow = [self displayRowForDataSourceRow:fromIndexPath.mmSpreadsheetRow];
+    NSInteger toRow = [self displayRowForDataSourceRow:toIndexPath.mmSpreadsheetRow];
+    if (fromRow == NSNotFound || toRow == NSNotFound) {
+        return;
+    }
+    [self anchorSelectionAtRow:fromRow column:fromIndexPath.mmSpreadsheetColumn kind:MMSpreadsheetSelectionAnchorKindCells adding:adding];
+    [self extendSelectionToRow:toRow column:toIndexPath.mmSpreadsheetColumn];
+}
+
+- (void)selectRowsFromRow:(NSInteger)fromRow toRow:(NSInteger)toRow addingToSelection:(BOOL)adding
+{
+    NSInteger fromDisplayRow = [self displayRowForDataSourceRow:fromRow];
+    NSInteger toDisplayRow = [self displayRowForDataSourceRow:toRow];
+    if (fromDisplayRow == NSNotFound || toDisplayRow == NSNotFound) {
+        return;
+    }
+    [self anchorSelectionAtRow:fromDisplayRow column:0 kind:MMSpreadsheetSelectionAnchorKindRows adding:adding];
+    [self extendSelectionToRow:toDisplayRow column:0];
+}
+
+- (void)selectColumnsFromColumn:(NSInteger)fromColumn toColumn:(NSInteger)toColumn addingToSelection:(BOOL)adding
+{
+    [self anchorSelectionAtRow:0 column:fromColumn kind:MMSpreadsheetSelectionAnchorKindColumns adding:adding];
+    [self extendSelectionToRow:0 column:toColumn];
+}
+
+- (void)extendSelectionToIndexPath:(NSIndexPath *)indexPath
+{
+    if (self.selectionBeforeAnchor == nil) {
+        [self selectCellsFromIndexPath:indexPath toIndexPath:indexPath addingToSelection:NO];
+        return;
+    }
+    NSInteger row = [self displayRowForDataSourceRow:indexPath.mmSpreadsheetRow];
+    if (row == NSNotFound) {
+        return;
+    }
+    [self extendSelectionToRow:row column:indexPath.mmSpreadsheetColumn];
+}
+
+- (void)clearSelection
+{
+    self.selectionBeforeAnchor = nil;
+    if (![_selection isEmpty]) {
+        _selection = [[MMSpreadsheetSelection alloc] init];
+        [self selectionDidChange];
+    }
+}
+
+- (BOOL)isItemSelectedAtIndexPath:(NSIndexPath *)indexPath
+{
+    NSInteger row = [self displayRowForDataSourceRow:indexPath.mmSpreadsheetRow];
+    return row != NSNotFound && [_selection containsRow:row column:indexPath.mmSpreadsheetColumn];
+}
+
+- (void)anchorSelectionAtRow:(NSInteger)row column:(NSInteger)column kind:(MMSpreadsheetSelectionAnchorKind)kind adding:(BOOL)adding
+{
+    self.selectionBeforeAnchor = adding ? [_selection copy] : [[MMSpreadsheetSelection alloc] init];
+    self.selectionAnchorKind = kind;
+    self.selectionAnchorRow = row;
+    self.selectionAnchorColumn = column;
+}
+
+// Rows are display rows.
+- (void)extendSelectionToRow:(NSInteger)row column:(NSInteger)column
+{
+    MMSpreadsheetSelection *selection = [self.selectionBeforeAnchor copy];
+    NSRange rows = MMSpreadsheetRangeBetweenIndexes(self.selectionAnchorRow, row);
+    NSRange columns = MMSpreadsheetRangeBetweenIndexes(self.selectionAnchorColumn, column);
+    switch (self.selectionAnchorKind) {
+        case MMSpreadsheetSelectionAnchorKindCells:
+            [selection addCellsInRows:rows columns:columns];
+            break;
+        case MMSpreadsheetSelectionAnchorKindRows:
+            [selection addRows:rows];
+            break;
+        case MMSpreadsheetSelectionAnchorKindColumns:
+            [selection addColumns:columns];
+            break;
+        default:
+            NSAssert(NO, @"What have you done?");
+            break;
+    }
+    _selection = selection;
+    [self selectionDidChange];
+}
+
+- (BOOL)isRangeSelectedItemAtIndexPath:(NSIndexPath *)indexPath collectionView:(UICollectionView *)collectionView
+{
+    // The selection covers the whole grid, so it is checked against the cell rather than the pane index.
+    MMGridCellIndex paneIndex = { indexPath.mmSpreadsheetRow, indexPath.mmSpreadsheetColumn };
+    MMGridCellIndex cell = MMGridSplitCellFromPaneIndex([self gridSplit], (MMGridPane)collectionView.tag, paneIndex);
+    return [_selection containsRow:cell.row column:cell.column];
+}
+
+- (void)selectionDidChange
+{
+    self.tileView.selection = _selection;
+    for (UICollectionView *collectionView in [self collectionViews]) {
+        NSSet *selectedIndexPaths = [NSSet setWithArray:[collectionView indexPathsForSelectedItems]];
+        for (NSIndexPath *indexPath in [collectionView indexPathsForVisibleItems]) {
+            UICollectionViewCell *cell = [collectionView cellForItemAtIndexPath:indexPath];
+            cell.selected = [selectedIndexPaths containsObject:indexPath] || [self isRangeSelectedItemAtIndexPath:indexPath collectionView:collectionView];
+        }
+    }
+}
+
+#pragma mark - Column summaries
+
+- (MMSpreadsheetColumnSummary *)summaryForColumn:(NSInteger)column
+{
+    if (self.summaryDataSource == nil || column < (NSInteger)self.headerColumnCount || column >= self.snapshot.columnCount) {
+        return nil;
+    }
+    NSNumber *key = @(column);
+    id summary = self.columnSummaries[key];
+    if (summary == nil) {
+        NSData *values = [self.summaryDataSource spreadsheetView:self summaryValuesForColumn:column];
+        NSRange rows = NSMakeRange(self.headerRowCount, MAX(self.snapshot.rowCount - (NSInteger)self.headerRowCount, 0));
+        summary = values ? [[MMSpreadsheetColumnSummary alloc] initWithValues:values rows:rows] : nil;
+        // Remembered even when there are no values, so scrolling does not keep asking for them.
+        self.columnSummaries[key] = summary ?: [NSNull null];
+    }
+    return summary == [NSNull null] ? nil : summary;
+}
+
+- (void)summaryValuesDidChangeInRows:(NSRange)rows column:(NSInteger)column
+{
+    // A summary that was never computed reads the new values when it is.
+    MMSpreadsheetColumnSummary *summary = self.columnSummaries[@(column)];
+    if (![summary isKindOfClass:[MMSpreadsheetColumnSummary class]]) {
+        return;
+    }
+    [summary valuesDidChangeInRows:rows];
+
+    NSInteger item = column - [self dataSourceColumnOffsetForCollectionView:self.lowerRightCollectionView];
+    if (self.footerCollectionView && item >= 0 && item < [self.footerCollectionView numberOfItemsInSection:0]) {
+        MMSpreadsheetSummaryCell *cell = (MMSpreadsheetSummaryCell *)[self.footerCollectionView cellForItemAtIndexPath:[NSIndexPath indexPathForItem:item inSection:0]];
+        [self configureSummaryCell:cell forColumn:column];
+    }
+}
+
+// For rows appended to the data source. Each summary already made reads only the new values.
+- (void)extendSummaries
+{
+    NSRange rows = NSMakeRange(self.headerRowCount, MAX(self.snapshot.rowCount - (NSInteger)self.headerRowCount, 0));
+    for (NSNumber *key in [self.columnSummaries allKeys]) {
+        MMSpreadsheetColumnSummary *summary = self.columnSummaries[key];
+        NSData *values = nil;
+        if ([summary isKindOfClass:[MMSpreadsheetColumnSummary class]]) {
+            values = [self.summaryDataSource spreadsheetView:self summaryValuesForColumn:[key integerValue]];
+        }
+        // A column that had no values may have some now, so it is asked again when its cell shows.
+        if (values == nil || ![summary appendValues:values rows:rows]) {
+            [self.columnSummaries removeObjectForKey:key];
+        }
+    }
+    for (NSIndexPath *indexPath in [self.footerCollectionView indexPathsForVisibleItems]) {
+        MMSpreadsheetSummaryCell *cell = (MMSpreadsheetSummaryCell *)[self.footerCollectionView cellForItemAtIndexPath:indexPath];
+        [self configureSummaryCell:cell forColumn:indexPath.item + [self dataSourceColumnOffsetForCollectionView:self.lowerRightCollectionView]];
+    }
+}
+
+- (void)reloadSummaries
+{
+    [self.columnSummaries removeAllObjects];
+    [self.footerCollectionView reloadData];
+}
+
+- (void)configureSummaryCell:(MMSpreadsheetSummaryCell *)cell forColumn:(NSInteger)column
+{
+    MMSpreadsheetColumnSummary *summary = [self summaryForColumn:column];
+    MMSpreadsheetSummaryFunction function = MMSpreadsheetSummaryFunctionSum;
+    if (summary && [self.summaryDataSource respondsToSelector:@selector(spreadsheetView:summaryFunctionForColumn:)]) {
+        function = [self.summaryDataSource spreadsheetView:self summaryFunctionForColumn:column];
+    }
+    double value = [summary valueForFunction:function];
+    cell.textLabel.text = (summary == nil || isnan(value)) ? nil : [self.summaryNumberFormatter stringFromNumber:@(value)];
+}
+
+#pragma mark - Incremental updates
+
+- (NSArray *)collectionViews
+{
+    NSMutableArray *collectionViews = [NSMutableArray array];
+    if (self.upperLeftCollectionView) {
+        [collectionViews addObject:self.upperLeftCollectionView];
+    }
+    if (self.upperRightCollectionView) {
+        [collectionViews addObject:self.upperRightCollectionView];
+    }
+    if (self.lowerLeftCollectionView) {
+        [collectionViews addObject:self.lowerLeftCollectionView];
+    }
+    if (self.lowerRightCollectionView) {
+        [collectionViews addObject:self.lowerRightCollectionView];
+    }
+    return collectionViews;
+}
+
+// Each pane's batch finishes on its own, so paneCompletion is called once per pane and each pane is in group until
+// it has. The caller's completion is left to performBatchUpdates:completion:, which waits on the group.
+- (void)performBatchUpdates:(void (^)(void))updates onCollectionViews:(NSArray *)collectionViews group:(dispatch_group_t)group paneCompletion:(void (^)(BOOL finished))paneCompletion
+{
+    // Nest the batches so the updates block runs once while every pane is collecting changes.
+    if ([collectionViews count] == 0) {
+        if (updates) {
+            updates();
+        }
+        return;
+    }
+    UICollectionView *collectionView = [collectionViews objectAtIndex:0];
+    NSArray *remainingCollectionViews = [collectionViews subarrayWithRange:NSMakeRange(1, [collectionViews count] - 1)];
+    dispatch_group_enter(group);
+    [collectionView performBatchUpdates:^{
+        [self performBatchUpdates:updates onCollectionViews:remainingCollectionViews group:group paneCompletion:paneCompletion];
+    } completion:^(BOOL finished) {
+        paneCompletion(finished);
+        dispatch_group_leave(group);
+    }];
+}
+
+- (NSIndexSet *)headerIndexesForChangedIndexes:(NSIndexSet *)indexes headerCount:(NSUInteger)headerCount
+{
+    // A change inside the header band shifts every header index after it.
+    NSUInteger firstIndex = [indexes firstIndex];
+    if (firstIndex == NSNotFound || firstIndex >= headerCount) {
+        return [NSIndexSet indexSet];
+    }
+    return [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(firstIndex, headerCount - firstIndex)];
+}
+
+- (NSIndexSet *)bodyIndexesForChangedIndexes:(NSIndexSet *)indexes headerCount:(NSUInteger)headerCount
+{
+    NSMutableIndexSet *bodyIndexes = [NSMutableIndexSet indexSet];
+
+    // The header count is fixed, so an insert or delete inside the header band pushes indexes
+    // across the split. Those show up as inserts or deletes at the start of the body.
+    for (NSUInteger index = headerCount; index - [indexes countOfIndexesInRange:NSMakeRange(0, index)] < headerCount; index++) {
+        [bodyIndexes addIndex:index - headerCount];
+    }
+
+    NSUInteger index = [indexes indexGreaterThanOrEqualToIndex:headerCount];
+    while (index != NSNotFound) {
+        [bodyIndexes addIndex:index - headerCount];
+        index = [indexes indexGreaterThanIndex:index];
+    }
+    return bodyIndexes;
+}
+
+- (void)updateRows:(NSIndexSet *)rows inserting:(BOOL)inserting
+{
+    if ([rows count] == 0) {
+        return;
+    }
+    if (self.rowOrder) {
+        [self updateOrderedRows:rows inserting:inserting];
+    }
+    else {
+        if (inserting) {
+            [self.dataSnapshot insertRows:rows];
+        }
+        else {
+            [self.dataSnapshot deleteRows:rows];
+        }
+        [self updatePaneRows:rows inserting:inserting];
+    }
+
+    // New rows can only widen a column, but deleting its widest row can make it narrower.
+    if (inserting) {
+        [self fitColumns:self.snapshot.fittedColumns exactRows:rows sampleLimit:0 replacingWidths:NO completion:nil];
+    }
+    else {
+        [self refitColumns:[self columnsBeingFitted]];
+    }
+}
+
+- (void)updateOrderedRows:(NSIndexSet *)rows inserting:(BOOL)inserting
+{
+    // A sort or filter that is still running started from the old rows.
+    self.rowOrderGeneration++;
+    MMSpreadsheetRowOrder *previousRowOrder = self.rowOrder;
+    if ((NSInteger)[rows firstIndex] < previousRowOrder.fixedRowCount) {
+        // Rows moving in or out of the header rows would change which rows are fixed, so go back to data order.
+        [self discardRowOrder];
+        [self reloadData];
+        return;
+    }
+
+    NSIndexSet *displayRows = nil;
+    if (inserting) {
+        [self.dataSnapshot insertRows:rows];
+        self.rowOrder = [previousRowOrder rowOrderByInsertingDataRows:rows];
+        displayRows = [NSIndexSet indexSetWithIndexesInRange:NSMakeRange(previousRowOrder.rowCount, [rows count])];
+    }
+    else {
+        displayRows = [previousRowOrder displayRowsForDataRows:rows];
+        [self.dataSnapshot deleteRows:rows];
+        self.rowOrder = [previousRowOrder rowOrderByDeletingDataRows:rows];
+    }
+    [self updatePaneRows:displayRows inserting:inserting];
+}
+
+// Rows are display rows, which are the data source rows unless a row order is applied.
+- (void)updatePaneRows:(NSIndexSet *)rows inserting:(BOOL)inserting
+{
+    if (inserting) {
+        [_selection insertRows:rows];
+    }
+    else {
+        [_selection deleteRows:rows];
+    }
+    self.selectionBeforeAnchor = nil;
+    self.tileView.mergedCells = self.snapshot.mergedCells;
+
+    // Rows streamed onto the end, as a loading file does, leave every existing row where it was. The
+    // selection cannot reach past the old end, tiles above it keep their images, summaries are extended
+    // and a search goes on to the new rows, so a search of a growing sheet keeps its matches and finishes.
+    NSInteger rowCount = [self displayRowCount];
+    BOOL appending = inserting && (NSInteger)[rows lastIndex] == rowCount - 1 && (NSInteger)[rows firstIndex] == rowCount - (NSInteger)[rows count];
+    if (appending) {
+        [self.tileView invalidateTilesForRowsAppendedAtRow:(NSInteger)[rows firstIndex] - self.tileView.rowOffset];
+        [self searchAppendedRows];
+    }
+    else {
+        self.tileView.selection = _selection;
+        [self.tileView invalidateAllTiles];
+        [self discardSearch];
+    }
+    // Summaries are over data source rows, which only line up with display rows without a row order.
+    if (appending && self.rowOrder == nil) {
+        [self extendSummaries];
+    }
+    else {
+        [self reloadSummaries];
+    }
+
+    // In a single scroll view every row is a section of the one pane.
+    NSUInteger headerRowCount = self.usesSingleScrollView ? 0 : self.headerRowCount;
+    NSIndexSet *headerSections = [self headerIndexesForChangedIndexes:rows headerCount:headerRowCount];
+    NSIndexSet *bodySections = [self bodyIndexesForChangedIndexes:rows headerCount:headerRowCount];
+
+    [self performBatchUpdates:^{
+        if ([headerSections count] > 0) {
+            [self.upperLeftCollectionView reloadSections:headerSections];
+            [self.upperRightCollectionView reloadSections:headerSections];
+        }
+        if ([bodySections count] > 0) {
+            if (inserting) {
+                [self.lowerLeftCollectionView insertSections:bodySections];
+                [self.lowerRightCollectionView insertSections:bodySections];
+            }
+            else {
+                [self.lowerLeftCollectionView deleteSections:bodySections];
+                [self.lowerRightCollectionView deleteSections:bodySections];
+            }
+        }
+    } completion:nil];
+}
+
+- (void)updateColumns:(NSIndexSet *)columns inserting:(BOOL)inserting
+{
+    if ([columns count] == 0) {
+        return;
+    }
+    if (inserting) {
+        [self.dataSnapshot insertColumns:columns];
+        [_selection insertColumns:columns];
+    }
+    else {
+        [self.dataSnapshot deleteColumns:columns];
+        [_selection deleteColumns:columns];
+    }
+    // Running fits measured columns by their old indexes. The snapshot has moved the fitted widths along with their columns.
+    if (self.columnFitQueue.operationCount > 0) {
+        [self refitColumns:self.snapshot.fittedColumns];
+    }
+    self.selectionBeforeAnchor = nil;
+    self.tileView.selection = _selection;
+    self.tileView.mergedCells = self.snapshot.mergedCells;
+    [self.tileView invalidateAllTiles];
+    [self reloadSummaries];
+    [self restartSearch];
+
+    NSUInteger headerColumnCount = self.usesSingleScrollView ? 0 : self.headerColumnCount;
+    NSIndexSet *headerItems = [self headerIndexesForChangedIndexes:columns headerCount:headerColumnCount];
+    NSIndexSet *bodyItems = [self bodyIndexesForChangedIndexes:columns headerCount:headerColumnCount];
+
+    // A column is an item in every section, so no index path is built per row. The header column panes keep their
+    // item count and reload their visible items. The content column panes change count in every section, which UIKit
+    // accepts from a reload of the sections; it only makes the cells that are visible. Outside of a batch the change is
+    // made a batch of its own, so no pane is torn down with reloadData. The layouts rebuild their columns and keep their rows.
+    NSMutableArray *headerCollectionViews = [NSMutableArray array];
+    if (self.upperLeftCollectionView) {
+        [headerCollectionViews addObject:self.upperLeftCollectionView];
+    }
+    if (self.lowerLeftCollectionView) {
+        [headerCollectionViews addObject:self.lowerLeftCollectionView];
+    }
+    NSMutableArray *bodyCollectionViews = [NSMutableArray array];
+    if (self.upperRightCollectionView) {
+        [bodyCollectionViews addObject:self.upperRightCollectionView];
+    }
+    if (self.lowerRightCollectionView) {
+        [bodyCollectionViews addObject:self.lowerRightCollectionView];
+    }
+
+    void (^updates)(void) = ^{
+        if ([headerItems count] > 0) {
+            for (UICollectionView *collectionView in headerCollectionViews) {
+                [collectionView reloadItemsAtIndexPaths:[self visibleIndexPathsForItems:headerItems collectionView:collectionView]];
+                [(MMGridLayout *)collectionView.collectionViewLayout invalidateColumns];
+            }
+        }
+        if ([bodyItems count] > 0) {
+            for (UICollectionView *collectionView in bodyCollectionViews) {
+                [collectionView reloadSections:[NSIndexSet indexSetWithIndexesInRange:NSMakeRange(0, [collectionView numberOfSections])]];
+                [(MMGridLayout *)collectionView.collectionViewLayout invalidateColumns];
+            }
         }
+    };
+    if (self.batchUpdateDepth == 0) {
+        [self performBatchUpdates:updates completion:nil];
+    }
+    else {
+        updates();
     }
-    return [NSIndexPath indexPathForItem:mmSpreadsheetColumn inSection:mmSpreadsheetRow];
 }
 
-- (NSIndexPath *)collectionViewIndexPathFromDataSourceIndexPath:(NSIndexPath *)indexPath
+- (NSArray *)visibleIndexPathsForItems:(NSIndexSet *)items collectionView:(UICollectionView *)collectionView
 {
-    UICollectionView *collectionView = [self collectionViewForDataSourceIndexPath:indexPath];
-    NSAssert(collectionView, @"No collectionView Returned!");
-    
-    NSInteger mmSpreadsheetRow = indexPath.mmSpreadsheetRow;
-    NSInteger mmSpreadsheetColumn = indexPath.mmSpreadsheetColumn;
-    
-    switch (collectionView.tag) {
-        case MMSpreadsheetViewCollectionUpperLeft:
+    NSMutableArray *indexPaths = [NSMutableArray array];
+    for (NSIndexPath *indexPath in [collectionView indexPathsForVisibleItems]) {
+        if ([items containsIndex:indexPath.item]) {
+            [indexPaths addObject:indexPath];
+        }
+    }
+    return indexPaths;
+}
+
+#pragma mark - Prefetching
+
+- (void)prefetchItemsForScrollView:(UIScrollView *)scrollView velocity:(CGPoint)velocity targetContentOffset:(CGPoint)targetContentOffset
+{
+    if (self.prefetchDataSource == nil || CGPointEqualToPoint(velocity, CGPointZero)) {
+        return;
+    }
+
+    // Work out where the content pane will come to rest. The header panes only move along one axis.
+    UICollectionView *collectionView = self.lowerRightCollectionView;
+    CGPoint offset = collectionView.contentOffset;
+    switch (scrollView.tag) {
+        case MMSpreadsheetViewCollectionLowerLeft:
+            offset.y = targetContentOffset.y;
             break;
-            
+
         case MMSpreadsheetViewCollectionUpperRight:
-            mmSpreadsheetColumn -= self.headerColumnCount;
+            offset.x = targetContentOffset.x;
+            break;
+
+        case MMSpreadsheetViewCollectionLowerRight:
+        case MMSpreadsheetViewCollectionSingle:
+            offset = targetContentOffset;
+            break;
+
+        default:
+            return;
+    }
+
+    // Look a little past the target in the direction of travel (velocity is in points per millisecond),
+    // but never more than one screen.
+    CGSize viewportSize = collectionView.bounds.size;
+    CGFloat lookaheadX = MAX(-viewportSize.width, MIN(viewportSize.width, velocity.x * MMSpreadsheetViewPrefetchLookahead));
+    CGFloat lookaheadY = MAX(-viewportSize.height, MIN(viewportSize.height, velocity.y * MMSpreadsheetViewPrefetchLookahead));
+    CGRect targetRect = CGRectMake(offset.x, offset.y, viewportSize.width, viewportSize.height);
+    targetRect = CGRectUnion(targetRect, CGRectOffset(targetRect, lookaheadX, lookaheadY));
+
+    MMGridLayout *layout = (MMGridLayout *)collectionView.collectionViewLayout;
+    NSRange rows = [layout rowRangeForRect:targetRect];
+    NSRange columns = [layout columnRangeForRect:targetRect];
+    if (rows.length == 0 || columns.length == 0) {
+        return;
+    }
+    rows.location += [self dataSourceRowOffsetForCollectionView:collectionView];
+    columns.location += [self dataSourceColumnOffsetForCollectionView:collectionView];
+
+    if (NSEqualRanges(rows, self.prefetchedRows) && NSEqualRanges(columns, self.prefetchedColumns)) {
+        return;
+    }
+    [self cancelPrefetching];
+    self.prefetchedRows = rows;
+    self.prefetchedColumns = columns;
+    CFTimeInterval startTime = CACurrentMediaTime();
+    [self enumerateDataSourceRowRangesForDisplayRows:rows usingBlock:^(NSRange dataSourceRows) {
+        [self.prefetchDataSource spreadsheetView:self prefetchItemsInRows:dataSourceRows columns:columns];
+    }];
+    [self.metrics recordDuration:CACurrentMediaTime() - startTime forDataSourceCallback:MMSpreadsheetViewDataSourceCallbackPrefetch];
+}
+
+- (void)cancelPrefetching
+{
+    if (self.prefetchedRows.length > 0 && self.prefetchedColumns.length > 0 &&
+        [self.prefetchDataSource respondsToSelector:@selector(spreadsheetView:cancelPrefetchingForItemsInRows:columns:)]) {
+        [self enumerateDataSourceRowRangesForDisplayRows:self.prefetchedRows usingBlock:^(NSRange dataSourceRows) {
+            [self.prefetchDataSource spreadsheetView:self cancelPrefetchingForItemsInRows:dataSourceRows columns:self.prefetchedColumns];
+        }];
+    }
+    [self finishPrefetching];
+}
+
+- (void)finishPrefetching
+{
+    self.prefetchedRows = NSMakeRange(0, 0);
+    self.prefetchedColumns = NSMakeRange(0, 0);
+}
+
+// Sorted display rows are scattered over the data source, so they are handed out as runs of consecutive rows.
+- (void)enumerateDataSourceRowRangesForDisplayRows:(NSRange)rows usingBlock:(void (^)(NSRange dataSourceRows))block
+{
+    if (self.rowOrder == nil) {
+        block(rows);
+        return;
+    }
+    NSMutableIndexSet *dataSourceRows = [NSMutableIndexSet indexSet];
+    for (NSUInteger row = rows.location; row < NSMaxRange(rows) && row < (NSUInteger)self.rowOrder.rowCount; row++) {
+        [dataSourceRows addIndex:[self.rowOrder dataRowForDisplayRow:row]];
+    }
+    [dataSourceRows enumerateRangesUsingBlock:^(NSRange range, BOOL *stop) {
+        block(range);
+    }];
+}
+
+#pragma mark - Live updates
+
+- (void)itemValueDidChangeAtRow:(NSInteger)row column:(NSInteger)column
+{
+    // Changes may come from several threads at once, and only the first makes the queue.
+    dispatch_once(&_liveUpdatePreparation, ^{
+        // Without the buffers, every change overflows and updates all visible cells, which is slow but still correct.
+        MMGridUpdateQueueInit(&_liveUpdateQueue, MMSpreadsheetViewLiveUpdateCapacity);
+        _liveUpdateCells = malloc(MMSpreadsheetViewLiveUpdateCapacity * sizeof(MMGridCellIndex));
+        _liveUpdateCellsShown = malloc(MMSpreadsheetViewLiveUpdateCapacity * sizeof(BOOL));
+    });
+    MMGridCellIndex cell = { row, column };
+    MMGridUpdateQueuePush(&_liveUpdateQueue, cell);
+    if (!atomic_exchange(&_liveUpdateScheduled, true)) {
+        __weak MMSpreadsheetView *weakSelf = self;
+        dispatch_async(dispatch_get_main_queue(), ^{
+            [weakSelf resumeLiveUpdates];
+        });
+    }
+}
+
+- (void)resumeLiveUpdates
+{
+    if (self.window == nil) {
+        return;
+    }
+    if (self.liveUpdateDisplayLink == nil) {
+        self.liveUpdateDisplayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(applyLiveUpdates:)];
+        // Common modes, so values keep updating while a pane is being scrolled.
+        [self.liveUpdateDisplayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+    }
+    self.liveUpdateDisplayLink.paused = NO;
+}
+
+- (void)applyLiveUpdates:(CADisplayLink *)displayLink
+{
+    // Cleared before draining, so a change queued after the drain wakes the display link again.
+    atomic_store(&_liveUpdateScheduled, false);
+    long capacity = _liveUpdateCells && _liveUpdateCellsShown ? MMSpreadsheetViewLiveUpdateCapacity : 0;
+    long count = MMGridUpdateQueueDrain(&_liveUpdateQueue, _liveUpdateCells, capacity);
+    unsigned long overflowCount = MMGridUpdateQueueTakeOverflowCount(&_liveUpdateQueue);
+    if (count == 0 && overflowCount == 0) {
+        // Idle until the next change, rather than waking every frame.
+        displayLink.paused = YES;
+        return;
+    }
+
+    long distinctCount = MMGridCellIndexCoalesce(_liveUpdateCells, count);
+    BOOL overflowed = overflowCount > 0;
+    if (distinctCount > 0) {
+        memset(_liveUpdateCellsShown, 0, distinctCount * sizeof(BOOL));
+    }
+    NSUInteger appliedCount = [self applyLiveUpdatesToVisibleCells:distinctCount all:overflowed];
+    appliedCount += [self applyLiveUpdatesToTiles:distinctCount all:overflowed];
+
+    NSUInteger droppedCount = 0;
+    if (!overflowed) {
+        for (long i = 0; i < distinctCount; i++) {
+            droppedCount += _liveUpdateCellsShown[i] ? 0 : 1;
+        }
+    }
+    [self.metrics recordLiveUpdatesReceived:count + overflowCount
+                                  coalesced:count - distinctCount
+                                    applied:appliedCount
+                                    dropped:droppedCount
+                                 overflowed:overflowed];
+}
+
+// Updates the visible cells of every pane that show one of the first count changes, or all of them.
+// Cells are only ever configured in place. Reloading them would dequeue a new cell for every change, so
+// without the data source method the changes are left to be counted as dropped.
+- (NSUInteger)applyLiveUpdatesToVisibleCells:(long)count all:(BOOL)all
+{
+    if (![self.dataSource respondsToSelector:@selector(spreadsheetView:configureCell:forItemAtIndexPath:)]) {
+        return 0;
+    }
+    NSUInteger appliedCount = 0;
+    for (UICollectionView *collectionView in [self collectionViews]) {
+        for (NSIndexPath *indexPath in [collectionView indexPathsForVisibleItems]) {
+            UICollectionViewCell *cell = [collectionView cellForItemAtIndexPath:indexPath];
+            // Placeholders are replaced by real cells once the fling ends.
+            if (cell == nil || [cell isKindOfClass:[MMSpreadsheetPlaceholderCell class]]) {
+                continue;
+            }
+            MMGridCellIndex dataSourceCell = [self liveUpdateCellForItemAtIndexPath:indexPath collectionView:collectionView];
+            long position = MMGridCellIndexSearch(_liveUpdateCells, count, dataSourceCell);
+            if (position < 0 && !all) {
+                continue;
+            }
+            if (position >= 0) {
+                _liveUpdateCellsShown[position] = YES;
+            }
+            appliedCount++;
+            NSIndexPath *dataSourceIndexPath = [NSIndexPath indexPathForItem:dataSourceCell.column inSection:dataSourceCell.row];
+            [self.dataSource spreadsheetView:self configureCell:cell forItemAtIndexPath:dataSourceIndexPath];
+        }
+    }
+    return appliedCount;
+}
+
+// Tiles are cached off screen as well, so every changed tile is discarded, but only the visible ones are drawn again.
+- (NSUInteger)applyLiveUpdatesToTiles:(long)count all:(BOOL)all
+{
+    if (self.tileView == nil) {
+        return 0;
+    }
+    UICollectionView *collectionView = self.lowerRightCollectionView;
+    MMGridLayout *layout = [self contentLayout];
+    NSRange visibleRows = [layout rowRangeForRect:collectionView.bounds];
+    NSRange visibleColumns = [layout columnRangeForRect:collectionView.bounds];
+    if (all) {
+        [self.tileView invalidateAllTiles];
+        return visibleRows.length * visibleColumns.length;
+    }
+
+    MMGridSplit split = [self gridSplit];
+    MMSpreadsheetDataSnapshot *snapshot = self.snapshot;
+    NSMutableArray *indexPaths = [NSMutableArray array];
+    NSUInteger appliedCount = 0;
+    for (long i = 0; i < count; i++) {
+        MMGridCellIndex cell = _liveUpdateCells[i];
+        // Changes may still arrive for rows or columns that were just deleted.
+        if (cell.row < 0 || cell.row >= snapshot.rowCount || cell.column < 0 || cell.column >= snapshot.columnCount) {
+            continue;
+        }
+        cell.row = [self displayRowForDataSourceRow:cell.row];
+        if (cell.row == NSNotFound || (NSInteger)MMGridSplitPaneForCell(split, cell.row, cell.column) != collectionView.tag) {
+            continue;
+        }
+        MMGridCellIndex paneIndex = MMGridSplitPaneIndexFromCell(split, (MMGridPane)collectionView.tag, cell);
+        [indexPaths addObject:[NSIndexPath indexPathForItem:paneIndex.column inSection:paneIndex.row]];
+        if (NSLocationInRange(paneIndex.row, visibleRows) && NSLocationInRange(paneIndex.column, visibleColumns)) {
+            _liveUpdateCellsShown[i] = YES;
+            appliedCount++;
+        }
+    }
+    [self.tileView invalidateTilesForItemsAtIndexPaths:indexPaths];
+    return appliedCount;
+}
+
+// The data source cell a pane item shows, which for part of a merged cell is its top-left cell.
+- (MMGridCellIndex)liveUpdateCellForItemAtIndexPath:(NSIndexPath *)indexPath collectionView:(UICollectionView *)collectionView
+{
+    MMGridCellIndex paneIndex = { indexPath.section, indexPath.item };
+    MMGridCellIndex cell = MMGridSplitCellFromPaneIndex([self gridSplit], (MMGridPane)collectionView.tag, paneIndex);
+    MMGridSpan mergedCell;
+    if ([self getMergedCell:&mergedCell containingDisplayRow:cell.row column:cell.column]) {
+        cell.row = mergedCell.row;
+        cell.column = mergedCell.column;
+    }
+    cell.row = [self dataSourceRowForDisplayRow:cell.row];
+    return cell;
+}
+
+#pragma mark - Fling placeholders
+
+- (void)setShowsPlaceholdersWhileFlinging:(BOOL)showsPlaceholdersWhileFlinging
+{
+    _showsPlaceholdersWhileFlinging = showsPlaceholdersWhileFlinging;
+    if (!showsPlaceholdersWhileFlinging) {
+        [self endFlingPlaceholders];
+    }
+}
+
+- (void)updateFlingPlaceholders
+{
+    if (!self.showsPlaceholdersWhileFlinging) {
+        return;
+    }
+    // Virtual offsets, so moving the virtual window does not look like a jump.
+    CFTimeInterval now = CACurrentMediaTime();
+    double x = [self virtualContentOffsetX];
+    double y = [self virtualContentOffsetY];
+    CFTimeInterval interval = now - self.velocitySampleTime;
+    if (interval < MMSpreadsheetViewMinimumVelocityInterval) {
+        return;
+    }
+    double velocity = hypot(x - self.velocitySampleX, y - self.velocitySampleY) / interval;
+    self.velocitySampleTime = now;
+    self.velocitySampleX = x;
+    self.velocitySampleY = y;
+
+    // Only a scroll the user started counts, so a jump to a search match or a restored offset never leaves placeholders up.
+    UIScrollView *scrollView = self.controllingScrollView;
+    BOOL userScrolling = scrollView.isDragging || scrollView.isDecelerating;
+    if (userScrolling && velocity > self.flingPlaceholderVelocity) {
+        self.showingFlingPlaceholders = YES;
+    }
+    else {
+        [self endFlingPlaceholders];
+    }
+}
+
+- (void)endFlingPlaceholders
+{
+    if (!self.isShowingFlingPlaceholders) {
+        return;
+    }
+    self.showingFlingPlaceholders = NO;
+
+    // Placeholders that scrolled off were never seen, so only the ones on screen cost a data source call.
+    UICollectionView *collectionView = self.lowerRightCollectionView;
+    NSMutableArray *indexPaths = [NSMutableArray array];
+    for (NSIndexPath *indexPath in [collectionView indexPathsForVisibleItems]) {
+        if ([[collectionView cellForItemAtIndexPath:indexPath] isKindOfClass:[MMSpreadsheetPlaceholderCell class]]) {
+            [indexPaths addObject:indexPath];
+        }
+    }
+    if ([indexPaths count] > 0) {
+        [collectionView reloadItemsAtIndexPaths:indexPaths];
+    }
+}
+
+- (BOOL)isPlaceholderItemAtIndexPath:(NSIndexPath *)indexPath collectionView:(UICollectionView *)collectionView
+{
+    if (collectionView != self.lowerRightCollectionView) {
+        return NO;
+    }
+    // Frozen cells stay on screen, so they are always real.
+    MMGridLayout *layout = (MMGridLayout *)collectionView.collectionViewLayout;
+    return indexPath.section >= (NSInteger)layout.frozenRowCount && indexPath.item >= (NSInteger)layout.frozenColumnCount;
+}
+
+#pragma mark - Custom functions that don't go anywhere else
+
+- (MMGridSplit)gridSplit
+{
+    return MMGridSplitMake(self.headerRowCount, self.headerColumnCount, self.usesSingleScrollView);
+}
+
+- (UICollectionView *)collectionViewForDataSourceIndexPath:(NSIndexPath *)indexPath
+{
+    MMGridPane pane = MMGridSplitPaneForCell([self gridSplit], indexPath.mmSpreadsheetRow, indexPath.mmSpreadsheetColumn);
+    UICollectionView *collectionView = nil;
+    switch (pane) {
+        case MMGridPaneUpperLeft:
+            collectionView = self.upperLeftCollectionView;
             break;
             
-        case MMSpreadsheetViewCollectionLowerLeft:
-            mmSpreadsheetRow -= self.headerRowCount;
+        case MMGridPaneUpperRight:
+            collectionView = self.upperRightCollectionView;
             break;
             
-        case MMSpreadsheetViewCollectionLowerRight:
-            mmSpreadsheetRow -= self.headerRowCount;
-            mmSpreadsheetColumn -= self.headerColumnCount;
+        case MMGridPaneLowerLeft:
+            collectionView = self.lowerLeftCollectionView;
+            break;
+            
+        case MMGridPaneLowerRight:
+        case MMGridPaneSingle:
+            collectionView = self.lowerRightCollectionView;
             break;
             
         default:
             NSAssert(NO, @"What have you done?");
             break;
     }
-    return [NSIndexPath indexPathForItem:mmSpreadsheetColumn inSection:mmSpreadsheetRow];
+    return collectionView;
+}
+
+- (NSIndexPath *)dataSourceIndexPathFromCollectionView:(UICollectionView *)collectionView indexPath:(NSIndexPath *)indexPath
+{
+    if (collectionView == nil) {
+        return [NSIndexPath indexPathForItem:indexPath.mmSpreadsheetColumn inSection:indexPath.mmSpreadsheetRow];
+    }
+    MMGridCellIndex paneIndex = { indexPath.mmSpreadsheetRow, indexPath.mmSpreadsheetColumn };
+    MMGridCellIndex cell = MMGridSplitCellFromPaneIndex([self gridSplit], (MMGridPane)collectionView.tag, paneIndex);
+    // Every part of a merged cell shows its top-left cell.
+    MMGridSpan mergedCell;
+    if ([self getMergedCell:&mergedCell containingDisplayRow:cell.row column:cell.column]) {
+        cell.row = mergedCell.row;
+        cell.column = mergedCell.column;
+    }
+    return [NSIndexPath indexPathForItem:cell.column inSection:[self dataSourceRowForDisplayRow:cell.row]];
+}
+
+// Merged cells are in data source rows, which only match the display rows in the header rows once a row order is applied.
+// While rows are sorted or filtered, merged cells reaching below the header rows are left out.
+- (BOOL)isMergedCellShown:(MMGridSpan)mergedCell
+{
+    return self.rowOrder == nil || mergedCell.row + mergedCell.rowCount <= self.rowOrder.fixedRowCount;
+}
+
+- (BOOL)getMergedCell:(MMGridSpan *)mergedCell containingDisplayRow:(NSInteger)row column:(NSInteger)column
+{
+    MMSpreadsheetMergedCells *mergedCells = self.snapshot.mergedCells;
+    if (mergedCells.count == 0 || (self.rowOrder && row >= self.rowOrder.fixedRowCount)) {
+        return NO;
+    }
+    MMGridSpan span;
+    if (![mergedCells getSpan:&span containingRow:row column:column] || ![self isMergedCellShown:span]) {
+        return NO;
+    }
+    *mergedCell = span;
+    return YES;
+}
+
+- (NSInteger)dataSourceRowOffsetForCollectionView:(UICollectionView *)collectionView
+{
+    return MMGridSplitRowOffset([self gridSplit], (MMGridPane)collectionView.tag);
+}
+
+- (NSInteger)dataSourceColumnOffsetForCollectionView:(UICollectionView *)collectionView
+{
+    return MMGridSplitColumnOffset([self gridSplit], (MMGridPane)collectionView.tag);
+}
+
+- (NSIndexPath *)collectionViewIndexPathFromDataSourceIndexPath:(NSIndexPath *)indexPath
+{
+    UICollectionView *collectionView = [self collectionViewForDataSourceIndexPath:indexPath];
+    NSAssert(collectionView, @"No collectionView Returned!");
+    
+    // Header rows never move, so the pane is the same for the data source row and the display row.
+    NSInteger displayRow = [self displayRowForDataSourceRow:indexPath.mmSpreadsheetRow];
+    if (displayRow == NSNotFound) {
+        return nil;
+    }
+    MMGridCellIndex cell = { displayRow, indexPath.mmSpreadsheetColumn };
+    MMGridCellIndex paneIndex = MMGridSplitPaneIndexFromCell([self gridSplit], (MMGridPane)collectionView.tag, cell);
+    return [NSIndexPath indexPathForItem:paneIndex.column inSection:paneIndex.row];
 }
 
 - (void)setScrollEnabledValue:(BOOL)scrollEnabled scrollView:(UIScrollView *)scrollView
@@ -702,82 +2926,120 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 
 - (CGSize)collectionView:(UICollectionView *)collectionView layout:(UICollectionViewLayout *)collectionViewLayout sizeForItemAtIndexPath:(NSIndexPath *)indexPath
 {
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return CGSizeMake([self collectionView:collectionView layout:(MMGridLayout *)collectionViewLayout widthForColumn:indexPath.item], self.summaryFooterHeight);
+    }
     NSIndexPath *dataSourceIndexPath = [self dataSourceIndexPathFromCollectionView:collectionView indexPath:indexPath];
-    CGSize size = [self.dataSource spreadsheetView:self sizeForItemAtIndexPath:dataSourceIndexPath];
+    CGSize size = [self.snapshot sizeForItemAtIndexPath:dataSourceIndexPath];
     return size;
 }
 
+#pragma mark - MMGridLayoutDelegate
+
+- (CGFloat)collectionView:(UICollectionView *)collectionView layout:(MMGridLayout *)layout heightForRow:(NSInteger)row
+{
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return self.summaryFooterHeight;
+    }
+    return [self.snapshot heightForRow:[self dataSourceRowForDisplayRow:row + [self dataSourceRowOffsetForCollectionView:collectionView]]];
+}
+
+- (CGFloat)collectionView:(UICollectionView *)collectionView uniformRowHeightForLayout:(MMGridLayout *)layout
+{
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return self.summaryFooterHeight;
+    }
+    return self.snapshot.uniformRowHeight;
+}
+
+- (CGFloat)collectionView:(UICollectionView *)collectionView layout:(MMGridLayout *)layout widthForColumn:(NSInteger)column
+{
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return [self.snapshot widthForColumn:column + [self dataSourceColumnOffsetForCollectionView:self.lowerRightCollectionView]];
+    }
+    return [self.snapshot widthForColumn:column + [self dataSourceColumnOffsetForCollectionView:collectionView]];
+}
+
+- (void)collectionView:(UICollectionView *)collectionView layout:(MMGridLayout *)layout enumerateMergedCellsInRows:(NSRange)rows columns:(NSRange)columns usingBlock:(void (^)(MMGridSpan span))block
+{
+    MMSpreadsheetMergedCells *mergedCells = self.snapshot.mergedCells;
+    if (mergedCells.count == 0 || collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return;
+    }
+    // Merged cells are clipped to the pane, so one that crosses the header split shows a part in each pane.
+    MMGridSplit split = [self gridSplit];
+    MMGridPane pane = (MMGridPane)collectionView.tag;
+    NSInteger rowCount = self.rowOrder ? self.rowOrder.rowCount : self.snapshot.rowCount;
+    MMGridRange paneRows = { MMGridSplitRowOffset(split, pane), MMGridSplitPaneRowCount(split, pane, rowCount) };
+    MMGridRange paneColumns = { MMGridSplitColumnOffset(split, pane), MMGridSplitPaneColumnCount(split, pane, self.snapshot.columnCount) };
+    NSRange gridRows = NSMakeRange(rows.location + paneRows.location, rows.length);
+    NSRange gridColumns = NSMakeRange(columns.location + paneColumns.location, columns.length);
+    [mergedCells enumerateSpansInRows:gridRows columns:gridColumns usingBlock:^(MMGridSpan span, BOOL *stop) {
+        MMGridSpan paneSpan;
+        if ([self isMergedCellShown:span] && MMGridSpanClip(span, paneRows, paneColumns, &paneSpan)) {
+            paneSpan.row -= paneRows.location;
+            paneSpan.column -= paneColumns.location;
+            block(paneSpan);
+        }
+    }];
+}
+
 #pragma mark - UICollectionViewDataSource pass-through
 
 - (NSInteger)numberOfSectionsInCollectionView:(UICollectionView *)collectionView
 {
-    NSInteger rowCount = [self.dataSource numberOfRowsInSpreadsheetView:self];
-    NSInteger adjustedRows = 1;
-    
-    switch (collectionView.tag) {
-            
-        case MMSpreadsheetViewCollectionUpperLeft:
-            adjustedRows = self.headerRowCount;
-            break;
-            
-        case MMSpreadsheetViewCollectionUpperRight:
-            adjustedRows = self.headerRowCount;
-            break;
-            
-        case MMSpreadsheetViewCollectionLowerLeft:
-            adjustedRows = rowCount - self.headerRowCount;
-            break;
-            
-        case MMSpreadsheetViewCollectionLowerRight:
-            adjustedRows = rowCount - self.headerRowCount;
-            break;
-            
-        default:
-            NSAssert(NO, @"What have you done?");
-            break;
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return self.snapshot.columnCount > 0 ? 1 : 0;
     }
-    return adjustedRows;
+    NSAssert(collectionView.tag >= MMSpreadsheetViewCollectionUpperLeft && collectionView.tag <= MMSpreadsheetViewCollectionSingle, @"What have you done?");
+    NSInteger rowCount = self.rowOrder ? self.rowOrder.rowCount : self.snapshot.rowCount;
+    return MMGridSplitPaneRowCount([self gridSplit], (MMGridPane)collectionView.tag, rowCount);
 }
 
 - (NSInteger)collectionView:(UICollectionView *)collectionView numberOfItemsInSection:(NSInteger)section
 {
-    NSInteger items = 0;
-    NSInteger columnCount = [self.dataSource numberOfColumnsInSpreadsheetView:self];
-    
-    switch (collectionView.tag) {
-        case MMSpreadsheetViewCollectionUpperLeft:
-            items = self.headerColumnCount;
-            break;
-            
-        case MMSpreadsheetViewCollectionUpperRight:
-            items = columnCount - self.headerColumnCount;
-            break;
-            
-        case MMSpreadsheetViewCollectionLowerLeft:
-            items = self.headerColumnCount;
-            break;
-            
-        case MMSpreadsheetViewCollectionLowerRight:
-            items = columnCount - self.headerColumnCount;
-            break;
-            
-        default:
-            NSAssert(NO, @"What have you done?");
-            break;
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return MMGridSplitPaneColumnCount([self gridSplit], (MMGridPane)self.lowerRightCollectionView.tag, self.snapshot.columnCount);
     }
-    
-    return items;
+    NSAssert(collectionView.tag >= MMSpreadsheetViewCollectionUpperLeft && collectionView.tag <= MMSpreadsheetViewCollectionSingle, @"What have you done?");
+    return MMGridSplitPaneColumnCount([self gridSplit], (MMGridPane)collectionView.tag, self.snapshot.columnCount);
 }
 
 - (UICollectionViewCell *)collectionView:(UICollectionView *)collectionView cellForItemAtIndexPath:(NSIndexPath *)indexPath
 {
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        MMSpreadsheetSummaryCell *cell = [collectionView dequeueReusableCellWithReuseIdentifier:MMSpreadsheetViewSummaryCellIdentifier forIndexPath:indexPath];
+        [self configureSummaryCell:cell forColumn:indexPath.item + [self dataSourceColumnOffsetForCollectionView:self.lowerRightCollectionView]];
+        return cell;
+    }
+    if (self.isShowingFlingPlaceholders && [self isPlaceholderItemAtIndexPath:indexPath collectionView:collectionView]) {
+        UICollectionViewCell *cell = [collectionView dequeueReusableCellWithReuseIdentifier:MMSpreadsheetViewPlaceholderCellIdentifier forIndexPath:indexPath];
+        cell.backgroundColor = self.flingPlaceholderColor;
+        return cell;
+    }
     NSIndexPath *dataSourceIndexPath = [self dataSourceIndexPathFromCollectionView:collectionView indexPath:indexPath];
+    self.cellRequestCollectionView = collectionView;
+    self.cellRequestIndexPath = indexPath;
+    self.cellRequestDataSourceIndexPath = dataSourceIndexPath;
+    CFTimeInterval startTime = CACurrentMediaTime();
     UICollectionViewCell *cell = [self.dataSource spreadsheetView:self cellForItemAtIndexPath:dataSourceIndexPath];
+    [self.metrics recordDuration:CACurrentMediaTime() - startTime forDataSourceCallback:MMSpreadsheetViewDataSourceCallbackCellForItem];
+    self.cellRequestCollectionView = nil;
+    self.cellRequestIndexPath = nil;
+    self.cellRequestDataSourceIndexPath = nil;
     return cell;
 }
 
 #pragma mark - UICollectionViewDelegate
 
+- (void)collectionView:(UICollectionView *)collectionView willDisplayCell:(UICollectionViewCell *)cell forItemAtIndexPath:(NSIndexPath *)indexPath
+{
+    // The collection view only knows about the tapped item, so range selected cells are marked as they appear.
+    if (collectionView.tag != MMSpreadsheetViewCollectionFooter && [self isRangeSelectedItemAtIndexPath:indexPath collectionView:collectionView]) {
+        cell.selected = YES;
+    }
+}
+
 - (void)collectionView:(UICollectionView *)collectionView didSelectItemAtIndexPath:(NSIndexPath *)indexPath
 {
     if (self.selectedItemCollectionView != nil) {
@@ -803,6 +3065,9 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 
 - (BOOL)collectionView:(UICollectionView *)collectionView shouldShowMenuForItemAtIndexPath:(NSIndexPath *)indexPath
 {
+    if (collectionView.tag == MMSpreadsheetViewCollectionFooter) {
+        return NO;
+    }
     NSIndexPath *dataSourceIndexPath = [self dataSourceIndexPathFromCollectionView:collectionView indexPath:indexPath];
     if ([self.delegate respondsToSelector:@selector(spreadsheetView:shouldShowMenuForItemAtIndexPath:)]) {
         return [self.delegate spreadsheetView:self shouldShowMenuForItemAtIndexPath:dataSourceIndexPath];
@@ -831,6 +3096,17 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 
 - (void)scrollViewDidScroll:(UIScrollView *)scrollView
 {
+    // Recentering sets the content offsets, which comes back through here.
+    if (self.usesVirtualCoordinates && !self.isMovingVirtualWindow && scrollView == self.controllingScrollView) {
+        [self recenterVirtualWindowForScrollView:scrollView];
+    }
+
+    // The content pane follows whichever pane is scrolling, so this covers every scroll.
+    if (scrollView == self.lowerRightCollectionView) {
+        [self.tileView updateVisibleTiles];
+        [self updateFlingPlaceholders];
+    }
+
     if (scrollView == self.controllingScrollView) {
     
         switch (scrollView.tag) {
@@ -845,16 +3121,25 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
             case MMSpreadsheetViewCollectionLowerRight:
                 [self lowerRightCollectionViewDidScrollForScrollView:scrollView];
                 break;
+                
+            case MMSpreadsheetViewCollectionSingle:
+                // Frozen cells are pinned by the layout, so only the footer follows.
+                [self syncFooterContentOffset];
+                [self updateVerticalScrollIndicator];
+                [self updateHorizontalScrollIndicator];
+                break;
         }
     }
     else {
         [scrollView setContentOffset:scrollView.contentOffset animated:NO];
+        [self.metrics recordContentOffsetSync];
     }
 }
 
 - (void)lowerLeftCollectionViewDidScrollForScrollView:(UIScrollView *)scrollView
 {
     [self.lowerRightCollectionView setContentOffset:CGPointMake(self.lowerRightCollectionView.contentOffset.x, scrollView.contentOffset.y) animated:NO];
+    [self.metrics recordContentOffsetSync];
     [self updateVerticalScrollIndicator];
 
     if (scrollView.contentOffset.y <= 0.0f) {
@@ -880,6 +3165,8 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 - (void)upperRightCollectionViewDidScrollForScrollView:(UIScrollView *)scrollView
 {
     [self.lowerRightCollectionView setContentOffset:CGPointMake(scrollView.contentOffset.x, self.lowerRightCollectionView.contentOffset.y) animated:NO];
+    [self.metrics recordContentOffsetSync];
+    [self syncFooterContentOffset];
     [self updateHorizontalScrollIndicator];
     
     if (scrollView.contentOffset.x <= 0.0f) {
@@ -909,8 +3196,11 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 
     CGPoint offset = CGPointMake(0.0f, scrollView.contentOffset.y);
     [self.lowerLeftCollectionView setContentOffset:offset animated:NO];
+    [self.metrics recordContentOffsetSync];
     offset = CGPointMake(scrollView.contentOffset.x, 0.0f);
     [self.upperRightCollectionView setContentOffset:offset animated:NO];
+    [self.metrics recordContentOffsetSync];
+    [self syncFooterContentOffset];
     
     if (scrollView.contentOffset.y <= 0.0f) {
         CGRect rect = self.upperLeftContainerView.frame;
@@ -953,6 +3243,9 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 
 - (void)scrollViewWillBeginDragging:(UIScrollView *)scrollView
 {
+    // A new touch interrupts the previous fling, so its target may never come on screen.
+    [self cancelPrefetching];
+    [self.metrics beginScrollEvent];
     [self setScrollEnabledValue:NO scrollView:scrollView];
     
     if (self.controllingScrollView != scrollView) {
@@ -969,13 +3262,15 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
 
 - (void)scrollViewWillEndDragging:(UIScrollView *)scrollView withVelocity:(CGPoint)velocity targetContentOffset:(inout CGPoint *)targetContentOffset
 {
+    CGPoint toffset = *targetContentOffset;
+    [self prefetchItemsForScrollView:scrollView velocity:velocity targetContentOffset:toffset];
+
     // Block UI if we're in a bounce.
     // Without this, you can lock the scroll views in a scroll which looks weird.
-    CGPoint toffset = *targetContentOffset;
     switch (scrollView.tag) {
         case MMSpreadsheetViewCollectionLowerLeft: {
             BOOL willBouncePastZeroY = velocity.y < 0.0f && !(toffset.y > 0.0f);
-            BOOL willBouncePastMaxY = toffset.y > self.lowerLeftCollectionView.contentSize.height - self.lowerLeftCollectionView.frame.size.height - 0.1f && velocity.y > 0.0f;
+            BOOL willBouncePastMaxY = toffset.y > self.lowerLeftCollectionView.contentSize.height - self.lowerLeftCollectionView.frame.size.height - 0.1f && velocity.y > 0.0f && [self isVirtualWindowAtLastRow];
             if (willBouncePastZeroY || willBouncePastMaxY || !self.bounces) {
                 self.upperRightContainerView.userInteractionEnabled = NO;
                 self.lowerRightContainerView.userInteractionEnabled = NO;
@@ -986,7 +3281,7 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
             
         case MMSpreadsheetViewCollectionUpperRight: {
             BOOL willBouncePastZeroX = velocity.x < 0.0f && !(toffset.x > 0.0f);
-            BOOL willBouncePastMaxX = toffset.x > self.upperRightCollectionView.contentSize.width - self.upperRightCollectionView.frame.size.width - 0.1f && velocity.x > 0.0f;
+            BOOL willBouncePastMaxX = toffset.x > self.upperRightCollectionView.contentSize.width - self.upperRightCollectionView.frame.size.width - 0.1f && velocity.x > 0.0f && [self isVirtualWindowAtLastColumn];
             if (willBouncePastZeroX || willBouncePastMaxX || !self.bounces) {
                 self.lowerRightContainerView.userInteractionEnabled = NO;
                 self.lowerLeftContainerView.userInteractionEnabled = NO;
@@ -997,9 +3292,9 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
             
         case MMSpreadsheetViewCollectionLowerRight: {
             BOOL willBouncePastZeroX = velocity.x < 0.0f && !(toffset.x > 0.0f);
-            BOOL willBouncePastMaxX = toffset.x > self.upperRightCollectionView.contentSize.width - self.upperRightCollectionView.frame.size.width - 0.1f && velocity.x > 0.0f;
+            BOOL willBouncePastMaxX = toffset.x > self.upperRightCollectionView.contentSize.width - self.upperRightCollectionView.frame.size.width - 0.1f && velocity.x > 0.0f && [self isVirtualWindowAtLastColumn];
             BOOL willBouncePastZeroY = velocity.y < 0.0f && !(toffset.y > 0.0f);
-            BOOL willBouncePastMaxY = toffset.y > self.lowerLeftCollectionView.contentSize.height - self.lowerLeftCollectionView.frame.size.height - 0.1f && velocity.y > 0.0f;
+            BOOL willBouncePastMaxY = toffset.y > self.lowerLeftCollectionView.contentSize.height - self.lowerLeftCollectionView.frame.size.height - 0.1f && velocity.y > 0.0f && [self isVirtualWindowAtLastRow];
             if (willBouncePastZeroX || willBouncePastMaxX ||
                 willBouncePastZeroY || willBouncePastMaxY || !self.bounces) {
                 self.upperRightContainerView.userInteractionEnabled = NO;
@@ -1011,6 +3306,14 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     }
 }
 
+- (void)scrollViewDidEndDragging:(UIScrollView *)scrollView willDecelerate:(BOOL)decelerate
+{
+    if (!decelerate) {
+        [self endFlingPlaceholders];
+        [self.metrics endScrollEvent];
+    }
+}
+
 - (void)scrollViewDidEndDecelerating:(UIScrollView *)scrollView
 {
     [self scrollViewDidStop:scrollView];
@@ -1024,6 +3327,9 @@ const static NSUInteger MMScrollIndicatorTag = 12345;
     self.upperRightBouncing = NO;
     self.lowerLeftBouncing = NO;
     self.lowerRightBouncing = NO;
+    [self finishPrefetching];
+    [self endFlingPlaceholders];
+    [self.metrics endScrollEvent];
 
     if (!scrollView.isDecelerating && !scrollView.isDragging && !scrollView.isTracking) {
         [self setNeedsLayout];
@@ -0,0 +1,147 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import <UIKit/UIKit.h>
+
+@class MMSpreadsheetViewMetrics;
+
+/**
+ The data source callbacks that `MMSpreadsheetViewMetrics` keeps latency histograms for.
+ */
+typedef NS_ENUM(NSUInteger, MMSpreadsheetViewDataSourceCallback)
+{
+    MMSpreadsheetViewDataSourceCallbackNumberOfRows,
+    MMSpreadsheetViewDataSourceCallbackNumberOfColumns,
+    MMSpreadsheetViewDataSourceCallbackSizeForItem,
+    MMSpreadsheetViewDataSourceCallbackCellForItem,
+    MMSpreadsheetViewDataSourceCallbackPrefetch,
+    MMSpreadsheetViewDataSourceCallbackCount
+};
+
+/**
+ Top level keys of a metrics snapshot.
+ 
+ `MMSpreadsheetViewMetricsLayoutKey` maps pane names (`upperLeft`, `upperRight`, `lowerLeft`, `lowerRight`, `single`) to timings of layoutAttributesForElementsInRect:. `MMSpreadsheetViewMetricsDataSourceKey` maps callback names (`numberOfRows`, `numberOfColumns`, `sizeForItem`, `cellForItem`, `prefetch`) to timings of the data source. A timing is a dictionary with `count`, `totalTime` and `maxTime` (in seconds) and `histogram`, an array of call counts where bucket 0 holds calls under 1µs and bucket n holds calls from 2^(n-1) to 2^n µs; the last bucket holds everything slower.
+ 
+ `MMSpreadsheetViewMetricsDequeueKey` holds `frames`, `droppedFrames`, `cells`, `maxCellsPerFrame` and `histogram` (frames bucketed by cells dequeued: 0, 1, 2-3, 4-7, ...). `MMSpreadsheetViewMetricsContentOffsetSyncKey` holds `scrollEvents`, `syncs`, `maxSyncsPerScrollEvent` and a `histogram` bucketed the same way.
+ 
+ `MMSpreadsheetViewMetricsPrewarmKey` maps pane names to the most recent cell pre-warm of each pane: `neededCells`, the number of cells the warmed area holds according to the cell sizes, `cells`, a dictionary of reuse identifiers to the number of cells the data source dequeued, and `duration`, the time the pane took in seconds.
+ 
+ `MMSpreadsheetViewMetricsLiveUpdatesKey` holds `frames`, the frames that applied live updates, `received`, the changes reported, `coalesced`, the changes folded into another change to the same cell in the same frame, `applied`, the on screen cells reconfigured, `dropped`, the changed cells that were off screen or that the data source cannot configure in place, `overflows`, the frames that refreshed every visible cell because too many changes were pending, and `histogram` (frames bucketed by cells applied, as for dequeues).
+ */
+extern NSString *const MMSpreadsheetViewMetricsLayoutKey;
+extern NSString *const MMSpreadsheetViewMetricsDataSourceKey;
+extern NSString *const MMSpreadsheetViewMetricsDequeueKey;
+extern NSString *const MMSpreadsheetViewMetricsContentOffsetSyncKey;
+extern NSString *const MMSpreadsheetViewMetricsPrewarmKey;
+extern NSString *const MMSpreadsheetViewMetricsLiveUpdatesKey;
+
+/**
+ The `MMSpreadsheetViewMetricsDelegate` protocol lets an app collect metrics without polling, for example to upload them from production builds.
+ */
+@protocol MMSpreadsheetViewMetricsDelegate <NSObject>
+
+/**
+ Tells the delegate that a scroll event ended and hands it a snapshot of everything recorded so far.
+ 
+ @param metrics The metrics object.
+ @param snapshot The same dictionary `snapshot` would return.
+ */
+- (void)spreadsheetViewMetrics:(MMSpreadsheetViewMetrics *)metrics didCaptureSnapshot:(NSDictionary *)snapshot;
+
+@end
+
+/**
+ `MMSpreadsheetViewMetrics` collects scroll performance counters for a `MMSpreadsheetView`: how long each pane spends in layout, how many cells are dequeued per frame, how long each data source callback takes and how many times panes have to sync their content offsets during a scroll.
+ 
+ Metrics are opt-in. Create an instance and assign it to the spreadsheet view's metrics property; when the property is nil nothing is recorded. All recording happens on the main thread.
+ */
+@interface MMSpreadsheetViewMetrics : NSObject
+
+/**
+ The object that is handed a snapshot each time a scroll event ends. The metrics object maintains a weak reference to the delegate.
+ */
+@property (nonatomic, weak) id<MMSpreadsheetViewMetricsDelegate> delegate;
+
+/**
+ A Boolean value that determines whether counters are cleared after the delegate is handed a snapshot, so each snapshot covers one scroll event. Default is NO.
+ */
+@property (nonatomic, assign) BOOL resetsAfterDelegateSnapshot;
+
+/**
+ A property list of every counter recorded since the last reset. See `MMSpreadsheetViewMetricsLayoutKey` for the format.
+ */
+- (NSDictionary *)snapshot;
+
+/**
+ Clears every counter.
+ */
+- (void)reset;
+
+///---------------------------------------
+/// @name Recording (called by the spreadsheet view)
+///---------------------------------------
+
+/**
+ Records one call to layoutAttributesForElementsInRect: for a pane. The pane is the collection view's tag.
+ */
+- (void)recordLayoutDuration:(CFTimeInterval)duration forPane:(NSInteger)pane;
+
+/**
+ Records a data source call.
+ */
+- (void)recordDuration:(CFTimeInterval)duration forDataSourceCallback:(MMSpreadsheetViewDataSourceCallback)callback;
+
+/**
+ Counts a cell dequeued during the current frame.
+ */
+- (void)recordDequeuedCell;
+
+/**
+ Counts one setContentOffset: on a pane that follows the scrolling pane.
+ */
+- (void)recordContentOffsetSync;
+
+/**
+ Records a cell pre-warm of a pane, replacing the one recorded before. The pane is the collection view's tag, and the report is in the format described under `MMSpreadsheetViewMetricsPrewarmKey`.
+ */
+- (void)recordPrewarm:(NSDictionary *)report forPane:(NSInteger)pane;
+
+/**
+ Records one frame of live updates. The counts are described under `MMSpreadsheetViewMetricsLiveUpdatesKey`.
+ */
+- (void)recordLiveUpdatesReceived:(NSUInteger)received coalesced:(NSUInteger)coalesced applied:(NSUInteger)applied dropped:(NSUInteger)dropped overflowed:(BOOL)overflowed;
+
+/**
+ The name a pane's counters are listed under in a snapshot, such as `lowerRight`. The pane is the collection view's tag.
+ */
++ (NSString *)nameForPane:(NSInteger)pane;
+
+/**
+ Starts counting frames for a scroll event. A display link closes out each frame until endScrollEvent.
+ */
+- (void)beginScrollEvent;
+
+/**
+ Ends the current scroll event, if any, and hands the delegate a snapshot.
+ */
+- (void)endScrollEvent;
+
+@end
@@ -0,0 +1,297 @@
+// Copyright (c) 2013 Mutual Mobile (http://mutualmobile.com/)
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+
+#import "MMSpreadsheetViewMetrics.h"
+#import <QuartzCore/QuartzCore.h>
+#import "MMGridGeometry.h"
+
+NSString *const MMSpreadsheetViewMetricsLayoutKey = @"layout";
+NSString *const MMSpreadsheetViewMetricsDataSourceKey = @"dataSource";
+NSString *const MMSpreadsheetViewMetricsDequeueKey = @"dequeue";
+NSString *const MMSpreadsheetViewMetricsContentOffsetSyncKey = @"contentOffsetSync";
+NSString *const MMSpreadsheetViewMetricsPrewarmKey = @"prewarm";
+NSString *const MMSpreadsheetViewMetricsLiveUpdatesKey = @"liveUpdates";
+
+#define MMSpreadsheetViewMetricsHistogramBucketCount 24
+#define MMSpreadsheetViewMetricsPaneCount (MMGridPaneSingle + 1)
+
+typedef struct {
+    NSUInteger count;
+    CFTimeInterval totalTime;
+    CFTimeInterval maxTime;
+    NSUInteger histogram[MMSpreadsheetViewMetricsHistogramBucketCount];
+} MMSpreadsheetViewMetricsTiming;
+
+typedef struct {
+    NSUInteger samples;
+    NSUInteger total;
+    NSUInteger max;
+    NSUInteger histogram[MMSpreadsheetViewMetricsHistogramBucketCount];
+} MMSpreadsheetViewMetricsCounter;
+
+// Bucket 0 holds values under 1, bucket n holds [2^(n-1), 2^n), and the last bucket holds the rest.
+static NSUInteger MMSpreadsheetViewMetricsBucket(double value)
+{
+    if (value < 1.0) {
+        return 0;
+    }
+    NSUInteger bucket = (NSUInteger)floor(log2(value)) + 1;
+    return MIN(bucket, MMSpreadsheetViewMetricsHistogramBucketCount - 1);
+}
+
+static NSArray *MMSpreadsheetViewMetricsHistogramArray(const NSUInteger *histogram)
+{
+    // Trailing empty buckets are left off to keep snapshots small.
+    NSInteger last = MMSpreadsheetViewMetricsHistogramBucketCount - 1;
+    while (last >= 0 && histogram[last] == 0) {
+        last--;
+    }
+    NSMutableArray *array = [NSMutableArray arrayWithCapacity:last + 1];
+    for (NSInteger bucket = 0; bucket <= last; bucket++) {
+        [array addObject:@(histogram[bucket])];
+    }
+    return array;
+}
+
+static void MMSpreadsheetViewMetricsTimingRecord(MMSpreadsheetViewMetricsTiming *timing, CFTimeInterval duration)
+{
+    timing->count++;
+    timing->totalTime += duration;
+    timing->maxTime = MAX(timing->maxTime, duration);
+    timing->histogram[MMSpreadsheetViewMetricsBucket(duration * 1e6)]++;
+}
+
+static NSDictionary *MMSpreadsheetViewMetricsTimingDictionary(const MMSpreadsheetViewMetricsTiming *timing)
+{
+    return @{@"count": @(timing->count),
+             @"totalTime": @(timing->totalTime),
+             @"maxTime": @(timing->maxTime),
+             @"histogram": MMSpreadsheetViewMetricsHistogramArray(timing->histogram)};
+}
+
+static void MMSpreadsheetViewMetricsCounterRecord(MMSpreadsheetViewMetricsCounter *counter, NSUInteger value)
+{
+    counter->samples++;
+    counter->total += value;
+    counter->max = MAX(counter->max, value);
+    counter->histogram[MMSpreadsheetViewMetricsBucket(value)]++;
+}
+
+@interface MMSpreadsheetViewMetrics ()
+
+@property (nonatomic, strong) CADisplayLink *displayLink;
+@property (nonatomic, assign) CFTimeInterval lastFrameTimestamp;
+@property (nonatomic, assign) NSUInteger droppedFrames;
+@property (nonatomic, assign) NSUInteger currentFrameCells;
+@property (nonatomic, assign) NSUInteger currentScrollEventSyncs;
+@property (nonatomic, strong) NSMutableDictionary *prewarms;
+@property (nonatomic, assign) NSUInteger liveUpdatesReceived;
+@property (nonatomic, assign) NSUInteger liveUpdatesCoalesced;
+@property (nonatomic, assign) NSUInteger liveUpdatesDropped;
+@property (nonatomic, assign) NSUInteger liveUpdateOverflows;
+
+@end
+
+@implementation MMSpreadsheetViewMetrics
+{
+    MMSpreadsheetViewMetricsTiming _layoutTimings[MMSpreadsheetViewMetricsPaneCount];
+    MMSpreadsheetViewMetricsTiming _dataSourceTimings[MMSpreadsheetViewDataSourceCallbackCount];
+    MMSpreadsheetViewMetricsCounter _dequeuesPerFrame;
+    MMSpreadsheetViewMetricsCounter _syncsPerScrollEvent;
+    MMSpreadsheetViewMetricsCounter _liveUpdatesAppliedPerFrame;
+}
+
+- (void)dealloc
+{
+    [_displayLink invalidate];
+}
+
+- (void)reset
+{
+    memset(_layoutTimings, 0, sizeof(_layoutTimings));
+    memset(_dataSourceTimings, 0, sizeof(_dataSourceTimings));
+    memset(&_dequeuesPerFrame, 0, sizeof(_dequeuesPerFrame));
+    memset(&_syncsPerScrollEvent, 0, sizeof(_syncsPerScrollEvent));
+    memset(&_liveUpdatesAppliedPerFrame, 0, sizeof(_liveUpdatesAppliedPerFrame));
+    self.droppedFrames = 0;
+    self.currentFrameCells = 0;
+    self.currentScrollEventSyncs = 0;
+    self.prewarms = nil;
+    self.liveUpdatesReceived = 0;
+    self.liveUpdatesCoalesced = 0;
+    self.liveUpdatesDropped = 0;
+    self.liveUpdateOverflows = 0;
+}
+
+#pragma mark - Recording
+
+- (void)recordLayoutDuration:(CFTimeInterval)duration forPane:(NSInteger)pane
+{
+    if (pane > MMGridPaneNone && pane < MMSpreadsheetViewMetricsPaneCount) {
+        MMSpreadsheetViewMetricsTimingRecord(&_layoutTimings[pane], duration);
+    }
+}
+
+- (void)recordDuration:(CFTimeInterval)duration forDataSourceCallback:(MMSpreadsheetViewDataSourceCallback)callback
+{
+    NSParameterAssert(callback < MMSpreadsheetViewDataSourceCallbackCount);
+    MMSpreadsheetViewMetricsTimingRecord(&_dataSourceTimings[callback], duration);
+}
+
+- (void)recordDequeuedCell
+{
+    self.currentFrameCells++;
+}
+
+- (void)recordContentOffsetSync
+{
+    self.currentScrollEventSyncs++;
+}
+
+- (void)recordPrewarm:(NSDictionary *)report forPane:(NSInteger)pane
+{
+    NSString *name = [[self class] nameForPane:pane];
+    if (name == nil || report == nil) {
+        return;
+    }
+    if (self.prewarms == nil) {
+        self.prewarms = [NSMutableDictionary dictionary];
+    }
+    self.prewarms[name] = report;
+}
+
+- (void)recordLiveUpdatesReceived:(NSUInteger)received coalesced:(NSUInteger)coalesced applied:(NSUInteger)applied dropped:(NSUInteger)dropped overflowed:(BOOL)overflowed
+{
+    self.liveUpdatesReceived += received;
+    self.liveUpdatesCoalesced += coalesced;
+    self.liveUpdatesDropped += dropped;
+    if (overflowed) {
+        self.liveUpdateOverflows++;
+    }
+    MMSpreadsheetViewMetricsCounterRecord(&_liveUpdatesAppliedPerFrame, applied);
+}
+
+#pragma mark - Scroll events
+
+- (void)beginScrollEvent
+{
+    if (self.displayLink) {
+        return;
+    }
+    self.lastFrameTimestamp = 0.0;
+    self.currentFrameCells = 0;
+    self.currentScrollEventSyncs = 0;
+    self.displayLink = [CADisplayLink displayLinkWithTarget:self selector:@selector(frameDidEnd:)];
+    // Common modes, so frames are still counted while a scroll view is tracking.
+    [self.displayLink addToRunLoop:[NSRunLoop mainRunLoop] forMode:NSRunLoopCommonModes];
+}
+
+- (void)frameDidEnd:(CADisplayLink *)displayLink
+{
+    if (self.lastFrameTimestamp > 0.0 && displayLink.duration > 0.0) {
+        CFTimeInterval frames = round((displayLink.timestamp - self.lastFrameTimestamp) / displayLink.duration);
+        if (frames > 1.0) {
+            self.droppedFrames += (NSUInteger)frames - 1;
+        }
+    }
+    self.lastFrameTimestamp = displayLink.timestamp;
+    MMSpreadsheetViewMetricsCounterRecord(&_dequeuesPerFrame, self.currentFrameCells);
+    self.currentFrameCells = 0;
+}
+
+- (void)endScrollEvent
+{
+    if (self.displayLink == nil) {
+        return;
+    }
+    [self.displayLink invalidate];
+    self.displayLink = nil;
+    if (self.currentFrameCells > 0) {
+        MMSpreadsheetViewMetricsCounterRecord(&_dequeuesPerFrame, self.currentFrameCells);
+        self.currentFrameCells = 0;
+    }
+    MMSpreadsheetViewMetricsCounterRecord(&_syncsPerScrollEvent, self.currentScrollEventSyncs);
+    self.currentScrollEventSyncs = 0;
+
+    if (self.delegate) {
+        [self.delegate spreadsheetViewMetrics:self didCaptureSnapshot:[self snapshot]];
+        if (self.resetsAfterDelegateSnapshot) {
+            [self reset];
+        }
+    }
+}
+
+#pragma mark - Snapshot
+
++ (NSString *)nameForPane:(NSInteger)pane
+{
+    static NSString *const paneNames[MMSpreadsheetViewMetricsPaneCount] = {
+        nil, @"upperLeft", @"upperRight", @"lowerLeft", @"lowerRight", @"single"
+    };
+    return pane > MMGridPaneNone && pane < MMSpreadsheetViewMetricsPaneCount ? paneNames[pane] : nil;
+}
+
+- (NSDictionary *)snapshot
+{
+    NSMutableDictionary *layout = [NSMutableDictionary dictionary];
+    for (NSInteger pane = MMGridPaneUpperLeft; pane < MMSpreadsheetViewMetricsPaneCount; pane++) {
+        if (_layoutTimings[pane].count > 0) {
+            layout[[[self class] nameForPane:pane]] = MMSpreadsheetViewMetricsTimingDictionary(&_layoutTimings[pane]);
+        }
+    }
+
+    static NSString *const callbackNames[MMSpreadsheetViewDataSourceCallbackCount] = {
+        @"numberOfRows", @"numberOfColumns", @"sizeForItem", @"cellForItem", @"prefetch"
+    };
+    NSMutableDictionary *dataSource = [NSMutableDictionary dictionary];
+    for (NSInteger callback = 0; callback < MMSpreadsheetViewDataSourceCallbackCount; callback++) {
+        if (_dataSourceTimings[callback].count > 0) {
+            dataSource[callbackNames[callback]] = MMSpreadsheetViewMetricsTimingDictionary(&_dataSourceTimings[callback]);
+        }
+    }
+
+    NSDictionary *dequeue = @{@"frames": @(_dequeuesPerFrame.samples),
+                              @"droppedFrames": @(self.droppedFrames),
+                              @"cells": @(_dequeuesPerFrame.total),
+                              @"maxCellsPerFrame": @(_dequeuesPerFrame.max),
+                              @"histogram": MMSpreadsheetViewMetricsHistogramArray(_dequeuesPerFrame.histogram)};
+
+    NSDictionary *contentOffsetSync = @{@"scrollEvents": @(_syncsPerScrollEvent.samples),
+                                        @"syncs": @(_syncsPerScrollEvent.total),
+                                        @"maxSyncsPerScrollEvent": @(_syncsPerScrollEvent.max),
+                                        @"histogram": MMSpreadsheetViewMetricsHistogramArray(_syncsPerScrollEvent.histogram)};
+
+    NSDictionary *liveUpdates = @{@"frames": @(_liveUpdatesAppliedPerFrame.samples),
+                                  @"received": @(self.liveUpdatesReceived),
+                                  @"coalesced": @(self.liveUpdatesCoalesced),
+                                  @"applied": @(_liveUpdatesAppliedPerFrame.total),
+                                  @"dropped": @(self.liveUpdatesDropped),
+                                  @"overflows": @(self.liveUpdateOverflows),
+                                  @"histogram": MMSpreadsheetViewMetricsHistogramArray(_liveUpdatesAppliedPerFrame.histogram)};
+
+    return @{MMSpreadsheetViewMetricsLayoutKey: layout,
+             MMSpreadsheetViewMetricsDataSourceKey: dataSource,
+             MMSpreadsheetViewMetricsDequeueKey: dequeue,
+             MMSpreadsheetViewMetricsContentOffsetSyncKey: contentOffsetSync,
+             MMSpreadsheetViewMetricsPrewarmKey: [self.prewarms copy] ?: @{},
+             MMSpreadsheetViewMetricsLiveUpdatesKey: liveUpdates};
+}
+
+@end